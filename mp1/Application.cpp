@@ -26,13 +26,31 @@ void handler(int sig) {
  **********************************/
 int main(int argc, char *argv[]) {
 	//signal(SIGSEGV, handler);
-	if ( argc != ARGS_COUNT ) {
+	if ( argc >= 2 && 0 == strcmp(argv[1], "sweep") ) {
+		return Application::sweep(argc > 2 ? argv[2] : SWEEP_SIZES, argc > 3 ? argv[3] : NULL);
+	}
+	if ( argc != ARGS_COUNT && argc != ARGS_COUNT + 1 ) {
 		cout<<"Configuration (i.e., *.conf) file File Required"<<endl;
+		cout<<"Usage: ./Application <conf file> [emul|udp|shm|udp-procs|shm-procs]"<<endl;
+		cout<<"       ./Application sweep [group sizes, e.g. "<<SWEEP_SIZES<<"] [introducers, e.g. 1,2,3,4]"<<endl;
 		return FAILURE;
 	}
 
+	Params *par = new Params();
+	par->setparams(argv[1]);
+	if ( argc == ARGS_COUNT + 1 && par->settransport(argv[2]) == FAILURE ) {
+		cout<<"Unknown transport "<<argv[2]<<endl;
+		return FAILURE;
+	}
+	LOG_INFO("Random seed: %llu\n", (unsigned long long)par->SEED);
+
+	// Every node in a process of its own
+	if ( par->NODE_PROCS ) {
+		return Application::runNodeProcesses(par);
+	}
+
 	// Create a new application object
-	Application *app = new Application(argv[1]);
+	Application *app = new Application(par);
 	// Call the run function
 	app->run();
 	// When done delete the application object
@@ -41,17 +59,298 @@ int main(int argc, char *argv[]) {
 	return SUCCESS;
 }
 
+/**
+ * FUNCTION NAME: runNodeProcesses
+ *
+ * DESCRIPTION: Fork one process per node. Each runs its own node over the network,
+ * 				all of them counting ticks on the same wall clock.
+ * 				Their logs are merged once they are all done.
+ */
+int Application::runNodeProcesses(Params *par) {
+	int i, status;
+	int ret = SUCCESS;
+	pid_t pid;
+	vector<pid_t> children;
+	// the shared memory segment has to exist before the fork to be shared
+	Network *shared = NULL;
+
+	if ( par->TRANSPORT == SHM_TRANSPORT ) {
+		shared = new ShmNet(par, 0);
+	}
+	par->startwallclock(NODE_PROCESS_STARTUP_MS);
+	fflush(stdout);
+
+	for ( i = 1; i <= par->EN_GPSZ; i++ ) {
+		pid = fork();
+		if ( pid < 0 ) {
+			perror("fork");
+			ret = FAILURE;
+			break;
+		}
+		if ( pid == 0 ) {
+			par->nodeProcess = i;
+			Application *app = new Application(par, shared);
+			app->run();
+			delete(app);
+			exit(SUCCESS);
+		}
+		children.push_back(pid);
+	}
+
+	for ( i = 0; i < (int)children.size(); i++ ) {
+		if ( waitpid(children[i], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != SUCCESS ) {
+			ret = FAILURE;
+		}
+	}
+
+	mergeNodeFiles(par);
+	delete shared;
+	delete par;
+	return ret;
+}
+
+/**
+ * FUNCTION NAME: sweep
+ *
+ * DESCRIPTION: Run every failure scenario of the test cases with every group size, each run
+ * 				in a child process, and write a line per run to sweep.csv: failure detection,
+ * 				false removals, messages and bytes sent, the joins, JOINREP bytes and CPU time of
+ * 				the busiest introducer, wall clock time per tick and peak RSS.
+ * 				introducers, if not NULL, replaces the introducers of the test cases.
+ */
+int Application::sweep(const char *sizes, const char *introducers) {
+	static const char *scenarios[] = { "singlefailure", "multifailure", "msgdropsinglefailure" };
+	vector<int> groupSizes;
+	char conf[64];
+	char *end;
+	FILE *csv;
+	struct rusage usage;
+	struct timespec start, stop;
+	int status;
+	pid_t pid;
+
+	for ( const char *p = sizes; *p != 0; p = (*end == ',') ? end + 1 : end ) {
+		long n = strtol(p, &end, 10);
+		if ( end == p || n < 2 ) {
+			printf("Group sizes are 2 or more, separated by commas: %s\n", sizes);
+			return FAILURE;
+		}
+		groupSizes.push_back(n);
+	}
+	if ( introducers != NULL ) {
+		Params checked;
+		checked.EN_GPSZ = *min_element(groupSizes.begin(), groupSizes.end());
+		if ( checked.setintroducers(introducers) == FAILURE || checked.checkintroducers() == FAILURE ) {
+			printf("Introducers are node ids from 1 to %d, separated by commas: %s\n", checked.EN_GPSZ, introducers);
+			return FAILURE;
+		}
+	}
+
+	csv = fopen(SWEEP_CSV, "w");
+	if ( csv == NULL ) {
+		perror(SWEEP_CSV);
+		return FAILURE;
+	}
+	fprintf(csv, "scenario,nodes,failed,removals,expected_removals,false_removals,detect_p50,detect_p99,detect_max,messages,bytes,"
+			"introducer_joins,introducer_bytes,introducer_cpu_us,wall_ms,us_per_tick,peak_rss_kb\n");
+	printf("%-22s %6s %9s %7s %8s %12s %14s %6s %12s %9s %10s %10s\n", "scenario", "nodes", "removals", "false", "detect", "messages", "bytes",
+			"joins", "intro bytes", "intro us", "us/tick", "rss KB");
+
+	for ( unsigned int s = 0; s < sizeof(scenarios) / sizeof(scenarios[0]); s++ ) {
+		sprintf(conf, "testcases/%s.conf", scenarios[s]);
+		if ( access(conf, R_OK) != 0 ) {
+			printf("%s: missing, skipped\n", conf);
+			continue;
+		}
+		for ( unsigned int g = 0; g < groupSizes.size(); g++ ) {
+			fflush(stdout);
+			clock_gettime(CLOCK_MONOTONIC, &start);
+			pid = fork();
+			if ( pid < 0 ) {
+				perror("fork");
+				fclose(csv);
+				return FAILURE;
+			}
+			if ( pid == 0 ) {
+				exit(sweepPoint(conf, groupSizes[g], introducers));
+			}
+			// the peak RSS of the child alone
+			if ( wait4(pid, &status, 0, &usage) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != SUCCESS ) {
+				printf("%-22s %6d failed\n", scenarios[s], groupSizes[g]);
+				continue;
+			}
+			clock_gettime(CLOCK_MONOTONIC, &stop);
+			long wallMs = (stop.tv_sec - start.tv_sec) * 1000 + (stop.tv_nsec - start.tv_nsec) / 1000000;
+
+			vector<TraceFile> traces(1);
+			MembershipSummary membership;
+			Metrics total, introducer;
+			if ( !loadTrace(TRACE_BIN, &traces[0]) || total.load(SWEEP_METRICS_FILE) != SUCCESS || introducer.load(SWEEP_INTRODUCER_FILE) != SUCCESS ) {
+				printf("%-22s %6d no trace or metrics\n", scenarios[s], groupSizes[g]);
+				continue;
+			}
+			remove(SWEEP_METRICS_FILE);
+			remove(SWEEP_INTRODUCER_FILE);
+			unsigned long long joins = introducer.counters[MC_JOIN_REQUESTS];
+			unsigned long long joinBytes = introducer.counters[MC_JOIN_BYTES];
+			double joinCpuUs = introducer.counters[MC_JOIN_CPU_NS] / 1000.0;
+			summarizeMembership(traces, &membership);
+			vector<int> &d = membership.detect.samples;
+			sort(d.begin(), d.end());
+			int p50 = d.empty() ? -1 : d[d.size() / 2];
+			int p99 = d.empty() ? -1 : d[d.size() * 99 / 100];
+			int dmax = d.empty() ? -1 : d.back();
+
+			fprintf(csv, "%s,%d,%d,%ld,%ld,%ld,%d,%d,%d,%llu,%llu,%llu,%llu,%.1f,%ld,%.1f,%ld\n", scenarios[s], groupSizes[g], membership.failed,
+					membership.found, membership.expected, membership.falseRemovals, p50, p99, dmax,
+					(unsigned long long)total.counters[MC_GOSSIP_MESSAGES], (unsigned long long)total.counters[MC_GOSSIP_BYTES],
+					joins, joinBytes, joinCpuUs, wallMs, wallMs * 1000.0 / TOTAL_RUNNING_TIME, usage.ru_maxrss);
+			fflush(csv);
+			printf("%-22s %6d %4ld/%-4ld %7ld %8d %12llu %14llu %6llu %12llu %9.1f %10.1f %10ld\n", scenarios[s], groupSizes[g],
+					membership.found, membership.expected, membership.falseRemovals, p50,
+					(unsigned long long)total.counters[MC_GOSSIP_MESSAGES], (unsigned long long)total.counters[MC_GOSSIP_BYTES],
+					joins, joinBytes, joinCpuUs, wallMs * 1000.0 / TOTAL_RUNNING_TIME, usage.ru_maxrss);
+		}
+	}
+	fclose(csv);
+	return SUCCESS;
+}
+
+/**
+ * FUNCTION NAME: sweepPoint
+ *
+ * DESCRIPTION: One run of the sweep, in the child process: the test case with nodes nodes,
+ * 				writing the event trace, the total metrics of the nodes and the metrics of the
+ * 				introducer that sent the most JOINREP bytes
+ */
+int Application::sweepPoint(const char *conf, int nodes, const char *introducers) {
+	Params *par = new Params();
+	Metrics total;
+	Metrics *introducer = NULL;
+	int ret;
+	int devnull = open("/dev/null", O_WRONLY);
+
+	// the console of the runs would drown the table
+	dup2(devnull, STDOUT_FILENO);
+	close(devnull);
+
+	par->setparams((char *)conf);
+	par->MAX_NNB = par->EN_GPSZ = nodes;
+	par->allNodesJoined = (long)nodes * (nodes - 1) / 2;
+	par->EVENT_TRACE = 1;
+	if ( introducers != NULL ) {
+		par->setintroducers(introducers);
+	}
+	// the introducers of the test case may not all be in a smaller group
+	if ( par->checkintroducers() == FAILURE ) {
+		fprintf(stderr, "%s: INTRODUCERS are node ids from 1 to %d\n", conf, par->EN_GPSZ);
+		return FAILURE;
+	}
+
+	Application *app = new Application(par);
+	app->run();
+	app->totalMetrics(&total);
+	for ( int i = 0; i < par->EN_GPSZ; i++ ) {
+		Metrics *m = &app->mp1[i]->getMemberNode()->metrics;
+		if ( introducer == NULL || m->counters[MC_JOIN_BYTES] > introducer->counters[MC_JOIN_BYTES] ) {
+			introducer = m;
+		}
+	}
+	ret = total.save(SWEEP_METRICS_FILE);
+	if ( ret == SUCCESS ) {
+		ret = introducer->save(SWEEP_INTRODUCER_FILE);
+	}
+	delete(app);
+	return ret;
+}
+
+/**
+ * FUNCTION NAME: mergeNodeFiles
+ *
+ * DESCRIPTION: Merge the files of the node processes into dbg.log, stats.log, msgcount.log
+ * 				and metrics.json.
+ * 				Log records are ordered by time, then by node.
+ */
+void Application::mergeNodeFiles(Params *par) {
+	const char *logs[] = { DBG_LOG, STATS_LOG };
+	char name[64];
+	string header;
+	string line;
+	FILE *fp;
+	int i, f;
+
+	for ( f = 0; f < 2; f++ ) {
+		vector<pair<int, string> > records;
+		for ( i = 1; i <= par->EN_GPSZ; i++ ) {
+			sprintf(name, "node%d.%s", i, logs[f]);
+			ifstream in(name);
+			// dbg.log starts with the magic number
+			if ( f == 0 && getline(in, line) ) {
+				header = line;
+			}
+			while ( getline(in, line) ) {
+				if ( line.empty() ) {
+					continue;
+				}
+				size_t pos = line.find('[');
+				records.push_back(make_pair(pos == string::npos ? 0 : atoi(line.c_str() + pos + 1), line));
+			}
+			in.close();
+			remove(name);
+		}
+		stable_sort(records.begin(), records.end(), [](const pair<int, string> &a, const pair<int, string> &b) { return a.first < b.first; });
+
+		fp = fopen(logs[f], "w");
+		if ( f == 0 ) {
+			fprintf(fp, "%s\n", header.c_str());
+		}
+		for ( i = 0; i < (int)records.size(); i++ ) {
+			fprintf(fp, "\n%s", records[i].second.c_str());
+		}
+		fclose(fp);
+	}
+
+	// msgcount.log lists the nodes one after the other
+	fp = fopen("msgcount.log", "w");
+	for ( i = 1; i <= par->EN_GPSZ; i++ ) {
+		sprintf(name, "node%d.msgcount.log", i);
+		ifstream in(name);
+		while ( getline(in, line) ) {
+			fprintf(fp, "%s\n", line.c_str());
+		}
+		in.close();
+		remove(name);
+	}
+	fclose(fp);
+
+	// metrics.json has the metrics saved by every node process
+	vector<Metrics> metrics(par->EN_GPSZ);
+	vector<pair<int, Metrics *> > nodes;
+	for ( i = 1; i <= par->EN_GPSZ; i++ ) {
+		sprintf(name, "node%d.%s", i, METRICS_NODE_FILE);
+		if ( metrics[i - 1].load(name) == SUCCESS ) {
+			nodes.push_back(make_pair(i, &metrics[i - 1]));
+		}
+		remove(name);
+	}
+	Metrics::writeRun(METRICS_JSON, TOTAL_RUNNING_TIME, nodes);
+}
+
 /**
  * Constructor of the Application class
  */
-Application::Application(char *infile) {
+Application::Application(Params *par, Network *net) {
 	int i;
-	par = new Params();
-	srand (time(NULL));
-	par->setparams(infile);
+	this->par = par;
+	failRng.seed(par->SEED, RNG_FAIL, 0);
+	if ( par->SPAN_TRACE ) {
+		Trace::start();
+	}
 	log = new Log(par);
-	en = new EmulNet(par);
-	mp1 = (MP1Node **) malloc(par->EN_GPSZ * sizeof(MP1Node *));
+	sched = new Scheduler();
+	en = (net != NULL) ? net : createNetwork(0);
+	en->setScheduler(sched, EV_MP1_RECV);
+	mp1.resize(par->EN_GPSZ);
 
 	/*
 	 * Init all nodes
@@ -64,7 +363,9 @@ Application::Application(char *infile) {
 		joinaddr = getjoinaddr();
 		addressOfMemberNode = (Address *) en->ENinit(addressOfMemberNode, par->PORTNUM);
 		mp1[i] = new MP1Node(memberNode, par, en, log, addressOfMemberNode);
-		log->LOG(&(mp1[i]->getMemberNode()->addr), "APP");
+		if ( isLocal(i) ) {
+			log->LOG(&(mp1[i]->getMemberNode()->addr), "APP");
+		}
 		delete addressOfMemberNode;
 	}
 }
@@ -73,15 +374,47 @@ Application::Application(char *infile) {
  * Destructor
  */
 Application::~Application() {
+	char traceName[40];
+	// a node process writes a file of its own, as it does for the logs
+	traceName[0] = 0;
+	if ( par->nodeProcess != 0 ) {
+		sprintf(traceName, "node%d.", par->nodeProcess);
+	}
+	strcat(traceName, TRACE_FILE);
+	Trace::dump(traceName);
 	delete log;
 	delete en;
 	for ( int i = 0; i < par->EN_GPSZ; i++ ) {
 		delete mp1[i];
 	}
-	free(mp1);
+	delete sched;
 	delete par;
 }
 
+/**
+ * FUNCTION NAME: createNetwork
+ *
+ * DESCRIPTION: Network of the transport picked in the parameters
+ */
+Network *Application::createNetwork(int netId) {
+	if ( par->TRANSPORT == UDP_TRANSPORT ) {
+		return new UdpNet(par, netId);
+	}
+	if ( par->TRANSPORT == SHM_TRANSPORT ) {
+		return new ShmNet(par, netId);
+	}
+	return new EmulNet(par, netId);
+}
+
+/**
+ * FUNCTION NAME: isLocal
+ *
+ * DESCRIPTION: Whether the ith node is run by this process
+ */
+bool Application::isLocal(int i) {
+	return par->nodeProcess == 0 || par->nodeProcess == i + 1;
+}
+
 /**
  * FUNCTION NAME: run
  *
@@ -93,18 +426,44 @@ int Application::run()
 	int timeWhenAllNodesHaveJoined = 0;
 	// boolean indicating if all nodes have joined
 	bool allNodesJoined = false;
-	srand(time(NULL));
 
-	// As time runs along
-	for( par->globaltime = 0; par->globaltime < TOTAL_RUNNING_TIME; ++par->globaltime ) {
+	/*
+	 * Introduce the ith node at time STEPRATE*i, drop messages and fail nodes at fixed times
+	 */
+	for( i = 0; i < par->EN_GPSZ; i++ ) {
+		if ( isLocal(i) ) {
+			sched->schedule((int)(par->STEP_RATE*i), i, EV_START);
+		}
+	}
+	sched->schedule(DROP_START_TIME, -1, EV_APP);
+	sched->schedule(FAIL_TIME, -1, EV_APP);
+	sched->schedule(DROP_END_TIME, -1, EV_APP);
+
+	// A node process shares the clock started before the fork
+	if ( par->TICK_MS > 0 && par->nodeProcess == 0 ) {
+		par->startwallclock(0);
+	}
+
+	// As time runs along, skipping the ticks in which nothing happens
+	for( par->globaltime = nextTime(-1); par->globaltime < TOTAL_RUNNING_TIME; par->globaltime = nextTime(par->globaltime) ) {
+		// Nodes with messages that came in from a socket
+		en->ENwait(0);
+		sched->advance(par->globaltime);
 		// Run the membership protocol
 		mp1Run();
 		// Fail some nodes
-		fail();
+		if ( !sched->readySet(EV_APP).empty() ) {
+			fail();
+			sched->readySet(EV_APP).clear();
+		}
+		// The messages of the tick leave together
+		en->ENflush();
 	}
+	par->globaltime = TOTAL_RUNNING_TIME;
 
 	// Clean up
 	en->ENcleanup();
+	writeMetrics();
 
 	for(i=0;i<=par->EN_GPSZ-1;i++) {
 		 mp1[i]->finishUpThisNode();
@@ -113,16 +472,81 @@ int Application::run()
 	return SUCCESS;
 }
 
+/**
+ * FUNCTION NAME: writeMetrics
+ *
+ * DESCRIPTION: Write the metrics of the nodes to metrics.json.
+ * 				A node process saves the metrics of its node for mergeNodeFiles instead.
+ */
+void Application::writeMetrics() {
+	vector<pair<int, Metrics *> > nodes;
+	char name[64];
+
+	for ( int i = 0; i < par->EN_GPSZ; i++ ) {
+		if ( isLocal(i) ) {
+			Member *node = mp1[i]->getMemberNode();
+			nodes.push_back(make_pair(*(int *)(node->addr.addr), &node->metrics));
+		}
+	}
+	if ( par->nodeProcess != 0 ) {
+		sprintf(name, "node%d.%s", par->nodeProcess, METRICS_NODE_FILE);
+		nodes[0].second->save(name);
+		return;
+	}
+	Metrics::writeRun(METRICS_JSON, par->globaltime, nodes);
+}
+
+/**
+ * FUNCTION NAME: totalMetrics
+ *
+ * DESCRIPTION: The metrics of the nodes of this process added up
+ */
+void Application::totalMetrics(Metrics *total) {
+	for ( int i = 0; i < par->EN_GPSZ; i++ ) {
+		if ( isLocal(i) ) {
+			total->merge(mp1[i]->getMemberNode()->metrics);
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: nextTime
+ *
+ * DESCRIPTION: Returns the next tick to run after now.
+ * 				Simulated time jumps to the next scheduled event, wall clock time
+ * 				waits for the clock while listening to the network.
+ * 				A process that fell behind the clock catches up tick by tick,
+ * 				it does not skip the events of the ticks it missed.
+ */
+int Application::nextTime(int now) {
+	int t;
+
+	if ( par->TICK_MS <= 0 ) {
+		return sched->nextTime(now);
+	}
+	while ( (t = par->getwallclocktime()) <= now ) {
+		en->ENwait((int)max(1L, (long)(now + 1) * par->TICK_MS - par->getwallclockms()));
+	}
+	return min(t, sched->nextTime(now));
+}
+
 /**
  * FUNCTION NAME: mp1Run
  *
  * DESCRIPTION:	This function performs all the membership protocol functionalities
  */
 void Application::mp1Run() {
+	TRACE_TICK_SPAN("Application::mp1Run", NULL);
 	int i;
+	set<int> &start = sched->readySet(EV_START);
+	set<int> &mail = sched->readySet(EV_MP1_RECV);
+	set<int> &tick = sched->readySet(EV_MP1_TICK);
+	set<int> starting;
+	set<int> nodes;
 
-	// For all the nodes in the system
-	for( i = 0; i <= par->EN_GPSZ-1; i++) {
+	// For all the nodes with messages waiting in the network
+	for( set<int>::iterator it = mail.begin(); it != mail.end(); it = mail.erase(it) ) {
+		i = *it;
 
 		/*
 		 * Receive messages from the network and queue them in the membership protocol queue
@@ -130,20 +554,31 @@ void Application::mp1Run() {
 		if( par->getcurrtime() > (int)(par->STEP_RATE*i) && !(mp1[i]->getMemberNode()->bFailed) ) {
 			// Receive messages from the network and queue them
 			mp1[i]->recvLoop();
+			tick.insert(i);
+		}
+		else if( par->getcurrtime() <= (int)(par->STEP_RATE*i) ) {
+			// Messages stay in the network until the node is up
+			sched->schedule((int)(par->STEP_RATE*i) + 1, i, EV_MP1_RECV);
 		}
 
 	}
 
-	// For all the nodes in the system
-	for( i = par->EN_GPSZ - 1; i >= 0; i-- ) {
+	starting.swap(start);
+	nodes.insert(starting.begin(), starting.end());
+	nodes.insert(tick.begin(), tick.end());
+	tick.clear();
+
+	// For all the nodes that have something to do
+	for( set<int>::reverse_iterator it = nodes.rbegin(); it != nodes.rend(); ++it ) {
+		i = *it;
 
 		/*
 		 * Introduce nodes into the distributed system
 		 */
-		if( par->getcurrtime() == (int)(par->STEP_RATE*i) ) {
+		if( starting.count(i) ) {
 			// introduce the ith node into the system at time STEPRATE*i
 			mp1[i]->nodeStart(JOINADDR, par->PORTNUM);
-			cout<<i<<"-th introduced node is assigned with the address: "<<mp1[i]->getMemberNode()->addr.getAddress() << endl;
+			LOG_INFO("%d-th introduced node is assigned with the address: %s\n", i, mp1[i]->getMemberNode()->addr.getAddress().c_str());
 			nodeCount += i;
 		}
 
@@ -159,6 +594,18 @@ void Application::mp1Run() {
 			}
 			#endif
 		}
+		else {
+			continue;
+		}
+
+		// Heartbeats are due every tick once the node is in the group
+		if( mp1[i]->getMemberNode()->inGroup && !(mp1[i]->getMemberNode()->bFailed) ) {
+			sched->schedule(par->getcurrtime() + 1, i, EV_MP1_TICK);
+		}
+		// Until then the node only wakes up to retry a JOINREQ nobody answered
+		else if( mp1[i]->joinRetryTime() >= 0 ) {
+			sched->schedule(mp1[i]->joinRetryTime(), i, EV_MP1_TICK);
+		}
 
 	}
 }
@@ -174,28 +621,32 @@ void Application::fail() {
 	int i, removed;
 
 	// fail half the members at time t=400
-	if( par->DROP_MSG && par->getcurrtime() == 50 ) {
+	if( par->DROP_MSG && par->getcurrtime() == DROP_START_TIME ) {
 		par->dropmsg = 1;
 	}
 
-	if( par->SINGLE_FAILURE && par->getcurrtime() == 100 ) {
-		removed = (rand() % par->EN_GPSZ);
+	if( par->SINGLE_FAILURE && par->getcurrtime() == FAIL_TIME ) {
+		removed = failRng.nextInt(par->EN_GPSZ);
 		#ifdef DEBUGLOG
-		log->LOG(&mp1[removed]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
+		if ( isLocal(removed) ) {
+			log->LOG(&mp1[removed]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
+		}
 		#endif
 		mp1[removed]->getMemberNode()->bFailed = true;
 	}
-	else if( par->getcurrtime() == 100 ) {
-		removed = rand() % par->EN_GPSZ/2;
+	else if( par->getcurrtime() == FAIL_TIME ) {
+		removed = failRng.nextInt(par->EN_GPSZ)/2;
 		for ( i = removed; i < removed + par->EN_GPSZ/2; i++ ) {
 			#ifdef DEBUGLOG
-			log->LOG(&mp1[i]->getMemberNode()->addr, "Node failed at time = %d", par->getcurrtime());
+			if ( isLocal(i) ) {
+				log->LOG(&mp1[i]->getMemberNode()->addr, "Node failed at time = %d", par->getcurrtime());
+			}
 			#endif
 			mp1[i]->getMemberNode()->bFailed = true;
 		}
 	}
 
-	if( par->DROP_MSG && par->getcurrtime() == 300) {
+	if( par->DROP_MSG && par->getcurrtime() == DROP_END_TIME) {
 		par->dropmsg=0;
 	}
 
@@ -204,14 +655,13 @@ void Application::fail() {
 /**
  * FUNCTION NAME: getjoinaddr
  *
- * DESCRIPTION: This function returns the address of the coordinator
+ * DESCRIPTION: This function returns the address of the coordinator, the first introducer
  */
 Address Application::getjoinaddr(void){
-	//trace.funcEntry("Application::getjoinaddr");
+	TRACE_CALL_SPAN("Application::getjoinaddr", NULL);
     Address joinaddr;
     joinaddr.init();
-    *(int *)(&(joinaddr.addr))=1;
+    *(int *)(&(joinaddr.addr))=par->INTRODUCERS[0];
     *(short *)(&(joinaddr.addr[4]))=0;
-    //trace.funcExit("Application::getjoinaddr", SUCCESS);
     return joinaddr;
 }
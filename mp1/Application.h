@@ -12,19 +12,37 @@
 #include "Log.h"
 #include "Params.h"
 #include "Member.h"
+#include "Network.h"
 #include "EmulNet.h"
+#include "UdpNet.h"
+#include "ShmNet.h"
 #include "Queue.h"
+#include "Scheduler.h"
+#include "Random.h"
+#include "Trace.h"
+#include "Metrics.h"
+#include "TraceAnalysis.h"
 
 /**
  * global variables
  */
-int nodeCount = 0;
+long nodeCount = 0;
 
 /*
  * Macros
  */
 #define ARGS_COUNT 2
 #define TOTAL_RUNNING_TIME 700
+#define DROP_START_TIME 50
+#define FAIL_TIME 100
+#define DROP_END_TIME 300
+// node processes start counting ticks this long after they are forked
+#define NODE_PROCESS_STARTUP_MS 500
+// group sizes the scaling sweep runs by default, and the files it writes
+#define SWEEP_SIZES "10,20,50,100"
+#define SWEEP_CSV "sweep.csv"
+#define SWEEP_METRICS_FILE "sweep.metrics.txt"
+#define SWEEP_INTRODUCER_FILE "sweep.introducer.txt"
 
 /**
  * CLASS NAME: Application
@@ -36,17 +54,29 @@ private:
 	// Address for introduction to the group
 	// Coordinator Node
 	char JOINADDR[30];
-	EmulNet *en;
+	Network *en;
     Log *log;
-	MP1Node **mp1;
+	vector<MP1Node *> mp1;
 	Params *par;
+	Scheduler *sched;
+	// Random stream of the failure injection
+	Random failRng;
 public:
-	Application(char *);
+	Application(Params *, Network *net = NULL);
 	virtual ~Application();
+	static int runNodeProcesses(Params *par);
+	static void mergeNodeFiles(Params *par);
+	static int sweep(const char *sizes, const char *introducers);
+	static int sweepPoint(const char *conf, int nodes, const char *introducers);
+	Network *createNetwork(int netId);
+	bool isLocal(int i);
 	Address getjoinaddr();
 	int run();
+	int nextTime(int now);
 	void mp1Run();
 	void fail();
+	void writeMetrics();
+	void totalMetrics(Metrics *total);
 };
 
 #endif /* _APPLICATION_H__ */
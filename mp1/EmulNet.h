@@ -7,28 +7,16 @@
 #ifndef _EMULNET_H_
 #define _EMULNET_H_
 
-#define MAX_NODES 1000
-#define MAX_TIME 3600
-#define ENBUFFSIZE 30000
-
 #include "stdincludes.h"
+#include "Network.h"
 #include "Params.h"
 #include "Member.h"
+#include "Scheduler.h"
+#include "Random.h"
+#include "Trace.h"
 
 using namespace std;
 
-/**
- * Struct Name: en_msg
- */
-typedef struct en_msg {
-	// Number of bytes after the class
-	int size;
-	// Source node
-	Address from;
-	// Destination node
-	Address to;
-}en_msg;
-
 /**
  * Class Name: EM
  */
@@ -37,17 +25,14 @@ public:
 	int nextid;
 	int currbuffsize;
 	int firsteltindex;
-	en_msg* buff[ENBUFFSIZE];
+	// messages waiting to be received, by destination node id and channel
+	vector<vector<en_msg *> > buff;
 	EM() {}
 	EM& operator = (EM &anotherEM) {
 		this->nextid = anotherEM.getNextId();
 		this->currbuffsize = anotherEM.getCurrBuffSize();
 		this->firsteltindex = anotherEM.getFirstEltIndex();
-		int i = this->currbuffsize;
-		while (i > 0) {
-			this->buff[i] = anotherEM.buff[i];
-			i--;
-		}
+		this->buff = anotherEM.buff;
 		return *this;
 	}
 	int getNextId() {
@@ -71,29 +56,124 @@ public:
 	virtual ~EM() {}
 };
 
+/**
+ * STRUCT NAME: InFlight
+ *
+ * DESCRIPTION: Message on its way, received from the tick it arrives in
+ */
+typedef struct InFlight {
+	int due;
+	long seq;
+	en_msg *msg;
+	bool operator > (const InFlight &another) const {
+		if ( due != another.due ) {
+			return due > another.due;
+		}
+		return seq > another.seq;
+	}
+}InFlight;
+
+class EmulChannel;
+
 /**
  * CLASS NAME: EmulNet
  *
- * DESCRIPTION: This class defines an emulated network
+ * DESCRIPTION: This class defines an emulated network. It can carry several protocols on
+ * 				channels of their own: every message holds its channel in its header and waits
+ * 				in the queue of its destination and channel. The channels share the buffer and
+ * 				the links, a channel coming first in the limits and on the links of the ones
+ * 				after it. The network itself is channel 0, channel() the others.
  */
-class EmulNet
+class EmulNet : public Network
 { 	
 private:
 	Params* par;
-	int sent_msgs[MAX_NODES + 1][MAX_TIME];
-	int recv_msgs[MAX_NODES + 1][MAX_TIME];
+	MsgCounts counts;
 	int enInited;
+	int channels;
 	EM emulnet;
+	// Scheduler notified of messages waiting for a node, with an event per channel
+	Scheduler *sched;
+	vector<EventType> recvEvent;
+	// Random streams for message drops, by sending node and channel
+	vector<Random> rng;
+	// Random streams for link delays, by sending node and channel
+	vector<Random> delayRng;
+	// Messages sent with a delay, by tick of arrival
+	priority_queue<InFlight, vector<InFlight>, greater<InFlight> > inflight;
+	long nextSeq;
+	// Time the egress link of a node is free again for a channel, in ticks
+	vector<double> egressFree;
+	// Messages waiting or on their way, by channel
+	vector<int> held;
+	// the same, by node and channel, the load of the inbox of the node
+	vector<int> queued;
+	// the networks the protocols of the other channels see
+	vector<EmulChannel *> views;
+	int slot(int id, int channel) {
+		return id * channels + channel;
+	}
+	int load(vector<int> &counts, int first, int channel);
+	bool full(int dst, int channel);
+	int sampleDelay(LinkDelay *delay, int src, int channel);
+	int arrival(int src, int dst, int bytes, int time, int channel);
 public:
- 	EmulNet(Params *p);
+ 	EmulNet(Params *p, int netId = 0, int channels = 1);
  	EmulNet(EmulNet &anotherEmulNet);
  	EmulNet& operator = (EmulNet &anotherEmulNet);
  	virtual ~EmulNet();
+	using Network::ENsend;
 	void *ENinit(Address *myaddr, short port);
-	int ENsend(Address *myaddr, Address *toaddr, string data);
 	int ENsend(Address *myaddr, Address *toaddr, char *data, int size);
 	int ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue);
+	bool ENcongested(Address *toaddr);
 	int ENcleanup();
+	void setScheduler(Scheduler *sched, EventType recvEvent);
+	int checkpoint(Checkpoint *ck);
+	int restore(Checkpoint *ck);
+	Network *channel(int id);
+	int send(int channel, Address *myaddr, Address *toaddr, char *data, int size);
+	int recv(int channel, Address *myaddr, int (* enq)(void *, char *, int), void *queue);
+	bool congested(int channel, Address *toaddr);
+	void setScheduler(Scheduler *sched, EventType recvEvent, int channel);
+};
+
+/**
+ * CLASS NAME: EmulChannel
+ *
+ * DESCRIPTION: Channel of an EmulNet, the network as the protocol sending on it sees it.
+ * 				It hands out the node ids in the same order as the network.
+ */
+class EmulChannel : public Network
+{
+private:
+	EmulNet *net;
+	int id;
+	int nextid;
+public:
+	EmulChannel(EmulNet *net, int id): net(net), id(id), nextid(1) {}
+	using Network::ENsend;
+	void *ENinit(Address *myaddr, short port) {
+		*(int *)(myaddr->addr) = nextid++;
+		*(short *)(&myaddr->addr[4]) = 0;
+		return myaddr;
+	}
+	int ENsend(Address *myaddr, Address *toaddr, char *data, int size) {
+		return net->send(id, myaddr, toaddr, data, size);
+	}
+	int ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue) {
+		return net->recv(id, myaddr, enq, queue);
+	}
+	bool ENcongested(Address *toaddr) {
+		return net->congested(id, toaddr);
+	}
+	// the network cleans up, checkpoints and restores all its channels at once
+	int ENcleanup() {
+		return 0;
+	}
+	void setScheduler(Scheduler *sched, EventType recvEvent) {
+		net->setScheduler(sched, recvEvent, id);
+	}
 };
 
 #endif /* _EMULNET_H_ */
@@ -4,6 +4,8 @@
 #*
 #* Current file: Grader.sh
 #* About this file: Grading Script.
+#* TRANSPORT=udp or TRANSPORT=udp-procs runs the tests over real sockets,
+#* TRANSPORT=shm or TRANSPORT=shm-procs over shared memory rings.
 #* 
 #***********************
 #!/bin/sh
@@ -31,11 +33,11 @@ echo "============================"
 if [ $verbose -eq 0 ]; then
 	make clean > /dev/null
 	make > /dev/null
-	./Application testcases/singlefailure.conf > /dev/null
+	./Application testcases/singlefailure.conf $TRANSPORT > /dev/null
 else
 	make clean
 	make
-	./Application testcases/singlefailure.conf
+	./Application testcases/singlefailure.conf $TRANSPORT
 fi
 joincount=`grep joined dbg.log | cut -d" " -f2,4-7 | sort -u | wc -l`
 if [ $joincount -eq 100 ]; then
@@ -80,11 +82,11 @@ echo "============================"
 if [ $verbose -eq 0 ]; then
 	make clean > /dev/null
 	make > /dev/null
-	./Application testcases/multifailure.conf > /dev/null
+	./Application testcases/multifailure.conf $TRANSPORT > /dev/null
 else
 	make clean
 	make
-	./Application testcases/multifailure.conf
+	./Application testcases/multifailure.conf $TRANSPORT
 fi
 joincount=`grep joined dbg.log | cut -d" " -f2,4-7 | sort -u | wc -l`
 if [ $joincount -eq 100 ]; then
@@ -143,11 +145,11 @@ echo "============================"
 if [ $verbose -eq 0 ]; then
 	make clean > /dev/null
 	make > /dev/null
-	./Application testcases/msgdropsinglefailure.conf > /dev/null
+	./Application testcases/msgdropsinglefailure.conf $TRANSPORT > /dev/null
 else
 	make clean
 	make
-	./Application testcases/msgdropsinglefailure.conf
+	./Application testcases/msgdropsinglefailure.conf $TRANSPORT
 fi
 joincount=`grep joined dbg.log | cut -d" " -f2,4-7 | sort -u | wc -l`
 if [ $joincount -eq 100 ]; then
@@ -6,12 +6,174 @@
 
 #include "Log.h"
 
+LogWriter *Log::writer = NULL;
+int Log::users = 0;
+EventTrace *Log::trace = NULL;
+bool Log::addressed = false;
+thread_local LogChunk *Log::chunks[LOG_FILES];
+
+/**
+ * Constructor
+ */
+LogWriter::LogWriter(const char *dbgName, const char *statsName) {
+	files[LOG_DBG] = fopen(dbgName, "w");
+	files[LOG_STATS] = fopen(statsName, "w");
+	stub = new LogChunk;
+	stub->next.store(NULL);
+	head.store(stub);
+	tail = stub;
+	sleeping.store(false);
+	stopping.store(false);
+	worker = thread(&LogWriter::run, this);
+}
+
+/**
+ * Destructor. Writes out everything pushed so far.
+ */
+LogWriter::~LogWriter() {
+	stopping.store(true);
+	{
+		lock_guard<mutex> guard(lock);
+		wakeup.notify_one();
+	}
+	worker.join();
+	fclose(files[LOG_DBG]);
+	fclose(files[LOG_STATS]);
+	delete stub;
+}
+
+/**
+ * FUNCTION NAME: enqueue
+ *
+ * DESCRIPTION: Add a chunk at the head of the queue, any thread
+ */
+void LogWriter::enqueue(LogChunk *chunk) {
+	chunk->next.store(NULL, memory_order_relaxed);
+	LogChunk *prev = head.exchange(chunk, memory_order_acq_rel);
+	prev->next.store(chunk, memory_order_release);
+}
+
+/**
+ * FUNCTION NAME: dequeue
+ *
+ * DESCRIPTION: Take the chunk at the tail of the queue, writer thread only
+ *
+ * RETURNS:
+ * NULL if the queue is empty or the next chunk is still being linked in
+ */
+LogChunk *LogWriter::dequeue() {
+	LogChunk *t = tail;
+	LogChunk *next = t->next.load(memory_order_acquire);
+
+	if ( t == stub ) {
+		if ( next == NULL ) {
+			return NULL;
+		}
+		tail = next;
+		t = next;
+		next = next->next.load(memory_order_acquire);
+	}
+	if ( next != NULL ) {
+		tail = next;
+		return t;
+	}
+	if ( t != head.load(memory_order_acquire) ) {
+		return NULL;
+	}
+	// t is the last chunk, the stub goes behind it so that it can be taken
+	enqueue(stub);
+	next = t->next.load(memory_order_acquire);
+	if ( next != NULL ) {
+		tail = next;
+		return t;
+	}
+	return NULL;
+}
+
+/**
+ * FUNCTION NAME: empty
+ *
+ * DESCRIPTION: Whether no chunk is queued, writer thread only
+ */
+bool LogWriter::empty() {
+	return tail == stub && stub->next.load() == NULL && head.load() == stub;
+}
+
+/**
+ * FUNCTION NAME: push
+ *
+ * DESCRIPTION: Hand a full chunk to the writer thread, waking it up if it sleeps
+ */
+void LogWriter::push(LogChunk *chunk) {
+	enqueue(chunk);
+	if ( sleeping.load() ) {
+		lock_guard<mutex> guard(lock);
+		wakeup.notify_one();
+	}
+}
+
+/**
+ * FUNCTION NAME: run
+ *
+ * DESCRIPTION: Writer thread. Writes the chunks in the order they were pushed,
+ * 				flushing the files once the queue is drained.
+ */
+void LogWriter::run() {
+	LogChunk *chunk;
+	bool stop;
+
+	while ( true ) {
+		stop = stopping.load();
+		while ( (chunk = dequeue()) != NULL ) {
+			fwrite(chunk->data, 1, chunk->size, files[chunk->file]);
+			delete chunk;
+		}
+		fflush(files[LOG_DBG]);
+		fflush(files[LOG_STATS]);
+		// every chunk was pushed before stopping was set
+		if ( stop && empty() ) {
+			return;
+		}
+
+		unique_lock<mutex> guard(lock);
+		sleeping.store(true);
+		// a chunk pushed before sleeping was set is seen here, a later one wakes us up
+		if ( empty() && !stopping.load() ) {
+			wakeup.wait_for(guard, chrono::milliseconds(LOG_IDLE_MS));
+		}
+		sleeping.store(false);
+	}
+}
+
 /**
  * Constructor
  */
 Log::Log(Params *p) {
+	char dbgName[40];
+	char statsName[40];
+
 	par = p;
 	firstTime = false;
+
+	if ( users++ == 0 ) {
+		dbgName[0] = 0;
+		// a node process logs to files of its own, merged when the run is over
+		if ( par->nodeProcess != 0 ) {
+			sprintf(dbgName, "node%d.", par->nodeProcess);
+		}
+		strcpy(statsName, dbgName);
+		strcat(dbgName, DBG_LOG);
+		strcat(statsName, STATS_LOG);
+		writer = new LogWriter(dbgName, statsName);
+
+		if ( par->EVENT_TRACE ) {
+			// the trace files take the same prefix
+			strcpy(statsName, dbgName);
+			strcpy(dbgName + strlen(dbgName) - strlen(DBG_LOG), TRACE_BIN);
+			strcpy(statsName + strlen(statsName) - strlen(DBG_LOG), TRACE_STR);
+			trace = new EventTrace(dbgName, statsName, par);
+		}
+	}
 }
 
 /**
@@ -20,6 +182,7 @@ Log::Log(Params *p) {
 Log::Log(const Log &anotherLog) {
 	this->par = anotherLog.par;
 	this->firstTime = anotherLog.firstTime;
+	users++;
 }
 
 /**
@@ -32,49 +195,109 @@ Log& Log::operator = (const Log& anotherLog) {
 }
 
 /**
- * Destructor
+ * Destructor. The last Log of the process waits for the writer thread to write everything out.
  */
-Log::~Log() {}
+Log::~Log() {
+	flush();
+	if ( --users == 0 ) {
+		delete writer;
+		writer = NULL;
+		delete trace;
+		trace = NULL;
+	}
+}
 
 /**
- * FUNCTION NAME: LOG
+ * FUNCTION NAME: chunkFor
  *
- * DESCRIPTION: Print out to file dbg.log, along with Address of node.
+ * DESCRIPTION: Chunk of this thread for the file with room for a record,
+ * 				the full one is handed to the writer thread
  */
-void Log::LOG(Address *addr, const char * str, ...) {
+LogChunk *Log::chunkFor(int file) {
+	LogChunk *chunk = chunks[file];
 
-	static FILE *fp;
-	static FILE *fp2;
-	va_list vararglist;
-	static char buffer[30000];
-	static int numwrites;
-	static char stdstring[30];
-	static char stdstring2[40];
-	static char stdstring3[40]; 
-	static int dbg_opened=0;
+	if ( chunk != NULL && chunk->size + LOG_RECORD_SIZE + 64 > LOG_CHUNK_SIZE ) {
+		writer->push(chunk);
+		chunk = NULL;
+	}
+	if ( chunk == NULL ) {
+		chunk = new LogChunk;
+		chunk->file = file;
+		chunk->size = 0;
+		chunks[file] = chunk;
+	}
+	return chunk;
+}
 
-	if(dbg_opened != 639){
-		numwrites=0;
+/**
+ * FUNCTION NAME: appendRecord
+ *
+ * DESCRIPTION: Add "\n <addr>[<time>] <record>" to the chunk of this thread for the file.
+ * 				Copied rather than formatted, this is what every LOG costs.
+ */
+void Log::appendRecord(int file, const char *addr, int time, const char *record, int len) {
+	LogChunk *chunk = chunkFor(file);
+	char *p = chunk->data + chunk->size;
+	int n = strlen(addr);
 
-		stdstring2[0]=0;
+	*p++ = '\n';
+	*p++ = ' ';
+	memcpy(p, addr, n);
+	p += n;
+	p += sprintf(p, "[%d] ", time);
+	memcpy(p, record, len);
+	p += len;
+	chunk->size = p - chunk->data;
+}
 
-		strcpy(stdstring3, stdstring2);
+/**
+ * FUNCTION NAME: append
+ *
+ * DESCRIPTION: Format into the chunk of this thread for the file
+ */
+void Log::append(int file, const char *format, ...) {
+	LogChunk *chunk = chunkFor(file);
+	va_list vararglist;
+	int n;
 
-		strcat(stdstring2, DBG_LOG);
-		strcat(stdstring3, STATS_LOG);
+	va_start(vararglist, format);
+	n = vsnprintf(chunk->data + chunk->size, LOG_CHUNK_SIZE - chunk->size, format, vararglist);
+	va_end(vararglist);
 
-		fp = fopen(stdstring2, "w");
-		fp2 = fopen(stdstring3, "w");
+	chunk->size += min(n, LOG_CHUNK_SIZE - chunk->size - 1);
+}
 
-		dbg_opened=639;
+/**
+ * FUNCTION NAME: flush
+ *
+ * DESCRIPTION: Hand the records this thread logged so far to the writer thread
+ */
+void Log::flush() {
+	for ( int i = 0; i < LOG_FILES; i++ ) {
+		if ( chunks[i] != NULL ) {
+			writer->push(chunks[i]);
+			chunks[i] = NULL;
+		}
 	}
-	else 
+}
 
-	sprintf(stdstring, "%d.%d.%d.%d:%d ", addr->addr[0], addr->addr[1], addr->addr[2], addr->addr[3], *(short *)&addr->addr[4]);
+/**
+ * FUNCTION NAME: write
+ *
+ * DESCRIPTION: Write the record of the event to its log file, along with Address of node,
+ * 				and to the event trace
+ */
+void Log::write(Address *addr, TraceEvent *ev, const char *record, int len) {
+	char stdstring[30];
 
-	va_start(vararglist, str);
-	vsprintf(buffer, str, vararglist);
-	va_end(vararglist);
+	stdstring[0] = 0;
+	if ( addressed ) {
+		sprintf(stdstring, "%d.%d.%d.%d:%d ", addr->addr[0], addr->addr[1], addr->addr[2], addr->addr[3], *(short *)&addr->addr[4]);
+	}
+	else {
+		ev->flags |= TRF_NOADDR;
+	}
+	addressed = true;
 
 	if (!firstTime) {
 		int magicNumber = 0;
@@ -83,29 +306,48 @@ void Log::LOG(Address *addr, const char * str, ...) {
 		for ( int i = 0; i < len; i++ ) {
 			magicNumber += (int)magic.at(i);
 		}
-		fprintf(fp, "%x\n", magicNumber);
+		append(LOG_DBG, "%x\n", magicNumber);
+		if ( trace != NULL ) {
+			TraceEvent magicEvent = { TR_MAGIC, 0, NULL, magicNumber, NULL, NULL };
+			trace->record(par->getcurrtime(), addr, &magicEvent, NULL);
+		}
 		firstTime = true;
 	}
 
-	if(memcmp(buffer, "#STATSLOG#", 10)==0){
-		fprintf(fp2, "\n %s", stdstring);
-		fprintf(fp2, "[%d] ", par->getcurrtime());
-
-		fprintf(fp2, buffer);
+	// the trace keeps the text of the lines it cannot tell apart otherwise
+	if ( trace != NULL ) {
+		trace->record(par->getcurrtime(), addr, ev, ev->type < TR_NODE_ADD ? record : NULL);
 	}
-	else{
-		fprintf(fp, "\n %s", stdstring);
-		fprintf(fp, "[%d] ", par->getcurrtime());
-		fprintf(fp, buffer);
 
-	}
+	appendRecord(ev->type == TR_STATS ? LOG_STATS : LOG_DBG, stdstring, par->getcurrtime(), record, len);
+}
+
+/**
+ * FUNCTION NAME: LOG
+ *
+ * DESCRIPTION: Log to file dbg.log, along with Address of node.
+ * 				Records starting with #STATSLOG# go to stats.log.
+ */
+void Log::LOG(Address *addr, const char * str, ...) {
+
+	va_list vararglist;
+	static thread_local char buffer[LOG_RECORD_SIZE];
+	TraceEvent ev = { TR_TEXT, 0, NULL, 0, NULL, NULL };
+	int len;
 
-	if(++numwrites >= MAXWRITES){
-		fflush(fp);
-		fflush(fp2);
-		numwrites=0;
+	va_start(vararglist, str);
+	len = vsnprintf(buffer, LOG_RECORD_SIZE, str, vararglist);
+	va_end(vararglist);
+	len = min(len, LOG_RECORD_SIZE - 1);
+
+	if(memcmp(buffer, "#STATSLOG#", 10)==0){
+		ev.type = TR_STATS;
+	}
+	else if(memcmp(buffer, "Node failed", 11)==0){
+		ev.type = TR_NODE_FAIL;
 	}
 
+	write(addr, &ev, buffer, len);
 }
 
 /**
@@ -115,8 +357,9 @@ void Log::LOG(Address *addr, const char * str, ...) {
  */
 void Log::logNodeAdd(Address *thisNode, Address *addedAddr) {
 	static char stdstring[100];
+	TraceEvent ev = { TR_NODE_ADD, 0, addedAddr, 0, NULL, NULL };
 	sprintf(stdstring, "Node %d.%d.%d.%d:%d joined at time %d", addedAddr->addr[0], addedAddr->addr[1], addedAddr->addr[2], addedAddr->addr[3], *(short *)&addedAddr->addr[4], par->getcurrtime());
-    LOG(thisNode, stdstring);
+    write(thisNode, &ev, stdstring, strlen(stdstring));
 }
 
 /**
@@ -125,7 +368,8 @@ void Log::logNodeAdd(Address *thisNode, Address *addedAddr) {
  * DESCRIPTION: To log a node remove
  */
 void Log::logNodeRemove(Address *thisNode, Address *removedAddr) {
-	static char stdstring[30];
+	static char stdstring[100];
+	TraceEvent ev = { TR_NODE_REMOVE, 0, removedAddr, 0, NULL, NULL };
 	sprintf(stdstring, "Node %d.%d.%d.%d:%d removed at time %d", removedAddr->addr[0], removedAddr->addr[1], removedAddr->addr[2], removedAddr->addr[3], *(short *)&removedAddr->addr[4], par->getcurrtime());
-    LOG(thisNode, stdstring);
+    write(thisNode, &ev, stdstring, strlen(stdstring));
 }
@@ -0,0 +1,74 @@
+/**********************************
+ * FILE NAME: LogBench.cpp
+ *
+ * DESCRIPTION: Records per second of the Log class.
+ * 				Writes dbg.log and stats.log in the current directory, as the Application does.
+ **********************************/
+
+#include "stdincludes.h"
+#include "Params.h"
+#include "Member.h"
+#include "Log.h"
+
+/**
+ * FUNCTION NAME: nowSec
+ *
+ * DESCRIPTION: Monotonic clock in seconds
+ */
+static double nowSec() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**********************************
+ * FUNCTION NAME: main
+ *
+ * DESCRIPTION: main function. Usage: ./LogBench [records] [event trace 0/1]
+ * 				Logs node adds, one in ten records goes to stats.log.
+ **********************************/
+int main(int argc, char *argv[]) {
+	Params *par = new Params();
+	long total = (argc > 1) ? atol(argv[1]) : 1000000;
+	Address self, other;
+	Log *log;
+	double start, logged, done;
+	long i;
+
+	if ( total <= 0 ) {
+		cout<<"Usage: ./LogBench [records] [event trace 0/1]"<<endl;
+		return FAILURE;
+	}
+
+	par->EN_GPSZ = 10;
+	par->globaltime = 0;
+	par->nodeProcess = 0;
+	par->TICK_MS = 0;
+	par->EVENT_TRACE = (argc > 2) ? atoi(argv[2]) : 0;
+	par->epochMs = 0;
+	*(int *)(self.addr) = 1;
+	*(short *)(&self.addr[4]) = 0;
+
+	log = new Log(par);
+	start = nowSec();
+	for ( i = 0; i < total; i++ ) {
+		par->globaltime = (int)(i / 1000);
+		*(int *)(other.addr) = (int)(i % par->EN_GPSZ) + 1;
+		*(short *)(&other.addr[4]) = 0;
+		if ( i % 10 == 9 ) {
+			log->LOG(&self, "#STATSLOG#heartbeat %ld", i);
+		}
+		else {
+			log->logNodeAdd(&self, &other);
+		}
+	}
+	logged = nowSec();
+	// the records are all on disk once the log is gone
+	delete log;
+	done = nowSec();
+
+	printf("%ld records: %.0f records/sec logged, %.0f records/sec on disk\n", total, total / (logged - start), total / (done - start));
+
+	delete par;
+	return SUCCESS;
+}
@@ -16,7 +16,7 @@
  * You can add new members to the class if you think it
  * is necessary for your logic to work
  */
-MP1Node::MP1Node(Member *member, Params *params, EmulNet *emul, Log *log, Address *address) {
+MP1Node::MP1Node(Member *member, Params *params, Network *emul, Log *log, Address *address) {
 	for( int i = 0; i < 6; i++ ) {
 		NULLADDR[i] = 0;
 	}
@@ -25,6 +25,21 @@ MP1Node::MP1Node(Member *member, Params *params, EmulNet *emul, Log *log, Addres
 	this->log = log;
 	this->par = params;
 	this->memberNode->addr = *address;
+	this->joinAttempts = 0;
+	this->joinSentAt = -1;
+	this->piggybackSentAt.assign(params->EN_GPSZ + 1, -1);
+	this->piggybackNext = 0;
+}
+
+/**
+ * FUNCTION NAME: threadCpuNs
+ *
+ * DESCRIPTION: CPU time of the calling thread in ns
+ */
+static long threadCpuNs() {
+	struct timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return ts.tv_sec * 1000000000L + ts.tv_nsec;
 }
 
 /**
@@ -39,6 +54,7 @@ MP1Node::~MP1Node() {}
  * 				This function is called by a node to receive messages currently waiting for it
  */
 int MP1Node::recvLoop() {
+    TRACE_PHASE_SPAN("MP1Node::recvLoop", &memberNode->addr);
     if ( memberNode->bFailed ) {
     	return false;
     }
@@ -54,7 +70,7 @@ int MP1Node::recvLoop() {
  */
 int MP1Node::enqueueWrapper(void *env, char *buff, int size) {
 	Queue q;
-	return q.enqueue((queue<q_elt> *)env, (void *)buff, size);
+	return q.enqueue((MsgQueue *)env, (void *)buff, size);
 }
 
 /**
@@ -108,10 +124,39 @@ int MP1Node::initThisNode(Address *joinaddr) {
 	memberNode->pingCounter = TFAIL;
 	memberNode->timeOutCounter = -1;
     initMemberListTable(memberNode);
+    pendingJoins.clear();
+    joinAttempts = 0;
+    joinSentAt = -1;
 
     return 0;
 }
 
+/**
+ * FUNCTION NAME: bootstrap
+ *
+ * DESCRIPTION: Start the node in the group the joins would converge to: every other node
+ * 				of the group is a member already and no JOINREQ is sent
+ */
+void MP1Node::bootstrap(vector<Address> &group) {
+    Address joinaddr = getJoinAddress();
+
+    initThisNode(&joinaddr);
+    memberNode->inGroup = true;
+    memberNode->memberList.reserve(group.size());
+    for (Address &addr: group) {
+        if (addr == memberNode->addr) {
+            continue;
+        }
+        int id = *(int *)(&addr.addr);
+        short port = *(short *)(&addr.addr[4]);
+        memberNode->memberList.push_back(MemberListEntry(id, port, 0, par->getcurrtime()));
+        if (par->MEMBER_TABLE) {
+            memberNode->memberTable.add(id, memberNode->memberList.size() - 1, 0, par->getcurrtime());
+        }
+    }
+    memberNode->memberListVersion++;
+}
+
 /**
  * FUNCTION NAME: introduceSelfToGroup
  *
@@ -145,6 +190,9 @@ int MP1Node::introduceSelfToGroup(Address *joinaddr) {
 
         // send JOINREQ message to introducer member
         emulNet->ENsend(&memberNode->addr, joinaddr, (char *)msg, sizeof(MessageHdr));
+        memberNode->metrics.add(MC_GOSSIP_MESSAGES);
+        memberNode->metrics.add(MC_GOSSIP_BYTES, sizeof(MessageHdr));
+        joinSentAt = par->getcurrtime();
 
         free(msg);
     }
@@ -171,6 +219,7 @@ int MP1Node::finishUpThisNode(){
  * 				Check your messages in queue and perform membership protocol duties
  */
 void MP1Node::nodeLoop() {
+    TRACE_TICK_SPAN("MP1Node::nodeLoop", &memberNode->addr);
     if (memberNode->bFailed) {
     	return;
     }
@@ -180,6 +229,7 @@ void MP1Node::nodeLoop() {
 
     // Wait until you're in the group...
     if( !memberNode->inGroup ) {
+    	retryJoin();
     	return;
     }
 
@@ -195,9 +245,12 @@ void MP1Node::nodeLoop() {
  * DESCRIPTION: Check messages in the queue and call the respective message handler
  */
 void MP1Node::checkMessages() {
+    TRACE_PHASE_SPAN("MP1Node::checkMessages", &memberNode->addr);
     void *ptr;
     int size;
 
+    memberNode->metrics.set(MG_MP1Q_DEPTH, memberNode->mp1q.size());
+
     // Pop waiting messages from memberNode's mp1q
     while ( !memberNode->mp1q.empty() ) {
     	ptr = memberNode->mp1q.front().elt;
@@ -205,6 +258,7 @@ void MP1Node::checkMessages() {
     	memberNode->mp1q.pop();
     	recvCallBack((void *)memberNode, (char *)ptr, size);
     }
+    answerJoins();
     return;
 }
 
@@ -214,32 +268,52 @@ void MP1Node::checkMessages() {
  * DESCRIPTION: Message handler for different message types
  */
 bool MP1Node::recvCallBack(void *env, char *data, int size ) {
+    TRACE_CALL_SPAN("MP1Node::recvCallBack", &memberNode->addr);
 
     MessageHdr *msg = (MessageHdr *) data;
 
-    if (msg->msgType == MsgTypes::JOINREQ) {
-        addNewMember(msg);
+    // The member list follows the header, drop anything that does not add up
+    if (size < (int) sizeof(MessageHdr) || msg->countMembers < 0 ||
+        size - sizeof(MessageHdr) != msg->countMembers * sizeof(MemberListEntry)) {
+        free(msg);
+        return false;
+    }
+    msg->members = (MemberListEntry *) (msg + 1);
 
-        MessageHdr *repMsg = createMessage(MsgTypes::JOINREP);
+    // a node outside the group has no group to let a joiner into, the joiner retries elsewhere
+    if (msg->msgType == MsgTypes::JOINREQ && !memberNode->inGroup) {
+        free(msg);
+        return false;
+    }
 
-        emulNet->ENsend(&memberNode->addr, &msg->addr, (char *) repMsg, sizeof(MessageHdr));
-        std::cout << "send [" << par->getcurrtime() << "] JOINREP [" << memberNode->addr.getAddress() << "] to " << msg->addr.getAddress() << std::endl;
+    if (msg->msgType == MsgTypes::JOINREQ) {
+        long start = threadCpuNs();
 
-        delete repMsg;
+        addNewMember(msg);
+        pendingJoins.push_back(msg->addr);
+        memberNode->metrics.add(MC_JOIN_REQUESTS);
+        memberNode->metrics.add(MC_JOIN_CPU_NS, threadCpuNs() - start);
     } else if (msg->msgType == MsgTypes::JOINREP) {
         memberNode->inGroup = true;
 
-        std::cout << "receive [" << par->getcurrtime() << "]  JOINREP [" << memberNode->addr.getAddress() << "] from " << msg->addr.getAddress() << std::endl;
-        addNewMember(msg);
+        LOG_DEBUG("receive [%d]  JOINREP [%s] from %s\n", par->getcurrtime(), memberNode->addr.getAddress().c_str(), msg->addr.getAddress().c_str());
+        // the JOINREP carries the membership list of the introducer, taken in as a ping
+        pingHandler(msg);
     } else if (msg->msgType == MsgTypes::PING) {
-        std::cout << "receive [" << par->getcurrtime() << "] PING [" << memberNode->addr.getAddress() << "] from " << msg->addr.getAddress() << std::endl;
+        LOG_DEBUG("receive [%d] PING [%s] from %s\n", par->getcurrtime(), memberNode->addr.getAddress().c_str(), msg->addr.getAddress().c_str());
         pingHandler(msg);
     }
 
     free(msg);
+    return true;
 }
 
 void MP1Node::pingHandler(MessageHdr *m) {
+    if (par->MEMBER_TABLE) {
+        pingTableHandler(m);
+        return;
+    }
+
     // update current node counter
     MemberListEntry *localMember = findMember(&m->addr);
 
@@ -266,6 +340,94 @@ void MP1Node::pingHandler(MessageHdr *m) {
     }
 }
 
+/**
+ * FUNCTION NAME: pingTableHandler
+ *
+ * DESCRIPTION: pingHandler on the dense membership table: the heartbeats of the known
+ * 				members are staged and merged in one pass, new members are added as before
+ */
+void MP1Node::pingTableHandler(MessageHdr *m) {
+    MemberTable *table = &memberNode->memberTable;
+
+    if (findMember(&m->addr) != nullptr) {
+        table->touch(*(int *)(&m->addr.addr), par->getcurrtime());
+    } else {
+        addNewMember(m);
+    }
+
+    for(int i = 0; i < m->countMembers; i++) {
+        MemberListEntry *gossipMember = &m->members[i];
+
+        if (findMember(gossipMember->id, gossipMember->port) != nullptr) {
+            table->stage(gossipMember->id, gossipMember->heartbeat);
+        } else {
+            addNewMember(gossipMember);
+        }
+    }
+    table->merge(par->getcurrtime());
+}
+
+/**
+ * FUNCTION NAME: answerJoins
+ *
+ * DESCRIPTION: Answer the JOINREQs of this tick. The joiners share one JOINREP,
+ * 				a snapshot of the membership list that already holds all of them.
+ */
+void MP1Node::answerJoins() {
+    long start;
+    int repSize;
+
+    if (pendingJoins.empty()) {
+        return;
+    }
+    start = threadCpuNs();
+    MessageHdr *repMsg = createMessage(MsgTypes::JOINREP, &repSize);
+
+    for (Address &joiner: pendingJoins) {
+        emulNet->ENsend(&memberNode->addr, &joiner, (char *) repMsg, repSize);
+        memberNode->metrics.add(MC_GOSSIP_MESSAGES);
+        memberNode->metrics.add(MC_GOSSIP_BYTES, repSize);
+        memberNode->metrics.record(MH_GOSSIP_BYTES, repSize);
+        memberNode->metrics.add(MC_JOIN_BYTES, repSize);
+        LOG_DEBUG("send [%d] JOINREP [%s] to %s\n", par->getcurrtime(), memberNode->addr.getAddress().c_str(), joiner.getAddress().c_str());
+    }
+    free(repMsg);
+    pendingJoins.clear();
+    memberNode->metrics.add(MC_JOIN_CPU_NS, threadCpuNs() - start);
+}
+
+/**
+ * FUNCTION NAME: retryJoin
+ *
+ * DESCRIPTION: Ask the next introducer when no JOINREP came back within TJOIN ticks,
+ * 				so a failed introducer or a lost JOINREQ does not keep the node out
+ */
+void MP1Node::retryJoin() {
+    if (joinSentAt < 0 || par->getcurrtime() - joinSentAt < TJOIN) {
+        return;
+    }
+    joinAttempts++;
+    Address joinaddr = getJoinAddress();
+    introduceSelfToGroup(&joinaddr);
+}
+
+/**
+ * FUNCTION NAME: joinRetryTime
+ *
+ * DESCRIPTION: Tick at which retryJoin asks the next introducer, should the JOINREQ sent
+ * 				this tick get no JOINREP. A node outside the group only runs when it has
+ * 				mail, so it has to be woken up then.
+ *
+ * RETURNS:
+ * the tick, -1 if the node sent no JOINREQ this tick
+ */
+int MP1Node::joinRetryTime() {
+    if (memberNode->inGroup || joinSentAt != par->getcurrtime()) {
+        return -1;
+    }
+    return joinSentAt + TJOIN;
+}
+
 int MP1Node::getMemberPosition(MemberListEntry *e) {
     for(int i = 0; i < memberNode->memberList.size(); i++) {
         MemberListEntry clusterMemb = memberNode->memberList[i];
@@ -278,49 +440,46 @@ int MP1Node::getMemberPosition(MemberListEntry *e) {
 
 
 MemberListEntry* MP1Node::findMember(int id, short port) {
-    for(int i = 0; i < memberNode->memberList.size(); i++) {
-        MemberListEntry *clusterMemb = memberNode->memberList.data() + i;
+    if (par->MEMBER_TABLE) {
+        int pos = memberNode->memberTable.positionOf(id);
 
-        if (clusterMemb->id == id && clusterMemb->port == port) {
-            return clusterMemb;
+        if (pos >= 0 && memberNode->memberList[pos].port == port) {
+            return memberNode->memberList.data() + pos;
         }
+        return nullptr;
     }
 
-    return nullptr;
-}
-
-MemberListEntry* MP1Node::findMember(Address *addr) {
     for(int i = 0; i < memberNode->memberList.size(); i++) {
         MemberListEntry *clusterMemb = memberNode->memberList.data() + i;
-        Address *memberAddr = getAddr(clusterMemb->id, clusterMemb->port);
 
-        if (*addr == *memberAddr) {
+        if (clusterMemb->id == id && clusterMemb->port == port) {
             return clusterMemb;
         }
-
-        delete memberAddr;
     }
 
     return nullptr;
 }
 
-void MP1Node::addNewMember(MemberListEntry *e) {
-    Address *addr = getAddr(*e);
+MemberListEntry* MP1Node::findMember(Address *addr) {
+    return findMember(*(int *)(&addr->addr), *(short *)(&addr->addr[4]));
+}
 
-    if (findMember(addr) != nullptr) {
+void MP1Node::addNewMember(MemberListEntry *e) {
+    if (findMember(e->id, e->port) != nullptr) {
         return;
     }
 
-    if (*addr == memberNode->addr) {
-        delete addr;
-        return;
-    }
+    Address *addr = getAddr(*e);
 
-    if (par->getcurrtime() - e->timestamp < TREMOVE) {
+    if (!(*addr == memberNode->addr) && par->getcurrtime() - e->timestamp < TREMOVE) {
         log->logNodeAdd(&memberNode->addr, addr);
-        MemberListEntry *newMember = new MemberListEntry(e->id, e->port, e->heartbeat, par->getcurrtime());
-        memberNode->memberList.push_back(*newMember);
+        memberNode->memberList.push_back(MemberListEntry(e->id, e->port, e->heartbeat, par->getcurrtime()));
+        memberNode->memberListVersion++;
+        if (par->MEMBER_TABLE) {
+            memberNode->memberTable.add(e->id, memberNode->memberList.size() - 1, e->heartbeat, par->getcurrtime());
+        }
     }
+    delete addr;
 }
 
 void MP1Node::addNewMember(MessageHdr *m) {
@@ -333,8 +492,11 @@ void MP1Node::addNewMember(MessageHdr *m) {
 
     log->logNodeAdd(&memberNode->addr, &m->addr);
 
-    MemberListEntry *newMemeb = new MemberListEntry(id, port, 1, par->getcurrtime());
-    memberNode->memberList.push_back(*newMemeb);
+    memberNode->memberList.push_back(MemberListEntry(id, port, 1, par->getcurrtime()));
+    memberNode->memberListVersion++;
+    if (par->MEMBER_TABLE) {
+        memberNode->memberTable.add(id, memberNode->memberList.size() - 1, 1, par->getcurrtime());
+    }
 }
 
 
@@ -347,14 +509,19 @@ void MP1Node::addNewMember(MessageHdr *m) {
  * 				Propagate your membership list
  */
 void MP1Node::nodeLoopOps() {
+    TRACE_PHASE_SPAN("MP1Node::nodeLoopOps", &memberNode->addr);
     memberNode->heartbeat += 1;
 
     vector<MemberListEntry> deleteMembers;
 
     // check local members status
-    for(MemberListEntry clusterMemb: memberNode->memberList) {
-        if (par->getcurrtime() - clusterMemb.timestamp >= TREMOVE ) {
-            deleteMembers.push_back(clusterMemb);
+    if (par->MEMBER_TABLE) {
+        expireTableMembers();
+    } else {
+        for(MemberListEntry clusterMemb: memberNode->memberList) {
+            if (par->getcurrtime() - clusterMemb.timestamp >= TREMOVE ) {
+                deleteMembers.push_back(clusterMemb);
+            }
         }
     }
 
@@ -363,17 +530,75 @@ void MP1Node::nodeLoopOps() {
         log->logNodeRemove(&memberNode->addr, deleteAddr);
         int delPos = getMemberPosition(&delMember);
         memberNode->memberList.erase(memberNode->memberList.begin() + delPos);
+        memberNode->memberListVersion++;
+        delete deleteAddr;
     }
 
+    memberNode->metrics.set(MG_MEMBERS, memberNode->memberList.size());
+
     // send gossip ping
-    MessageHdr * message = createMessage(MsgTypes::PING);
+    int size;
+    MessageHdr * message = createMessage(MsgTypes::PING, &size);
+    int sent = 0;
+    memberNode->metrics.record(MH_GOSSIP_BYTES, size);
     for(MemberListEntry clusterMemb: memberNode->memberList) {
         Address *address = getAddr(clusterMemb);
-        std::cout << "send [" << par->getcurrtime() << "] PING [" << memberNode->addr.getAddress() << "] to " << address->getAddress() << std::endl;
-        emulNet->ENsend(&memberNode->addr, address, (char *) message, sizeof(MessageHdr));
+        // a message of the KV store carried gossip to it since the last ping
+        if (piggybacked(clusterMemb.id)) {
+            memberNode->metrics.add(MC_GOSSIP_PIGGYBACKED);
+            delete address;
+            continue;
+        }
+        // the next ping carries the whole list again, a congested member waits for it
+        if (emulNet->ENcongested(address)) {
+            memberNode->metrics.add(MC_GOSSIP_DEFERRED);
+            delete address;
+            continue;
+        }
+        LOG_DEBUG("send [%d] PING [%s] to %s\n", par->getcurrtime(), memberNode->addr.getAddress().c_str(), address->getAddress().c_str());
+        emulNet->ENsend(&memberNode->addr, address, (char *) message, size);
+        sent++;
         delete address;
     }
-    delete message;
+    memberNode->metrics.add(MC_GOSSIP_MESSAGES, sent);
+    memberNode->metrics.add(MC_GOSSIP_BYTES, (uint64_t)size * sent);
+    free(message);
+}
+
+/**
+ * FUNCTION NAME: expireTableMembers
+ *
+ * DESCRIPTION: Delete the members of the dense membership table that timed out,
+ * 				in the order of the membership list, then close the gaps in one pass
+ */
+void MP1Node::expireTableMembers() {
+    MemberTable *table = &memberNode->memberTable;
+    vector<MemberListEntry> &memberList = memberNode->memberList;
+    vector<int> ids;
+    int kept;
+
+    if (table->expired(par->getcurrtime(), TREMOVE, ids) == 0) {
+        return;
+    }
+    sort(ids.begin(), ids.end(), [table](int a, int b) { return table->positionOf(a) < table->positionOf(b); });
+    kept = table->positionOf(ids[0]);
+
+    for(int id: ids) {
+        Address *deleteAddr = getAddr(id, memberList[table->positionOf(id)].port);
+        log->logNodeRemove(&memberNode->addr, deleteAddr);
+        table->remove(id);
+        memberNode->memberListVersion++;
+        delete deleteAddr;
+    }
+
+    for(int i = kept; i < memberList.size(); i++) {
+        if (table->contains(memberList[i].id)) {
+            memberList[kept] = memberList[i];
+            table->moved(memberList[kept].id, kept);
+            kept++;
+        }
+    }
+    memberList.erase(memberList.begin() + kept, memberList.end());
 }
 
 Address* MP1Node::getAddr(MemberListEntry e) {
@@ -394,21 +619,126 @@ Address* MP1Node::getAddr(int id, short port) {
     return address;
 }
 
-MessageHdr* MP1Node::createMessage(MsgTypes t) {
-    MessageHdr *repMsg = new MessageHdr();
-    repMsg->countMembers = memberNode->memberList.size();
+/**
+ * FUNCTION NAME: createMessage
+ *
+ * DESCRIPTION: Build a message of type t carrying the membership list, as one flat
+ * 				buffer of *size bytes: the header followed by the entries.
+ * 				A list too long for one message is sent a window at a time,
+ * 				the window moving along with the heartbeat.
+ */
+MessageHdr* MP1Node::createMessage(MsgTypes t, int *size) {
+    int listSize = memberNode->memberList.size();
+    int count = min(listSize, maxGossipMembers());
+    int first = (count < listSize) ? memberNode->heartbeat % listSize : 0;
 
-    if (memberNode->memberList.size() > 0) {
-        repMsg->members = new MemberListEntry[memberNode->memberList.size()];
-        memcpy(repMsg->members, memberNode->memberList.data(), sizeof(MemberListEntry) * memberNode->memberList.size());
-    }
+    *size = sizeof(MessageHdr) + count * sizeof(MemberListEntry);
+    MessageHdr *repMsg = new (malloc(*size)) MessageHdr();
 
     repMsg->msgType = t;
-    memcpy(&repMsg->addr, &memberNode->addr, sizeof(Address));
+    repMsg->addr = memberNode->addr;
+    repMsg->countMembers = count;
+    repMsg->members = (MemberListEntry *) (repMsg + 1);
+
+    copyMembers(repMsg->members, first, count);
 
     return repMsg;
 }
 
+/**
+ * FUNCTION NAME: copyMembers
+ *
+ * DESCRIPTION: Copy count entries of the membership list from first on, wrapping around
+ */
+void MP1Node::copyMembers(MemberListEntry *to, int first, int count) {
+    int listSize = memberNode->memberList.size();
+
+    for (int i = 0; i < count; i++) {
+        new (&to[i]) MemberListEntry(memberNode->memberList[(first + i) % listSize]);
+        if (par->MEMBER_TABLE) {
+            to[i].heartbeat = memberNode->memberTable.heartbeatOf(to[i].id);
+            to[i].timestamp = memberNode->memberTable.timestampOf(to[i].id);
+        }
+    }
+}
+
+/**
+ * FUNCTION NAME: piggyback
+ *
+ * DESCRIPTION: Gossip to ride on a message of the KV store to a member: a PING of this node
+ * 				with the next PIGGYBACK_MEMBERS entries of the list, taken in turn, at most once
+ * 				a tick to a member. The member gets no PING of its own for the next
+ * 				PIGGYBACK_TICKS ticks.
+ *
+ * RETURNS:
+ * the PING, empty if it does not fit in room bytes, goes to this node or the node is not in the group,
+ * or if the member already got one this tick
+ */
+string MP1Node::piggyback(Address *to, int room) {
+    int listSize = memberNode->memberList.size();
+    int count = min(listSize, PIGGYBACK_MEMBERS);
+    int size = sizeof(MessageHdr) + count * sizeof(MemberListEntry);
+    int id = *(int *)(&to->addr);
+    MessageHdr msg = MessageHdr();
+
+    // a message to this node itself must not make it a member of its own list
+    if (!memberNode->inGroup || size > room || *to == memberNode->addr) {
+        return string();
+    }
+    // one batch a tick to a member is enough
+    if (id >= 0 && id < (int) piggybackSentAt.size() && piggybackSentAt[id] == par->getcurrtime()) {
+        return string();
+    }
+    string ping(size, 0);
+    msg.msgType = MsgTypes::PING;
+    msg.addr = memberNode->addr;
+    msg.countMembers = count;
+    memcpy(&ping[0], &msg, sizeof(MessageHdr));
+    if (count > 0) {
+        copyMembers((MemberListEntry *) &ping[sizeof(MessageHdr)], piggybackNext, count);
+        piggybackNext = (piggybackNext + count) % listSize;
+    }
+
+    if (id >= 0 && id < (int) piggybackSentAt.size()) {
+        piggybackSentAt[id] = par->getcurrtime();
+    }
+    memberNode->metrics.add(MC_PIGGYBACK_BYTES, size);
+    return ping;
+}
+
+/**
+ * FUNCTION NAME: receivePiggyback
+ *
+ * DESCRIPTION: Handle the gossip that rode on a message of the KV store as a PING
+ */
+void MP1Node::receivePiggyback(const char *data, int size) {
+    if (size < (int) sizeof(MessageHdr) || ((MessageHdr *) data)->msgType != MsgTypes::PING) {
+        return;
+    }
+    char *msg = (char *) malloc(size);
+    memcpy(msg, data, size);
+    recvCallBack((void *)memberNode, msg, size);
+}
+
+/**
+ * FUNCTION NAME: piggybacked
+ *
+ * DESCRIPTION: Whether gossip rode on a message to the node in the last PIGGYBACK_TICKS ticks
+ */
+bool MP1Node::piggybacked(int id) {
+    return id >= 0 && id < (int) piggybackSentAt.size() && piggybackSentAt[id] >= 0 &&
+        piggybackSentAt[id] >= par->getcurrtime() - PIGGYBACK_TICKS;
+}
+
+/**
+ * FUNCTION NAME: maxGossipMembers
+ *
+ * DESCRIPTION: Number of member entries that fit in a message the network accepts
+ */
+int MP1Node::maxGossipMembers() {
+    return (par->MAX_MSG_SIZE - (int) sizeof(en_msg) - (int) sizeof(MessageHdr) - 1) / (int) sizeof(MemberListEntry);
+}
+
 /**
  * FUNCTION NAME: isNullAddress
  *
@@ -421,13 +751,24 @@ int MP1Node::isNullAddress(Address *addr) {
 /**
  * FUNCTION NAME: getJoinAddress
  *
- * DESCRIPTION: Returns the Address of the coordinator
+ * DESCRIPTION: Returns the Address of the introducer to send the next JOINREQ to.
+ * 				The first introducer boots the group and every other introducer joins
+ * 				through it. The other nodes are spread over the introducers by id and move
+ * 				on to the next one on every retry.
  */
 Address MP1Node::getJoinAddress() {
     Address joinaddr;
+    vector<int> &introducers = par->INTRODUCERS;
+    int n = introducers.size();
+    int self = *(int *)(&memberNode->addr.addr);
+    int introducer = introducers[(self + joinAttempts) % n];
+
+    if (find(introducers.begin(), introducers.end(), self) != introducers.end()) {
+        introducer = introducers[0];
+    }
 
     memset(&joinaddr, 0, sizeof(Address));
-    *(int *)(&joinaddr.addr) = 1;
+    *(int *)(&joinaddr.addr) = introducer;
     *(short *)(&joinaddr.addr[4]) = 0;
 
     return joinaddr;
@@ -440,6 +781,36 @@ Address MP1Node::getJoinAddress() {
  */
 void MP1Node::initMemberListTable(Member *memberNode) {
 	memberNode->memberList.clear();
+	memberNode->memberTable.clear();
+	memberNode->memberListVersion++;
+}
+
+/**
+ * FUNCTION NAME: checkpoint
+ *
+ * DESCRIPTION: Write the state of the join to a checkpoint. The Member is written on its own.
+ */
+void MP1Node::checkpoint(Checkpoint *ck) {
+	ck->putLong(pendingJoins.size());
+	ck->put(pendingJoins.data(), pendingJoins.size() * sizeof(Address));
+	ck->putLong(joinAttempts);
+	ck->putLong(joinSentAt);
+	ck->put(piggybackSentAt.data(), piggybackSentAt.size() * sizeof(int));
+	ck->putLong(piggybackNext);
+}
+
+/**
+ * FUNCTION NAME: restore
+ *
+ * DESCRIPTION: Read back the state written by checkpoint
+ */
+void MP1Node::restore(Checkpoint *ck) {
+	pendingJoins.resize(ck->getCount(sizeof(Address)));
+	ck->get(pendingJoins.data(), pendingJoins.size() * sizeof(Address));
+	joinAttempts = (int)ck->getLong();
+	joinSentAt = (int)ck->getLong();
+	ck->get(piggybackSentAt.data(), piggybackSentAt.size() * sizeof(int));
+	piggybackNext = (int)ck->getLong();
 }
 
 /**
@@ -11,6 +11,17 @@
  */
 q_elt::q_elt(void *elt, int size): elt(elt), size(size) {}
 
+/**
+ * Destructor
+ */
+q_spare_nodes::~q_spare_nodes() {
+	for ( unsigned int i = 0; i < nodes.size(); i++ ) {
+		delete nodes[i];
+	}
+}
+
+thread_local q_spare_nodes MsgQueue::spareNodes;
+
 /**
  * Copy constructor
  */
@@ -154,8 +165,11 @@ Member::Member(const Member &anotherMember) {
 	this->pingCounter = anotherMember.pingCounter;
 	this->timeOutCounter = anotherMember.timeOutCounter;
 	this->memberList = anotherMember.memberList;
+	this->memberTable = anotherMember.memberTable;
+	this->memberListVersion = anotherMember.memberListVersion;
 	this->myPos = anotherMember.myPos;
 	this->mp1q = anotherMember.mp1q;
+	this->metrics = anotherMember.metrics;
 }
 
 /**
@@ -171,7 +185,10 @@ Member& Member::operator =(const Member& anotherMember) {
 	this->pingCounter = anotherMember.pingCounter;
 	this->timeOutCounter = anotherMember.timeOutCounter;
 	this->memberList = anotherMember.memberList;
+	this->memberTable = anotherMember.memberTable;
+	this->memberListVersion = anotherMember.memberListVersion;
 	this->myPos = anotherMember.myPos;
 	this->mp1q = anotherMember.mp1q;
+	this->metrics = anotherMember.metrics;
 	return *this;
 }
@@ -0,0 +1,144 @@
+/**********************************
+ * FILE NAME: MemberBench.cpp
+ *
+ * DESCRIPTION: Cost of the membership table operations of a ping: merging a gossiped view
+ * 				and the timeout scan, on the membership list and on the dense MemberTable
+ * 				with its scalar and AVX2 kernels.
+ **********************************/
+
+#include "stdincludes.h"
+#include "Member.h"
+#include "MemberTable.h"
+
+/**
+ * FUNCTION NAME: nowSec
+ *
+ * DESCRIPTION: Monotonic clock in seconds
+ */
+static double nowSec() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * FUNCTION NAME: findEntry
+ *
+ * DESCRIPTION: Linear search of the membership list, as MP1Node::findMember does
+ */
+static MemberListEntry *findEntry(vector<MemberListEntry> &memberList, int id, short port) {
+	for ( unsigned int i = 0; i < memberList.size(); i++ ) {
+		if ( memberList[i].id == id && memberList[i].port == port ) {
+			return &memberList[i];
+		}
+	}
+	return NULL;
+}
+
+/**
+ * FUNCTION NAME: benchTable
+ *
+ * DESCRIPTION: Nanoseconds per view merged and per timeout scan of a MemberTable of members ids
+ */
+static void benchTable(const char *name, int members, vector<MemberListEntry> &view, int rounds, int64_t timeout) {
+	MemberTable table;
+	vector<int> ids;
+	double start, merged, scanned;
+	long updated = 0, expired = 0;
+	int r;
+
+	for ( int i = 1; i <= members; i++ ) {
+		table.add(i, i - 1, 0, (i % 1000 == 0) ? 0 : rounds);
+	}
+	start = nowSec();
+	for ( r = 1; r <= rounds; r++ ) {
+		for ( unsigned int i = 0; i < view.size(); i++ ) {
+			table.stage(view[i].id, r);
+		}
+		updated += table.merge(r);
+	}
+	merged = nowSec();
+	for ( r = 1; r <= rounds; r++ ) {
+		ids.clear();
+		expired += table.expired(rounds + timeout - 1, timeout, ids);
+	}
+	scanned = nowSec();
+
+	printf("%-16s %10.0f %12.0f   (%ld updated, %ld expired)\n", name, (merged - start) / rounds * 1e9,
+			(scanned - merged) / rounds * 1e9, updated, expired);
+}
+
+/**********************************
+ * FUNCTION NAME: main
+ *
+ * DESCRIPTION: main function. Usage: ./MemberBench [members] [view size] [rounds]
+ * 				Every round gossips a view of consecutive members with newer heartbeats,
+ * 				then scans all members for the ones that timed out.
+ **********************************/
+int main(int argc, char *argv[]) {
+	int members = (argc > 1) ? atoi(argv[1]) : 10000;
+	int viewSize = (argc > 2) ? atoi(argv[2]) : 160;
+	int rounds = (argc > 3) ? atoi(argv[3]) : 1000;
+	int64_t timeout = 20;
+	vector<MemberListEntry> memberList;
+	vector<MemberListEntry> view;
+	vector<MemberListEntry> deleteMembers;
+	double start, merged, scanned;
+	long updated = 0, expired = 0;
+	bool avx2 = MemberTable::useAvx2;
+	int r;
+
+	if ( members <= 0 || viewSize <= 0 || viewSize > members || rounds <= 0 ) {
+		cout<<"Usage: ./MemberBench [members] [view size] [rounds]"<<endl;
+		return FAILURE;
+	}
+
+	// the view is the window of a gossip message, from the middle of the list,
+	// one member in a thousand has timed out at the scans
+	for ( int i = 1; i <= members; i++ ) {
+		memberList.push_back(MemberListEntry(i, 0, 0, (i % 1000 == 0) ? 0 : rounds));
+	}
+	for ( int i = 0; i < viewSize; i++ ) {
+		view.push_back(memberList[(members - viewSize) / 2 + i]);
+	}
+
+	printf("%d members, views of %d, %d rounds\n", members, viewSize, rounds);
+	printf("%-16s %10s %12s\n", "", "ns/merge", "ns/scan");
+
+	start = nowSec();
+	for ( r = 1; r <= rounds; r++ ) {
+		for ( unsigned int i = 0; i < view.size(); i++ ) {
+			MemberListEntry *e = findEntry(memberList, view[i].id, view[i].port);
+			if ( e != NULL && r > e->heartbeat ) {
+				e->heartbeat = r;
+				e->timestamp = r;
+				updated++;
+			}
+		}
+	}
+	merged = nowSec();
+	for ( r = 1; r <= rounds; r++ ) {
+		deleteMembers.clear();
+		for ( unsigned int i = 0; i < memberList.size(); i++ ) {
+			if ( rounds + timeout - 1 - memberList[i].timestamp >= timeout ) {
+				deleteMembers.push_back(memberList[i]);
+			}
+		}
+		expired += deleteMembers.size();
+	}
+	scanned = nowSec();
+	printf("%-16s %10.0f %12.0f   (%ld updated, %ld expired)\n", "list", (merged - start) / rounds * 1e9,
+			(scanned - merged) / rounds * 1e9, updated, expired);
+
+	MemberTable::useAvx2 = false;
+	benchTable("table scalar", members, view, rounds, timeout);
+	if ( avx2 ) {
+		MemberTable::useAvx2 = true;
+		benchTable("table avx2", members, view, rounds, timeout);
+	}
+	else {
+		printf("table avx2       not supported by this CPU\n");
+	}
+
+	return SUCCESS;
+}
@@ -0,0 +1,354 @@
+/**********************************
+ * FILE NAME: Metrics.cpp
+ *
+ * DESCRIPTION: Per node metrics definition
+ **********************************/
+
+#include "Metrics.h"
+
+static const char *counterName[MC_COUNTERS] = {
+	"gossip_messages", "gossip_bytes_sent", "gossip_deferred", "gossip_piggybacked",
+	"piggyback_bytes", "transactions", "transaction_timeouts", "ring_changes",
+	"stabilization_keys", "stabilization_deferred", "read_repairs", "join_requests", "join_bytes_sent", "join_cpu_ns"
+};
+static const char *gaugeName[MG_GAUGES] = {
+	"mp1q_depth", "mp2q_depth", "members"
+};
+static const char *histogramName[MH_HISTOGRAMS] = {
+	"quorum_ticks_create", "quorum_ticks_read", "quorum_ticks_update", "quorum_ticks_delete", "gossip_bytes"
+};
+
+/**
+ * Constructor
+ */
+Histogram::Histogram(): count(0), min(0), max(0), sum(0) {}
+
+/**
+ * FUNCTION NAME: bucketOf
+ *
+ * DESCRIPTION: Bucket of a value
+ */
+int Histogram::bucketOf(uint64_t value) {
+	int shift;
+	if ( value < HIST_SUB ) {
+		return (int)value;
+	}
+	shift = 63 - __builtin_clzll(value) - HIST_SUB_BITS;
+	return (shift + 1) * HIST_SUB + (int)(value >> shift) - HIST_SUB;
+}
+
+/**
+ * FUNCTION NAME: bucketLow
+ *
+ * DESCRIPTION: Smallest value of a bucket
+ */
+uint64_t Histogram::bucketLow(int bucket) {
+	if ( bucket < HIST_SUB ) {
+		return bucket;
+	}
+	return (uint64_t)(HIST_SUB + bucket % HIST_SUB) << (bucket / HIST_SUB - 1);
+}
+
+/**
+ * FUNCTION NAME: record
+ *
+ * DESCRIPTION: Count a value
+ */
+void Histogram::record(uint64_t value) {
+	unsigned int b = bucketOf(value);
+	if ( b >= buckets.size() ) {
+		buckets.resize(b + 1, 0);
+	}
+	buckets[b]++;
+	min = (count == 0 || value < min) ? value : min;
+	max = (count == 0 || value > max) ? value : max;
+	sum += value;
+	count++;
+}
+
+/**
+ * FUNCTION NAME: merge
+ *
+ * DESCRIPTION: Add the values of another histogram to this one
+ */
+void Histogram::merge(const Histogram &anotherHistogram) {
+	if ( anotherHistogram.count == 0 ) {
+		return;
+	}
+	if ( anotherHistogram.buckets.size() > buckets.size() ) {
+		buckets.resize(anotherHistogram.buckets.size(), 0);
+	}
+	for ( unsigned int b = 0; b < anotherHistogram.buckets.size(); b++ ) {
+		buckets[b] += anotherHistogram.buckets[b];
+	}
+	min = (count == 0 || anotherHistogram.min < min) ? anotherHistogram.min : min;
+	max = (count == 0 || anotherHistogram.max > max) ? anotherHistogram.max : max;
+	sum += anotherHistogram.sum;
+	count += anotherHistogram.count;
+}
+
+/**
+ * FUNCTION NAME: valueAt
+ *
+ * DESCRIPTION: Value below which percentile percent of the values fall,
+ * 				the largest value of its bucket
+ */
+uint64_t Histogram::valueAt(double percentile) {
+	uint64_t target = (uint64_t)ceil(percentile / 100 * count);
+	uint64_t seen = 0;
+
+	target = (target < 1) ? 1 : target;
+	for ( unsigned int b = 0; b < buckets.size(); b++ ) {
+		seen += buckets[b];
+		if ( seen >= target ) {
+			uint64_t high = bucketLow(b + 1) - 1;
+			return (high > max) ? max : ((high < min) ? min : high);
+		}
+	}
+	return max;
+}
+
+/**
+ * FUNCTION NAME: writeJson
+ *
+ * DESCRIPTION: Summary and non empty buckets of the histogram as a JSON object
+ */
+void Histogram::writeJson(FILE *fp) {
+	bool first = true;
+
+	fprintf(fp, "{\"count\": %llu", (unsigned long long)count);
+	if ( count > 0 ) {
+		fprintf(fp, ", \"min\": %llu, \"max\": %llu, \"mean\": %.3f, \"p50\": %llu, \"p90\": %llu, \"p99\": %llu, \"buckets\": [",
+				(unsigned long long)min, (unsigned long long)max, (double)sum / count,
+				(unsigned long long)valueAt(50), (unsigned long long)valueAt(90), (unsigned long long)valueAt(99));
+		for ( unsigned int b = 0; b < buckets.size(); b++ ) {
+			if ( buckets[b] != 0 ) {
+				fprintf(fp, "%s[%llu, %llu]", first ? "" : ", ", (unsigned long long)bucketLow(b), (unsigned long long)buckets[b]);
+				first = false;
+			}
+		}
+		fprintf(fp, "]");
+	}
+	fprintf(fp, "}");
+}
+
+/**
+ * FUNCTION NAME: checkpoint
+ *
+ * DESCRIPTION: Write the histogram to a checkpoint
+ */
+void Histogram::checkpoint(Checkpoint *ck) {
+	ck->put(&count, sizeof(count));
+	ck->put(&min, sizeof(min));
+	ck->put(&max, sizeof(max));
+	ck->put(&sum, sizeof(sum));
+	ck->putLong(buckets.size());
+	ck->put(buckets.data(), buckets.size() * sizeof(uint64_t));
+}
+
+/**
+ * FUNCTION NAME: restore
+ *
+ * DESCRIPTION: Read back the histogram written by checkpoint
+ */
+void Histogram::restore(Checkpoint *ck) {
+	ck->get(&count, sizeof(count));
+	ck->get(&min, sizeof(min));
+	ck->get(&max, sizeof(max));
+	ck->get(&sum, sizeof(sum));
+	buckets.resize(ck->getCount(sizeof(uint64_t)));
+	ck->get(buckets.data(), buckets.size() * sizeof(uint64_t));
+}
+
+/**
+ * Constructor
+ */
+Metrics::Metrics() {
+	memset(counters, 0, sizeof(counters));
+	memset(gauges, 0, sizeof(gauges));
+}
+
+/**
+ * FUNCTION NAME: merge
+ *
+ * DESCRIPTION: Add the metrics of another node to these.
+ * 				The last values of the gauges add up, the total of all nodes.
+ */
+void Metrics::merge(const Metrics &anotherMetrics) {
+	int i;
+	for ( i = 0; i < MC_COUNTERS; i++ ) {
+		counters[i] += anotherMetrics.counters[i];
+	}
+	for ( i = 0; i < MG_GAUGES; i++ ) {
+		const Gauge *g = &anotherMetrics.gauges[i];
+		if ( g->samples == 0 ) {
+			continue;
+		}
+		gauges[i].max = (gauges[i].samples == 0 || g->max > gauges[i].max) ? g->max : gauges[i].max;
+		gauges[i].last += g->last;
+		gauges[i].sum += g->sum;
+		gauges[i].samples += g->samples;
+	}
+	for ( i = 0; i < MH_HISTOGRAMS; i++ ) {
+		histograms[i].merge(anotherMetrics.histograms[i]);
+	}
+}
+
+/**
+ * FUNCTION NAME: writeJson
+ *
+ * DESCRIPTION: The metrics as the members of a JSON object, each line starting with indent
+ */
+void Metrics::writeJson(FILE *fp, const char *indent) {
+	int i;
+
+	fprintf(fp, "%s\"counters\": {", indent);
+	for ( i = 0; i < MC_COUNTERS; i++ ) {
+		fprintf(fp, "%s\"%s\": %llu", (i == 0) ? "" : ", ", counterName[i], (unsigned long long)counters[i]);
+	}
+	fprintf(fp, "},\n%s\"gauges\": {", indent);
+	for ( i = 0; i < MG_GAUGES; i++ ) {
+		Gauge *g = &gauges[i];
+		fprintf(fp, "%s\"%s\": {\"last\": %ld, \"max\": %ld, \"mean\": %.3f, \"samples\": %ld}", (i == 0) ? "" : ", ",
+				gaugeName[i], g->last, g->max, (g->samples > 0) ? (double)g->sum / g->samples : 0.0, g->samples);
+	}
+	fprintf(fp, "},\n%s\"histograms\": {", indent);
+	for ( i = 0; i < MH_HISTOGRAMS; i++ ) {
+		fprintf(fp, "%s\n%s  \"%s\": ", (i == 0) ? "" : ",", indent, histogramName[i]);
+		histograms[i].writeJson(fp);
+	}
+	fprintf(fp, "\n%s}", indent);
+}
+
+/**
+ * FUNCTION NAME: save
+ *
+ * DESCRIPTION: Write the metrics to a file load reads back, for a node process
+ *
+ * RETURNS:
+ * SUCCESS or FAILURE
+ */
+int Metrics::save(const char *fileName) {
+	FILE *fp = fopen(fileName, "w");
+	int i;
+
+	if ( fp == NULL ) {
+		return FAILURE;
+	}
+	for ( i = 0; i < MC_COUNTERS; i++ ) {
+		fprintf(fp, "c %d %llu\n", i, (unsigned long long)counters[i]);
+	}
+	for ( i = 0; i < MG_GAUGES; i++ ) {
+		fprintf(fp, "g %d %ld %ld %ld %ld\n", i, gauges[i].last, gauges[i].max, gauges[i].sum, gauges[i].samples);
+	}
+	for ( i = 0; i < MH_HISTOGRAMS; i++ ) {
+		Histogram *h = &histograms[i];
+		fprintf(fp, "h %d %llu %llu %llu %llu %zu", i, (unsigned long long)h->count, (unsigned long long)h->min,
+				(unsigned long long)h->max, (unsigned long long)h->sum, h->buckets.size());
+		for ( unsigned int b = 0; b < h->buckets.size(); b++ ) {
+			fprintf(fp, " %llu", (unsigned long long)h->buckets[b]);
+		}
+		fprintf(fp, "\n");
+	}
+	fclose(fp);
+	return SUCCESS;
+}
+
+/**
+ * FUNCTION NAME: load
+ *
+ * DESCRIPTION: Read back the metrics written by save
+ *
+ * RETURNS:
+ * SUCCESS or FAILURE
+ */
+int Metrics::load(const char *fileName) {
+	ifstream in(fileName);
+	string kind;
+	int i;
+
+	if ( !in ) {
+		return FAILURE;
+	}
+	while ( in >> kind >> i ) {
+		if ( kind == "c" && i >= 0 && i < MC_COUNTERS ) {
+			in >> counters[i];
+		}
+		else if ( kind == "g" && i >= 0 && i < MG_GAUGES ) {
+			in >> gauges[i].last >> gauges[i].max >> gauges[i].sum >> gauges[i].samples;
+		}
+		else if ( kind == "h" && i >= 0 && i < MH_HISTOGRAMS ) {
+			Histogram *h = &histograms[i];
+			size_t n = 0;
+			in >> h->count >> h->min >> h->max >> h->sum >> n;
+			h->buckets.resize(n);
+			for ( size_t b = 0; b < n; b++ ) {
+				in >> h->buckets[b];
+			}
+		}
+		else {
+			return FAILURE;
+		}
+	}
+	return SUCCESS;
+}
+
+/**
+ * FUNCTION NAME: checkpoint
+ *
+ * DESCRIPTION: Write the metrics to a checkpoint
+ */
+void Metrics::checkpoint(Checkpoint *ck) {
+	ck->put(counters, sizeof(counters));
+	ck->put(gauges, sizeof(gauges));
+	for ( int i = 0; i < MH_HISTOGRAMS; i++ ) {
+		histograms[i].checkpoint(ck);
+	}
+}
+
+/**
+ * FUNCTION NAME: restore
+ *
+ * DESCRIPTION: Read back the metrics written by checkpoint
+ */
+void Metrics::restore(Checkpoint *ck) {
+	ck->get(counters, sizeof(counters));
+	ck->get(gauges, sizeof(gauges));
+	for ( int i = 0; i < MH_HISTOGRAMS; i++ ) {
+		histograms[i].restore(ck);
+	}
+}
+
+/**
+ * FUNCTION NAME: writeRun
+ *
+ * DESCRIPTION: Write the metrics of the run to fileName as JSON:
+ * 				the total of all nodes, then every node on its own
+ *
+ * RETURNS:
+ * SUCCESS or FAILURE
+ */
+int Metrics::writeRun(const char *fileName, int time, vector<pair<int, Metrics *> > &nodes) {
+	FILE *fp = fopen(fileName, "w");
+	Metrics total;
+	unsigned int i;
+
+	if ( fp == NULL ) {
+		return FAILURE;
+	}
+	for ( i = 0; i < nodes.size(); i++ ) {
+		total.merge(*nodes[i].second);
+	}
+
+	fprintf(fp, "{\n  \"time\": %d,\n  \"nodes\": %zu,\n  \"total\": {\n", time, nodes.size());
+	total.writeJson(fp, "    ");
+	fprintf(fp, "\n  },\n  \"per_node\": [");
+	for ( i = 0; i < nodes.size(); i++ ) {
+		fprintf(fp, "%s\n    {\n      \"node\": %d,\n", (i == 0) ? "" : ",", nodes[i].first);
+		nodes[i].second->writeJson(fp, "      ");
+		fprintf(fp, "\n    }");
+	}
+	fprintf(fp, "\n  ]\n}\n");
+	fclose(fp);
+	return SUCCESS;
+}
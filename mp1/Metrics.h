@@ -0,0 +1,137 @@
+/**********************************
+ * FILE NAME: Metrics.h
+ *
+ * DESCRIPTION: Per node metrics header file
+ **********************************/
+
+#ifndef _METRICS_H_
+#define _METRICS_H_
+
+#include "stdincludes.h"
+#include "Checkpoint.h"
+
+/*
+ * Macros
+ */
+#define METRICS_JSON "metrics.json"
+#define METRICS_NODE_FILE "metrics.txt"
+// sub buckets per power of two of a histogram, values are kept within 1/16
+#define HIST_SUB_BITS 4
+#define HIST_SUB (1 << HIST_SUB_BITS)
+
+/**
+ * Counters, only ever go up
+ */
+enum MetricCounter {
+	MC_GOSSIP_MESSAGES,			// membership messages sent
+	MC_GOSSIP_BYTES,			// bytes of those
+	MC_GOSSIP_DEFERRED,			// pings held back from congested members
+	MC_GOSSIP_PIGGYBACKED,		// pings left out as gossip rode on a KV message to the member
+	MC_PIGGYBACK_BYTES,			// bytes of the gossip riding on KV messages
+	MC_TRANSACTIONS,			// KV transactions opened by the node as coordinator
+	MC_TRANSACTION_TIMEOUTS,	// of those, failed for lack of replies
+	MC_RING_CHANGES,			// ring changes that ran the stabilization protocol
+	MC_STABILIZATION_KEYS,		// keys sent by the stabilization protocol
+	MC_STABILIZATION_DEFERRED,	// of those, held back while their replica was congested
+	MC_READ_REPAIRS,			// newest values of reads sent to the replicas that answered older ones
+	MC_JOIN_REQUESTS,			// JOINREQs answered by the node as introducer
+	MC_JOIN_BYTES,				// bytes of the JOINREPs it sent
+	MC_JOIN_CPU_NS,				// thread CPU time it spent on the joins, in ns
+	MC_COUNTERS
+};
+
+/**
+ * Gauges, sampled
+ */
+enum MetricGauge {
+	MG_MP1Q_DEPTH,				// messages waiting in mp1q when they are handled
+	MG_MP2Q_DEPTH,				// messages waiting in mp2q when they are handled
+	MG_MEMBERS,					// entries of the membership table
+	MG_GAUGES
+};
+
+/**
+ * Histograms, the quorum latencies in the order of MessageType
+ */
+enum MetricHistogram {
+	MH_QUORUM_CREATE,			// ticks from opening a transaction to its quorum
+	MH_QUORUM_READ,
+	MH_QUORUM_UPDATE,
+	MH_QUORUM_DELETE,
+	MH_GOSSIP_BYTES,			// size of the membership messages
+	MH_HISTOGRAMS
+};
+
+/**
+ * STRUCT NAME: Gauge
+ *
+ * DESCRIPTION: Last, largest and mean of the samples of a value
+ */
+typedef struct Gauge {
+	long last;
+	long max;
+	long sum;
+	long samples;
+}Gauge;
+
+/**
+ * CLASS NAME: Histogram
+ *
+ * DESCRIPTION: HDR style histogram of non negative values.
+ * 				Values below HIST_SUB are counted exactly, above that every power of two
+ * 				is split into HIST_SUB buckets. The buckets grow with the largest value.
+ */
+class Histogram {
+private:
+	static int bucketOf(uint64_t value);
+	static uint64_t bucketLow(int bucket);
+public:
+	uint64_t count;
+	uint64_t min;
+	uint64_t max;
+	uint64_t sum;
+	vector<uint64_t> buckets;
+	Histogram();
+	void record(uint64_t value);
+	void merge(const Histogram &anotherHistogram);
+	uint64_t valueAt(double percentile);
+	void writeJson(FILE *fp);
+	void checkpoint(Checkpoint *ck);
+	void restore(Checkpoint *ck);
+};
+
+/**
+ * CLASS NAME: Metrics
+ *
+ * DESCRIPTION: The metrics of one node. Cheap enough to update in the message handlers,
+ * 				the Application merges the metrics of all nodes at the end of the run.
+ */
+class Metrics {
+public:
+	uint64_t counters[MC_COUNTERS];
+	Gauge gauges[MG_GAUGES];
+	Histogram histograms[MH_HISTOGRAMS];
+	Metrics();
+	void add(int counter, uint64_t n = 1) {
+		counters[counter] += n;
+	}
+	void set(int gauge, long value) {
+		Gauge *g = &gauges[gauge];
+		g->last = value;
+		g->max = (g->samples == 0 || value > g->max) ? value : g->max;
+		g->sum += value;
+		g->samples++;
+	}
+	void record(int histogram, uint64_t value) {
+		histograms[histogram].record(value);
+	}
+	void merge(const Metrics &anotherMetrics);
+	void writeJson(FILE *fp, const char *indent);
+	int save(const char *fileName);
+	int load(const char *fileName);
+	void checkpoint(Checkpoint *ck);
+	void restore(Checkpoint *ck);
+	static int writeRun(const char *fileName, int time, vector<pair<int, Metrics *> > &nodes);
+};
+
+#endif /* _METRICS_H_ */
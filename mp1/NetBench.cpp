@@ -0,0 +1,270 @@
+/**********************************
+ * FILE NAME: NetBench.cpp
+ *
+ * DESCRIPTION: Messages per second of the transports.
+ * 				In one process every node sends to every other node, round after round.
+ * 				Across processes one process per node sends to node 1, run by this process.
+ **********************************/
+
+#include "stdincludes.h"
+#include "Network.h"
+#include "EmulNet.h"
+#include "UdpNet.h"
+#include "ShmNet.h"
+
+/*
+ * Macros
+ */
+// ms without a message after which the receiver stops waiting for lost ones
+#define BENCH_QUIET_MS 500
+
+static const char *transportName[] = { "emul", "udp", "shm" };
+
+/**
+ * FUNCTION NAME: nowSec
+ *
+ * DESCRIPTION: Monotonic clock in seconds
+ */
+static double nowSec() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * FUNCTION NAME: countMsg
+ *
+ * DESCRIPTION: Enqueue callback of the transports, counts and frees the message
+ */
+static int countMsg(void *counter, char *buff, int size) {
+	(*(long *)counter)++;
+	free(buff);
+	return 0;
+}
+
+/**
+ * FUNCTION NAME: createNetwork
+ *
+ * DESCRIPTION: Network of the transport
+ */
+static Network *createNetwork(Params *par, int transport) {
+	if ( transport == UDP_TRANSPORT ) {
+		return new UdpNet(par, 0);
+	}
+	if ( transport == SHM_TRANSPORT ) {
+		return new ShmNet(par, 0);
+	}
+	return new EmulNet(par, 0);
+}
+
+// syscalls per message of the socket networks, printed after the table
+static string notes;
+
+/**
+ * FUNCTION NAME: report
+ *
+ * DESCRIPTION: Note the syscalls per message of a socket network
+ */
+static void report(const char *bench, Network *net) {
+	UdpNet *udp = dynamic_cast<UdpNet *>(net);
+	double send, recv;
+	char line[128];
+	if ( udp != NULL ) {
+		udp->syscallsPerMsg(&send, &recv);
+		sprintf(line, "udp %s: %.4f syscalls per message sent, %.4f per message received\n", bench, send, recv);
+		notes += line;
+	}
+}
+
+/**
+ * FUNCTION NAME: benchInProcess
+ *
+ * DESCRIPTION: All nodes in this process, each round every node sends one message
+ * 				to every other node and then every node drains its messages.
+ *
+ * RETURNS:
+ * messages received per second, lost is set to the number of messages sent but never received
+ */
+static double benchInProcess(Params *par, int transport, long total, char *payload, int size, long *lost) {
+	vector<Address> addr(par->EN_GPSZ + 1);
+	long received = 0;
+	long sent = 0;
+	int i, j;
+	double start, elapsed;
+
+	par->nodeProcess = 0;
+	Network *net = createNetwork(par, transport);
+	for ( i = 1; i <= par->EN_GPSZ; i++ ) {
+		net->ENinit(&addr[i], par->PORTNUM);
+	}
+
+	start = nowSec();
+	while ( sent < total ) {
+		for ( i = 1; i <= par->EN_GPSZ; i++ ) {
+			for ( j = 1; j <= par->EN_GPSZ; j++ ) {
+				if ( i != j && net->ENsend(&addr[i], &addr[j], payload, size) > 0 ) {
+					sent++;
+				}
+			}
+		}
+		net->ENflush();
+		for ( i = 1; i <= par->EN_GPSZ; i++ ) {
+			net->ENrecv(&addr[i], countMsg, NULL, 1, &received);
+		}
+	}
+	elapsed = nowSec() - start;
+
+	*lost = sent - received;
+	report("in-process", net);
+	delete net;
+	return received / elapsed;
+}
+
+/**
+ * FUNCTION NAME: benchProcesses
+ *
+ * DESCRIPTION: Nodes 2 to EN_GPSZ are forked processes sending to node 1, run by this process.
+ * 				A sender retries when the transport refuses a message.
+ *
+ * RETURNS:
+ * messages received per second, lost is set to the number of messages sent but never received
+ */
+static double benchProcesses(Params *par, int transport, long total, char *payload, int size, long *lost) {
+	vector<Address> addr(par->EN_GPSZ + 1);
+	int running = 0;
+	long received = 0;
+	long perSender = total / (par->EN_GPSZ - 1);
+	long expected = perSender * (par->EN_GPSZ - 1);
+	long sent;
+	int i, j;
+	pid_t pid;
+	double start, last;
+	// the shared memory segment has to exist before the fork to be shared
+	Network *shared = NULL;
+	Network *net;
+
+	if ( transport == SHM_TRANSPORT ) {
+		shared = createNetwork(par, transport);
+	}
+
+	// node 1 is bound before any sender starts, the shared ids are handed out in every process
+	par->nodeProcess = 1;
+	net = (shared != NULL) ? shared : createNetwork(par, transport);
+	for ( i = 1; i <= par->EN_GPSZ && shared == NULL; i++ ) {
+		net->ENinit(&addr[i], par->PORTNUM);
+	}
+
+	start = nowSec();
+	for ( i = 2; i <= par->EN_GPSZ; i++ ) {
+		pid = fork();
+		if ( pid < 0 ) {
+			perror("fork");
+			exit(1);
+		}
+		if ( pid == 0 ) {
+			vector<Address> myaddrs(par->EN_GPSZ + 1);
+			Network *mine = (shared != NULL) ? shared : createNetwork(par, transport);
+			par->nodeProcess = i;
+			for ( j = 1; j <= par->EN_GPSZ; j++ ) {
+				mine->ENinit(&myaddrs[j], par->PORTNUM);
+			}
+			for ( sent = 0; sent < perSender; ) {
+				if ( mine->ENsend(&myaddrs[i], &myaddrs[1], payload, size) > 0 ) {
+					sent++;
+				}
+				else {
+					sched_yield();
+				}
+				// as many messages as a node sends in a tick
+				if ( sent % par->EN_GPSZ == 0 || sent == perSender ) {
+					mine->ENflush();
+				}
+			}
+			_exit(0);
+		}
+		running++;
+	}
+	for ( i = 1; i <= par->EN_GPSZ && shared != NULL; i++ ) {
+		net->ENinit(&addr[i], par->PORTNUM);
+	}
+
+	// lost messages are given up on once the senders are done and nothing came for a while
+	last = nowSec();
+	while ( received < expected && (running > 0 || (nowSec() - last) * 1000 < BENCH_QUIET_MS) ) {
+		long before = received;
+		net->ENwait(BENCH_QUIET_MS);
+		net->ENrecv(&addr[1], countMsg, NULL, 1, &received);
+		if ( received != before ) {
+			last = nowSec();
+		}
+		while ( running > 0 && waitpid(-1, NULL, WNOHANG) > 0 ) {
+			running--;
+		}
+	}
+
+	for ( ; running > 0; running-- ) {
+		waitpid(-1, NULL, 0);
+	}
+
+	*lost = expected - received;
+	report("processes, receiver", net);
+	delete net;
+	return received / (last - start);
+}
+
+/**********************************
+ * FUNCTION NAME: main
+ *
+ * DESCRIPTION: main function. Usage: ./NetBench [nodes] [messages] [payload bytes]
+ **********************************/
+int main(int argc, char *argv[]) {
+	Params *par = new Params();
+	long total = (argc > 2) ? atol(argv[2]) : 200000;
+	int size = (argc > 3) ? atoi(argv[3]) : 64;
+	char *payload;
+	double rate;
+	long lost;
+	int t;
+
+	par->EN_GPSZ = (argc > 1) ? atoi(argv[1]) : 10;
+	par->MAX_MSG_SIZE = 4000;
+	par->BUFFER_SIZE = ENBUFFSIZE;
+	par->linkModel = 0;
+	par->dropmsg = 0;
+	par->MSG_DROP_PROB = 0;
+	par->globaltime = 0;
+	par->SEED = 1;
+	par->UDP_PORT = 20000;
+	par->TICK_MS = 0;
+	par->epochMs = 0;
+
+	if ( par->EN_GPSZ < 2 || total <= 0 || size <= 0 || size + (int)sizeof(en_msg) >= par->MAX_MSG_SIZE ) {
+		cout<<"Usage: ./NetBench [nodes] [messages] [payload bytes]"<<endl;
+		return FAILURE;
+	}
+
+	payload = (char *) malloc(size);
+	memset(payload, 'x', size);
+
+	printf("%d nodes, %ld messages of %d bytes\n", par->EN_GPSZ, total, size);
+	printf("%-6s %28s %28s\n", "", "in-process msgs/sec (lost)", "processes msgs/sec (lost)");
+	for ( t = EMUL_TRANSPORT; t <= SHM_TRANSPORT; t++ ) {
+		par->TRANSPORT = t;
+		rate = benchInProcess(par, t, total, payload, size, &lost);
+		printf("%-6s %16.0f %11s", transportName[t], rate, ("(" + to_string(lost) + ")").c_str());
+		if ( t == EMUL_TRANSPORT ) {
+			// the emulated network only exists inside one process
+			printf(" %28s\n", "-");
+			continue;
+		}
+		fflush(stdout);
+		rate = benchProcesses(par, t, total, payload, size, &lost);
+		printf(" %16.0f %11s\n", rate, ("(" + to_string(lost) + ")").c_str());
+	}
+
+	printf("%s", notes.c_str());
+
+	free(payload);
+	delete par;
+	return SUCCESS;
+}
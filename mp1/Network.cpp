@@ -0,0 +1,136 @@
+/**********************************
+ * FILE NAME: Network.cpp
+ *
+ * DESCRIPTION: Transport interface definition
+ **********************************/
+
+#include "Network.h"
+
+/**
+ * FUNCTION NAME: ENsend
+ *
+ * DESCRIPTION: Send the bytes of a string
+ *
+ * RETURNS:
+ * size
+ */
+int Network::ENsend(Address *myaddr, Address *toaddr, string data) {
+	char * str = (char *) malloc(data.length() * sizeof(char));
+	memcpy(str, data.c_str(), data.size());
+	int ret = this->ENsend(myaddr, toaddr, str, (data.length() * sizeof(char)));
+	free(str);
+	return ret;
+}
+
+/**
+ * FUNCTION NAME: writeMsgCount
+ *
+ * DESCRIPTION: Write the messages sent and received by every node per tick to msgcount.log.
+ * 				A node process writes the counts of its node to its own file.
+ */
+void Network::writeMsgCount(Params *par, MsgCounts *counts) {
+	int i, j;
+	int sent_total, recv_total;
+	char name[64];
+
+	if ( par->nodeProcess != 0 ) {
+		sprintf(name, "node%d.msgcount.log", par->nodeProcess);
+	}
+	else {
+		strcpy(name, "msgcount.log");
+	}
+	FILE* file = fopen(name, "w+");
+
+	for ( i = 1; i <= par->EN_GPSZ; i++ ) {
+		if ( par->nodeProcess != 0 && par->nodeProcess != i ) {
+			continue;
+		}
+		fprintf(file, "node %3d ", i);
+		sent_total = 0;
+		recv_total = 0;
+
+		for (j = 0; j < par->getcurrtime(); j++) {
+
+			sent_total += counts->getSent(i, j);
+			recv_total += counts->getRecv(i, j);
+			fprintf(file, " (%4d, %4d)", counts->getSent(i, j), counts->getRecv(i, j));
+			if (j % 10 == 9) {
+				fprintf(file, "\n         ");
+			}
+		}
+		fprintf(file, "\n");
+		fprintf(file, "node %3d sent_total %6u  recv_total %6u  dropped_total %6ld  overflow_total %6ld\n\n", i, sent_total, recv_total,
+				counts->getDrops(i, RANDOM_DROP), counts->getDrops(i, OVERFLOW_DROP));
+	}
+
+	fclose(file);
+}
+
+/**
+ * FUNCTION NAME: ENwait
+ *
+ * DESCRIPTION: Wait up to timeout milliseconds for messages to arrive and post
+ * 				a receive event for every node that has some.
+ * 				Transports that post their events when sending only sleep.
+ *
+ * RETURNS:
+ * number of nodes posted
+ */
+int Network::ENwait(int timeout) {
+	if ( timeout > 0 ) {
+		usleep(timeout * 1000);
+	}
+	return 0;
+}
+
+/**
+ * FUNCTION NAME: ENflush
+ *
+ * DESCRIPTION: Send the messages held back during the tick.
+ * 				Transports that send at once have nothing to do.
+ *
+ * RETURNS:
+ * number of messages sent
+ */
+int Network::ENflush() {
+	return 0;
+}
+
+/**
+ * FUNCTION NAME: ENcongested
+ *
+ * DESCRIPTION: Whether the inbox of a node is filling up, so that a sender should hold back
+ * 				what can wait. Transports that cannot tell never report it.
+ *
+ * RETURNS:
+ * true if the node is congested
+ */
+bool Network::ENcongested(Address *toaddr) {
+	return false;
+}
+
+/**
+ * FUNCTION NAME: checkpoint
+ *
+ * DESCRIPTION: Write the messages on their way and the state of the network to a checkpoint.
+ * 				Only a network that lives in the process can do it, the kernel holds the
+ * 				messages of the others.
+ *
+ * RETURNS:
+ * SUCCESS or FAILURE
+ */
+int Network::checkpoint(Checkpoint *ck) {
+	return FAILURE;
+}
+
+/**
+ * FUNCTION NAME: restore
+ *
+ * DESCRIPTION: Read back the network written by checkpoint
+ *
+ * RETURNS:
+ * SUCCESS or FAILURE
+ */
+int Network::restore(Checkpoint *ck) {
+	return FAILURE;
+}
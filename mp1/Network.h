@@ -0,0 +1,174 @@
+/**********************************
+ * FILE NAME: Network.h
+ *
+ * DESCRIPTION: Transport interface header file
+ **********************************/
+
+#ifndef _NETWORK_H_
+#define _NETWORK_H_
+
+// random streams of a network per node, the networks of a process do not share streams
+#define NET_NODE_STREAMS (1 << 20)
+// share of an inbox in use from which its node is congested and senders hold back
+#define CONGESTION_LEVEL 0.75
+
+#include "stdincludes.h"
+#include "Params.h"
+#include "Member.h"
+#include "Scheduler.h"
+#include "Checkpoint.h"
+
+using namespace std;
+
+/**
+ * Struct Name: en_msg
+ *
+ * DESCRIPTION: Header in front of every message a transport carries
+ */
+typedef struct en_msg {
+	// Number of bytes after the class
+	int size;
+	// Source node
+	Address from;
+	// Destination node
+	Address to;
+	// Channel of a network that carries several protocols, 0 on the others
+	int channel;
+}en_msg;
+
+// why a message was lost: the random drop of the test case or a full inbox
+enum DropKind { RANDOM_DROP, OVERFLOW_DROP, DROP_KINDS };
+
+/**
+ * CLASS NAME: MsgCounts
+ *
+ * DESCRIPTION: Messages sent and received by every node in every tick, for msgcount.log.
+ * 				A row of counts per tick, added as the run reaches the tick. Over the run
+ * 				the messages of a node are also counted by channel, and the ones it sent
+ * 				that were lost by kind of drop.
+ */
+class MsgCounts {
+private:
+	int nodes;
+	int channels;
+	vector<int> sent;
+	vector<int> recv;
+	// by node and channel
+	vector<long> channelSent;
+	vector<long> channelRecv;
+	vector<long> drops[DROP_KINDS];
+	static int &at(vector<int> &counts, int nodes, int node, int time) {
+		size_t i = (size_t)time * (nodes + 1) + node;
+		if ( i >= counts.size() ) {
+			counts.resize((size_t)(time + 1) * (nodes + 1), 0);
+		}
+		return counts[i];
+	}
+	// count of a node on a channel, or on all of them for channel -1
+	long total(vector<long> &counts, int node, int channel) {
+		long sum = 0;
+		for ( int c = 0; c < channels; c++ ) {
+			if ( channel == -1 || channel == c ) {
+				sum += counts[node * channels + c];
+			}
+		}
+		return sum;
+	}
+public:
+	MsgCounts(): nodes(0), channels(1) {}
+	void init(int nodes, int channels = 1) {
+		this->nodes = nodes;
+		this->channels = channels;
+		sent.clear();
+		recv.clear();
+		channelSent.assign((nodes + 1) * channels, 0);
+		channelRecv.assign((nodes + 1) * channels, 0);
+		for ( int k = 0; k < DROP_KINDS; k++ ) {
+			drops[k].assign((nodes + 1) * channels, 0);
+		}
+	}
+	void countSent(int node, int time, int channel = 0) {
+		at(sent, nodes, node, time)++;
+		channelSent[node * channels + channel]++;
+	}
+	void countRecv(int node, int time, int channel = 0) {
+		at(recv, nodes, node, time)++;
+		channelRecv[node * channels + channel]++;
+	}
+	void countDrop(int node, DropKind kind, int channel = 0) {
+		drops[kind][node * channels + channel]++;
+	}
+	int getSent(int node, int time) {
+		size_t i = (size_t)time * (nodes + 1) + node;
+		return (i < sent.size()) ? sent[i] : 0;
+	}
+	int getRecv(int node, int time) {
+		size_t i = (size_t)time * (nodes + 1) + node;
+		return (i < recv.size()) ? recv[i] : 0;
+	}
+	long getChannelSent(int node, int channel) {
+		return total(channelSent, node, channel);
+	}
+	long getChannelRecv(int node, int channel) {
+		return total(channelRecv, node, channel);
+	}
+	long getDrops(int node, DropKind kind, int channel = -1) {
+		return total(drops[kind], node, channel);
+	}
+	int getChannels() {
+		return channels;
+	}
+	void checkpoint(Checkpoint *ck) {
+		ck->putLong(nodes);
+		ck->putLong(channels);
+		ck->putLong(sent.size());
+		ck->put(sent.data(), sent.size() * sizeof(int));
+		ck->putLong(recv.size());
+		ck->put(recv.data(), recv.size() * sizeof(int));
+		ck->put(channelSent.data(), channelSent.size() * sizeof(long));
+		ck->put(channelRecv.data(), channelRecv.size() * sizeof(long));
+		for ( int k = 0; k < DROP_KINDS; k++ ) {
+			ck->put(drops[k].data(), drops[k].size() * sizeof(long));
+		}
+	}
+	void restore(Checkpoint *ck) {
+		int n = (int)ck->getLong();
+		init(n, (int)ck->getLong());
+		sent.resize(ck->getCount(sizeof(int)));
+		ck->get(sent.data(), sent.size() * sizeof(int));
+		recv.resize(ck->getCount(sizeof(int)));
+		ck->get(recv.data(), recv.size() * sizeof(int));
+		ck->get(channelSent.data(), channelSent.size() * sizeof(long));
+		ck->get(channelRecv.data(), channelRecv.size() * sizeof(long));
+		for ( int k = 0; k < DROP_KINDS; k++ ) {
+			ck->get(drops[k].data(), drops[k].size() * sizeof(long));
+		}
+	}
+};
+
+/**
+ * CLASS NAME: Network
+ *
+ * DESCRIPTION: Interface of the transports the nodes send their messages through.
+ * 				EmulNet is the in-process emulated network, UdpNet uses real sockets
+ * 				and ShmNet shared memory rings.
+ */
+class Network {
+public:
+	virtual void *ENinit(Address *myaddr, short port) = 0;
+	virtual int ENsend(Address *myaddr, Address *toaddr, string data);
+	virtual int ENsend(Address *myaddr, Address *toaddr, char *data, int size) = 0;
+	virtual int ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue) = 0;
+	virtual int ENwait(int timeout);
+	virtual int ENflush();
+	virtual bool ENcongested(Address *toaddr);
+	virtual int ENcleanup() = 0;
+	virtual void setScheduler(Scheduler *sched, EventType recvEvent) = 0;
+	virtual int checkpoint(Checkpoint *ck);
+	virtual int restore(Checkpoint *ck);
+	virtual ~Network() {}
+protected:
+	static void writeMsgCount(Params *par, MsgCounts *counts);
+};
+
+#endif /* _NETWORK_H_ */
@@ -10,8 +10,30 @@
 #include "stdincludes.h"
 #include "Params.h"
 #include "Member.h"
+#include "Trace.h"
+
+/*
+ * Macros
+ */
+// messages the emulated network holds at once, unless the test case sets BUFFER_SIZE
+#define ENBUFFSIZE 30000
+// ticks between two nodes starting, unless the test case sets STEP_RATE
+#define DEFAULT_STEP_RATE 0.25
 
 enum testTYPE { CREATE_TEST, READ_TEST, UPDATE_TEST, DELETE_TEST };
+enum transportTYPE { EMUL_TRANSPORT, UDP_TRANSPORT, SHM_TRANSPORT };
+enum delayTYPE { FIXED_DELAY, UNIFORM_DELAY, LOGNORMAL_DELAY };
+
+/**
+ * STRUCT NAME: LinkDelay
+ *
+ * DESCRIPTION: Distribution of the delay of a link, in ticks
+ */
+typedef struct LinkDelay {
+	int type;
+	double a;					// fixed delay, lowest delay or median
+	double b;					// highest delay or sigma of the log
+}LinkDelay;
 
 /**
  * CLASS NAME: Params
@@ -26,14 +48,41 @@ public:
 	double STEP_RATE;		    // dictates the rate of insertion
 	int EN_GPSZ;			    // actual number of peers
 	int MAX_MSG_SIZE;
+	int BUFFER_SIZE;			// messages the emulated network holds at once
+	int INBOX_SIZE;				// messages it holds for one node, 0 for no limit but BUFFER_SIZE
+	int MEMBER_TABLE;			// keep the membership in the dense id indexed table
+	vector<int> INTRODUCERS;	// nodes the joining nodes are spread over, the first boots the group
 	int DROP_MSG;
 	int dropmsg;
 	int globaltime;
-	int allNodesJoined;
+	long allNodesJoined;
 	short PORTNUM;
+	uint64_t SEED;				// seed of all random number streams
+	int TRANSPORT;				// network the nodes talk through
+	int NODE_PROCS;				// one process per node
+	int UDP_PORT;				// first loopback port of the udp transport
+	int TICK_MS;				// wall clock length of a tick, 0 to simulate time
+	int EVENT_TRACE;			// also write the binary event trace of the run
+	int SPAN_TRACE;				// record the trace spans compiled in and write them out at the end
+	LinkDelay LINK_DELAY;		// delay of every link of the emulated network
+	int NODE_BANDWIDTH;			// egress bytes per tick of every node, 0 for no cap
+	map<pair<int, int>, LinkDelay> linkDelays;	// links with a delay of their own, by (from, to)
+	map<int, int> nodeBandwidths;	// nodes with a cap of their own
+	int linkModel;				// whether any delay or cap is set
+	int nodeProcess;			// id of the only node run by this process, 0 if it runs them all
+	long epochMs;				// monotonic clock reading at tick 0 when TICK_MS is set
 	Params();
 	void setparams(char *);
+	int settransport(char *);
+	int setintroducers(const char *);
+	int checkintroducers();
+	int setlinkdelay(LinkDelay *, char *);
+	LinkDelay *getlinkdelay(int from, int to);
+	int getbandwidth(int node);
 	int getcurrtime();
+	void startwallclock(long delayMs);
+	long getwallclockms();
+	int getwallclocktime();
 };
 
 #endif /* _PARAMS_H_ */
@@ -0,0 +1,179 @@
+/**********************************
+ * FILE NAME: QueueBench.cpp
+ *
+ * DESCRIPTION: Messages per second through a node inbox with several threads delivering
+ * 				at once and the node thread draining it, the lock-free MsgQueue against a
+ * 				std::queue behind a mutex.
+ **********************************/
+
+#include <thread>
+#include <mutex>
+#include "stdincludes.h"
+#include "Member.h"
+
+/**
+ * FUNCTION NAME: nowSec
+ *
+ * DESCRIPTION: Monotonic clock in seconds
+ */
+static double nowSec() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * CLASS NAME: LockedQueue
+ *
+ * DESCRIPTION: std::queue of entries behind a mutex, with the bound of the MsgQueue
+ */
+class LockedQueue {
+private:
+	queue<q_elt> entries;
+	mutex lock;
+	size_t capacity;
+public:
+	LockedQueue(size_t capacity): capacity(capacity) {}
+	bool push(const q_elt &element) {
+		lock_guard<mutex> guard(lock);
+		if ( entries.size() >= capacity ) {
+			return false;
+		}
+		entries.push(element);
+		return true;
+	}
+	// takes all entries queued, as the node thread drains its inbox
+	long drain(long *sum) {
+		lock_guard<mutex> guard(lock);
+		long n = entries.size();
+		while ( !entries.empty() ) {
+			*sum += entries.front().size;
+			entries.pop();
+		}
+		return n;
+	}
+};
+
+/**
+ * FUNCTION NAME: drain
+ *
+ * DESCRIPTION: Take all entries the producers linked in so far
+ */
+static long drain(MsgQueue &inbox, long *sum) {
+	long n = 0;
+	while ( !inbox.empty() ) {
+		*sum += inbox.front().size;
+		inbox.pop();
+		n++;
+	}
+	return n;
+}
+
+/**
+ * FUNCTION NAME: drain
+ *
+ * DESCRIPTION: Take all entries of the locked queue
+ */
+static long drain(LockedQueue &inbox, long *sum) {
+	return inbox.drain(sum);
+}
+
+/**
+ * FUNCTION NAME: run
+ *
+ * DESCRIPTION: Seconds for producer threads to push count entries each while this thread
+ * 				drains them, a producer finding the queue full yields and tries again
+ */
+template <typename Q> static double run(Q &inbox, int producers, long count, long *full) {
+	vector<thread> threads;
+	atomic<long> fullCount(0);
+	long received = 0, sum = 0;
+	double start = nowSec();
+
+	for ( int p = 0; p < producers; p++ ) {
+		threads.push_back(thread([&inbox, &fullCount, count]() {
+			for ( long i = 0; i < count; i++ ) {
+				while ( !inbox.push(q_elt(NULL, 1)) ) {
+					fullCount++;
+					this_thread::yield();
+				}
+			}
+		}));
+	}
+	while ( received < producers * count ) {
+		long n = drain(inbox, &sum);
+		if ( n == 0 ) {
+			this_thread::yield();
+		}
+		received += n;
+	}
+	for ( unsigned int p = 0; p < threads.size(); p++ ) {
+		threads[p].join();
+	}
+	assert(sum == producers * count);
+	*full = fullCount.load();
+	return nowSec() - start;
+}
+
+/**
+ * FUNCTION NAME: runAlone
+ *
+ * DESCRIPTION: Seconds for this thread to push count entries and drain them a full inbox
+ * 				at a time, as the simulation delivers the messages of a node and handles them
+ */
+template <typename Q> static double runAlone(Q &inbox, long count, long capacity) {
+	long received = 0, sum = 0;
+	double start = nowSec();
+
+	while ( received < count ) {
+		for ( long i = 0; i < min(capacity, count - received); i++ ) {
+			inbox.push(q_elt(NULL, 1));
+		}
+		received += drain(inbox, &sum);
+	}
+	assert(sum == count);
+	return nowSec() - start;
+}
+
+/**********************************
+ * FUNCTION NAME: main
+ *
+ * DESCRIPTION: main function. Usage: ./QueueBench [messages per producer] [capacity]
+ * 				This thread delivers to and drains an inbox alone, then one to eight producer
+ * 				threads deliver to one inbox drained by this thread.
+ **********************************/
+int main(int argc, char *argv[]) {
+	long count = (argc > 1) ? atol(argv[1]) : 1000000;
+	long capacity = (argc > 2) ? atol(argv[2]) : 4096;
+	static const int producerCounts[] = { 1, 2, 4, 8 };
+	double lockFree, locked;
+	long lockFreeFull, lockedFull;
+
+	if ( count <= 0 || capacity <= 0 ) {
+		cout<<"Usage: ./QueueBench [messages per producer] [capacity]"<<endl;
+		return FAILURE;
+	}
+
+	printf("%ld messages per producer, inboxes of %ld, %u cores\n", count, capacity, thread::hardware_concurrency());
+	printf("%-10s %14s %14s %12s %12s\n", "producers", "lock-free M/s", "mutex M/s", "lf full", "mutex full");
+	{
+		MsgQueue lockFreeInbox(capacity);
+		LockedQueue lockedInbox(capacity);
+
+		lockFree = runAlone(lockFreeInbox, count, capacity);
+		locked = runAlone(lockedInbox, count, capacity);
+		printf("%-10s %14.2f %14.2f\n", "none", count / lockFree / 1e6, count / locked / 1e6);
+	}
+	for ( unsigned int i = 0; i < sizeof(producerCounts) / sizeof(producerCounts[0]); i++ ) {
+		int producers = producerCounts[i];
+		MsgQueue lockFreeInbox(capacity);
+		LockedQueue lockedInbox(capacity);
+
+		lockFree = run(lockFreeInbox, producers, count, &lockFreeFull);
+		locked = run(lockedInbox, producers, count, &lockedFull);
+		printf("%-10d %14.2f %14.2f %12ld %12ld\n", producers, producers * count / lockFree / 1e6,
+				producers * count / locked / 1e6, lockFreeFull, lockedFull);
+	}
+
+	return SUCCESS;
+}
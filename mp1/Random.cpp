@@ -0,0 +1,90 @@
+/**********************************
+ * FILE NAME: Random.cpp
+ *
+ * DESCRIPTION: Definition of the seedable random number streams
+ **********************************/
+
+#include "Random.h"
+
+/**
+ * FUNCTION NAME: splitmix64
+ *
+ * DESCRIPTION: Advance x and return the next splitmix64 output
+ */
+static uint64_t splitmix64(uint64_t &x) {
+	uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+static inline uint64_t rotl(uint64_t x, int k) {
+	return (x << k) | (x >> (64 - k));
+}
+
+/**
+ * Constructor
+ */
+Random::Random() {
+	seed(0, 0, 0);
+}
+
+/**
+ * Constructor
+ */
+Random::Random(uint64_t seed, int subsystem, int stream) {
+	this->seed(seed, subsystem, stream);
+}
+
+/**
+ * FUNCTION NAME: seed
+ *
+ * DESCRIPTION: (Re)start the stream of the subsystem for the given run seed
+ */
+void Random::seed(uint64_t seed, int subsystem, int stream) {
+	uint64_t x = seed;
+	// mix the stream coordinates in before expanding the state
+	x = splitmix64(x) ^ (uint64_t)(uint32_t)subsystem;
+	x = splitmix64(x) ^ (uint64_t)(uint32_t)stream;
+	for ( int i = 0; i < 4; i++ ) {
+		s[i] = splitmix64(x);
+	}
+}
+
+/**
+ * FUNCTION NAME: next
+ *
+ * DESCRIPTION: Returns the next 64 random bits
+ */
+uint64_t Random::next() {
+	uint64_t result = rotl(s[1] * 5, 7) * 9;
+	uint64_t t = s[1] << 17;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = rotl(s[3], 45);
+
+	return result;
+}
+
+/**
+ * FUNCTION NAME: nextInt
+ *
+ * DESCRIPTION: Returns a uniform integer in [0, bound)
+ */
+uint32_t Random::nextInt(uint32_t bound) {
+	// multiply-shift, the bias is at most bound / 2^32
+	return (uint32_t)(((next() >> 32) * (uint64_t)bound) >> 32);
+}
+
+/**
+ * FUNCTION NAME: nextDouble
+ *
+ * DESCRIPTION: Returns a uniform double in [0, 1)
+ */
+double Random::nextDouble() {
+	return (next() >> 11) * (1.0 / 9007199254740992.0);
+}
@@ -0,0 +1,128 @@
+/**********************************
+ * FILE NAME: Scheduler.cpp
+ *
+ * DESCRIPTION: Discrete event scheduler definition
+ **********************************/
+
+#include "Scheduler.h"
+
+/**
+ * Constructor
+ */
+Scheduler::Scheduler(): nextSeq(0) {}
+
+/**
+ * Destructor
+ */
+Scheduler::~Scheduler() {}
+
+/**
+ * FUNCTION NAME: schedule
+ *
+ * DESCRIPTION: Queue an event for the node at the given time
+ */
+void Scheduler::schedule(int time, int node, EventType type) {
+	Event e;
+	e.time = time;
+	e.node = node;
+	e.type = type;
+	e.seq = nextSeq++;
+	timed.push(e);
+}
+
+/**
+ * FUNCTION NAME: post
+ *
+ * DESCRIPTION: Mark an event of the node as ready right away.
+ * 				It is picked up by the next phase draining this event type,
+ * 				which may still be the current tick.
+ */
+void Scheduler::post(int node, EventType type) {
+	ready[type].insert(node);
+}
+
+/**
+ * FUNCTION NAME: advance
+ *
+ * DESCRIPTION: Move all the timed events due at or before time into the ready sets
+ */
+void Scheduler::advance(int time) {
+	while ( !timed.empty() && timed.top().time <= time ) {
+		ready[timed.top().type].insert(timed.top().node);
+		timed.pop();
+	}
+}
+
+/**
+ * FUNCTION NAME: nextTime
+ *
+ * DESCRIPTION: Returns the next tick after now that has work to do
+ *
+ * RETURNS:
+ * INT_MAX if nothing is left
+ */
+int Scheduler::nextTime(int now) {
+	for ( int type = 0; type < EV_COUNT; type++ ) {
+		if ( !ready[type].empty() ) {
+			return now + 1;
+		}
+	}
+	if ( timed.empty() ) {
+		return INT_MAX;
+	}
+	return max(now + 1, timed.top().time);
+}
+
+/**
+ * FUNCTION NAME: readySet
+ *
+ * DESCRIPTION: Nodes with a ready event of the given type, in ascending node order.
+ * 				Callers erase the nodes they have handled.
+ */
+set<int> &Scheduler::readySet(EventType type) {
+	return ready[type];
+}
+
+/**
+ * FUNCTION NAME: checkpoint
+ *
+ * DESCRIPTION: Write the timed events, in the order they come out, and the ready sets
+ */
+void Scheduler::checkpoint(Checkpoint *ck) {
+	priority_queue<Event, vector<Event>, greater<Event> > pending(timed);
+
+	ck->putLong(nextSeq);
+	ck->putLong(pending.size());
+	for ( ; !pending.empty(); pending.pop() ) {
+		ck->put(&pending.top(), sizeof(Event));
+	}
+	for ( int type = 0; type < EV_COUNT; type++ ) {
+		ck->putLong(ready[type].size());
+		for ( set<int>::iterator it = ready[type].begin(); it != ready[type].end(); ++it ) {
+			ck->putLong(*it);
+		}
+	}
+}
+
+/**
+ * FUNCTION NAME: restore
+ *
+ * DESCRIPTION: Read back the events written by checkpoint, replacing the ones queued
+ */
+void Scheduler::restore(Checkpoint *ck) {
+	Event e;
+	size_t n;
+
+	timed = priority_queue<Event, vector<Event>, greater<Event> >();
+	nextSeq = ck->getLong();
+	for ( n = ck->getCount(sizeof(Event)); n > 0; n-- ) {
+		ck->get(&e, sizeof(Event));
+		timed.push(e);
+	}
+	for ( int type = 0; type < EV_COUNT; type++ ) {
+		ready[type].clear();
+		for ( n = ck->getCount(sizeof(long)); n > 0; n-- ) {
+			ready[type].insert((int)ck->getLong());
+		}
+	}
+}
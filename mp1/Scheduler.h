@@ -0,0 +1,67 @@
+/**********************************
+ * FILE NAME: Scheduler.h
+ *
+ * DESCRIPTION: Discrete event scheduler header file
+ **********************************/
+
+#ifndef _SCHEDULER_H_
+#define _SCHEDULER_H_
+
+#include "stdincludes.h"
+#include "Checkpoint.h"
+
+/**
+ * Event Types
+ */
+enum EventType {
+	EV_START,		// node is introduced into the system
+	EV_MP1_RECV,	// membership messages are waiting for the node in the network
+	EV_MP1_TICK,	// membership protocol timer of the node
+	EV_APP,			// application layer event (failures), node is ignored
+	EV_COUNT
+};
+
+/**
+ * STRUCT NAME: Event
+ *
+ * DESCRIPTION: Timed event in the scheduler queue
+ */
+typedef struct Event {
+	int time;
+	int node;
+	EventType type;
+	long seq;
+	bool operator > (const Event &another) const {
+		if ( time != another.time ) {
+			return time > another.time;
+		}
+		return seq > another.seq;
+	}
+}Event;
+
+/**
+ * CLASS NAME: Scheduler
+ *
+ * DESCRIPTION: Priority queue of (time, node, event) driving the simulation.
+ * 				Timed events move into a per type ready set once their time has come.
+ * 				The application drains the ready sets in its per tick phases, so a node
+ * 				without ready events is not visited at all and ticks without any event are skipped.
+ */
+class Scheduler {
+private:
+	priority_queue<Event, vector<Event>, greater<Event> > timed;
+	set<int> ready[EV_COUNT];
+	long nextSeq;
+public:
+	Scheduler();
+	void schedule(int time, int node, EventType type);
+	void post(int node, EventType type);
+	void advance(int time);
+	int nextTime(int now);
+	set<int> &readySet(EventType type);
+	void checkpoint(Checkpoint *ck);
+	void restore(Checkpoint *ck);
+	virtual ~Scheduler();
+};
+
+#endif /* _SCHEDULER_H_ */
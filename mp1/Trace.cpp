@@ -0,0 +1,137 @@
+//////////////////////////////////////////////////////////////////////////////
+//****************************************************************************
+//
+//    FILE NAME: Trace.cpp
+//
+//    DECSRIPTION: This is the source file for trace functionality
+//
+//    CHANGE ACTIVITY:
+//    Date        Who      Description
+//    ==========  =======  ===============
+//
+//****************************************************************************
+//////////////////////////////////////////////////////////////////////////////
+
+/*
+ * Header files
+ */
+#include "Trace.h"
+
+mutex Trace::lock;
+vector<SpanRing *> Trace::rings;
+thread_local SpanRing *Trace::ring = NULL;
+uint64_t Trace::tscStart = 0;
+long Trace::nsStart = 0;
+bool Trace::enabled = false;
+
+/*****************************************************************
+ * NAME: monotonicNs
+ *
+ * DESCRIPTION: Monotonic clock in nanoseconds
+ *
+ ****************************************************************/
+static long monotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+/*****************************************************************
+ * NAME: start
+ *
+ * DESCRIPTION: Start recording spans. The TSC is read against the
+ *              monotonic clock here and again in dump to convert it.
+ *
+ ****************************************************************/
+void Trace::start() {
+
+    tscStart = now();
+    nsStart = monotonicNs();
+    enabled = true;
+}
+
+/*****************************************************************
+ * NAME: newRing
+ *
+ * DESCRIPTION: Function gives the calling thread a ring of its own
+ *
+ * RETURN:
+ * (SpanRing *) ring of the thread
+ *
+ ****************************************************************/
+SpanRing *Trace::newRing() {
+
+    lock_guard<mutex> guard(lock);
+
+    ring = new SpanRing;
+    ring->count = 0;
+    rings.push_back(ring);
+
+    return ring;
+}
+
+/*****************************************************************
+ * NAME: dump
+ *
+ * DESCRIPTION: Function stops recording and writes the spans of all
+ *              threads as Chrome trace events (chrome://tracing, Perfetto).
+ *              Every node is a thread of the process in the viewer,
+ *              the application is thread 0.
+ *
+ * PARAMETERS:
+ *            (const char *) fileName - file to write
+ *
+ * RETURN:
+ * (int) SUCCESS
+ *       FAILURE otherwise
+ *
+ ****************************************************************/
+int Trace::dump(const char *fileName) {
+
+    int rc = SUCCESS;        // Return code
+    set<int> nodes;
+    FILE *fp;
+    double tscPerUs;
+    long ns;
+    bool first = true;
+    int pid = getpid();
+
+    if ( !enabled ) {
+        return rc;
+    }
+    enabled = false;
+
+    ns = monotonicNs() - nsStart;
+    tscPerUs = (ns > 0) ? (double)(now() - tscStart) * 1000 / ns : 1;
+
+    fp = fopen(fileName, "w");
+    if ( NULL == fp )
+    {
+        printf("\nUnable to open %s in write mode\n", fileName);
+        return FAILURE;
+    }
+
+    lock_guard<mutex> guard(lock);
+
+    fprintf(fp, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    for ( unsigned int r = 0; r < rings.size(); r++ ) {
+        SpanRing *sr = rings[r];
+        uint64_t from = (sr->count > TRACE_RING_SPANS) ? sr->count - TRACE_RING_SPANS : 0;
+        for ( uint64_t i = from; i < sr->count; i++ ) {
+            SpanRecord *s = &sr->spans[i & (TRACE_RING_SPANS - 1)];
+            fprintf(fp, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    first ? "" : ",", s->name, pid, s->node, (s->start - tscStart) / tscPerUs, (s->end - s->start) / tscPerUs);
+            first = false;
+            nodes.insert(s->node);
+        }
+    }
+    for ( set<int>::iterator it = nodes.begin(); it != nodes.end(); it++ ) {
+        fprintf(fp, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                first ? "" : ",", pid, *it, (*it == 0) ? "application" : ("node " + to_string(*it)).c_str());
+        first = false;
+    }
+    fprintf(fp, "\n]}\n");
+    fclose(fp);
+
+    return rc;
+}
@@ -0,0 +1,166 @@
+/**********************************
+ * FILE NAME: TraceAnalysis.cpp
+ *
+ * DESCRIPTION: Reading and membership analysis of the binary event trace
+ **********************************/
+
+#include "TraceAnalysis.h"
+
+/**
+ * FUNCTION NAME: readFile
+ *
+ * DESCRIPTION: Read a whole file into a string
+ *
+ * RETURNS:
+ * false if the file cannot be read
+ */
+static bool readFile(const char *name, string *out) {
+	ifstream in(name, ios::in | ios::binary);
+	if ( !in ) {
+		return false;
+	}
+	out->assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+	return true;
+}
+
+/**
+ * FUNCTION NAME: loadTrace
+ *
+ * DESCRIPTION: Read trace.bin and the trace.str next to it
+ *
+ * RETURNS:
+ * false if the files are missing or not a trace
+ */
+bool loadTrace(const char *binName, TraceFile *tf) {
+	string bin, strName = binName;
+	size_t n;
+
+	if ( strName.size() < 4 || strName.compare(strName.size() - 4, 4, ".bin") != 0 ) {
+		fprintf(stderr, "%s: not a .bin trace file\n", binName);
+		return false;
+	}
+	strName.replace(strName.size() - 4, 4, ".str");
+
+	if ( !readFile(binName, &bin) || !readFile(strName.c_str(), &tf->strings) ) {
+		fprintf(stderr, "%s: cannot read the trace\n", binName);
+		return false;
+	}
+	if ( bin.size() < sizeof(TraceHeader) ) {
+		fprintf(stderr, "%s: truncated header\n", binName);
+		return false;
+	}
+	memcpy(&tf->header, bin.data(), sizeof(TraceHeader));
+	if ( strncmp(tf->header.magic, TRACE_MAGIC, sizeof(tf->header.magic)) != 0 || tf->header.version != TRACE_VERSION || tf->header.recordSize != sizeof(TraceRecord) ) {
+		fprintf(stderr, "%s: not a version %d trace\n", binName, TRACE_VERSION);
+		return false;
+	}
+
+	// a trace cut short keeps the records counted in the header
+	n = min((size_t)tf->header.records, (bin.size() - sizeof(TraceHeader)) / sizeof(TraceRecord));
+	tf->records.resize(n);
+	memcpy(tf->records.data(), bin.data() + sizeof(TraceHeader), n * sizeof(TraceRecord));
+	return true;
+}
+
+/**
+ * FUNCTION NAME: nodeKey
+ *
+ * DESCRIPTION: One number for the address of a node
+ */
+int64_t nodeKey(int32_t id, int16_t port) {
+	return ((int64_t)(uint16_t)port << 32) | (uint32_t)id;
+}
+
+/**
+ * FUNCTION NAME: summarizeMembership
+ *
+ * DESCRIPTION: Join completeness, and how many of the failed nodes every live node removed,
+ * 				how soon and how many nodes it removed that had not failed
+ */
+void summarizeMembership(vector<TraceFile> &traces, MembershipSummary *summary) {
+	// first time every node added each peer
+	map<int64_t, map<int64_t, int> > joined;
+	// time each node failed
+	map<int64_t, int> failed;
+	// first time each node removed each peer
+	map<int64_t, map<int64_t, int> > removed;
+	set<int64_t> nodes;
+	int lastJoin = -1;
+	size_t f, i;
+
+	summary->nodes = 0;
+	summary->joined = 0;
+	summary->expected = 0;
+	summary->found = 0;
+	summary->falseRemovals = 0;
+	summary->detect.samples.clear();
+
+	for ( f = 0; f < traces.size(); f++ ) {
+		summary->nodes = max(summary->nodes, (int)traces[f].header.nodes);
+		for ( i = 0; i < traces[f].records.size(); i++ ) {
+			TraceRecord *rec = &traces[f].records[i];
+			int64_t node = nodeKey(rec->node, rec->nodePort);
+			int64_t peer = nodeKey(rec->peer, rec->peerPort);
+			switch ( rec->type ) {
+				case TR_NODE_FAIL:
+					if ( failed.count(node) == 0 ) {
+						failed[node] = rec->time;
+					}
+					break;
+				case TR_NODE_ADD:
+					nodes.insert(node);
+					nodes.insert(peer);
+					if ( joined[node].count(peer) == 0 ) {
+						joined[node][peer] = rec->time;
+					}
+					break;
+				case TR_NODE_REMOVE:
+					if ( removed[node].count(peer) == 0 ) {
+						removed[node][peer] = rec->time;
+					}
+					break;
+				default:
+					break;
+			}
+		}
+	}
+
+	// a node has joined everyone once it added all the other nodes
+	for ( map<int64_t, map<int64_t, int> >::iterator it = joined.begin(); it != joined.end(); it++ ) {
+		int peers = 0;
+		int last = -1;
+		for ( map<int64_t, int>::iterator p = it->second.begin(); p != it->second.end(); p++ ) {
+			if ( p->first != it->first ) {
+				peers++;
+				last = max(last, p->second);
+			}
+		}
+		if ( peers >= summary->nodes - 1 ) {
+			summary->joined++;
+			lastJoin = max(lastJoin, last);
+		}
+	}
+	summary->lastJoin = (summary->joined == summary->nodes && summary->nodes > 0) ? lastJoin : -1;
+
+	// every live node should remove every failed node, and no one else
+	for ( map<int64_t, int>::iterator fl = failed.begin(); fl != failed.end(); fl++ ) {
+		for ( set<int64_t>::iterator n = nodes.begin(); n != nodes.end(); n++ ) {
+			if ( failed.count(*n) != 0 ) {
+				continue;
+			}
+			summary->expected++;
+			if ( removed[*n].count(fl->first) != 0 && removed[*n][fl->first] >= fl->second ) {
+				summary->found++;
+				summary->detect.samples.push_back(removed[*n][fl->first] - fl->second);
+			}
+		}
+	}
+	for ( map<int64_t, map<int64_t, int> >::iterator it = removed.begin(); it != removed.end(); it++ ) {
+		for ( map<int64_t, int>::iterator p = it->second.begin(); p != it->second.end(); p++ ) {
+			if ( failed.count(p->first) == 0 || p->second < failed[p->first] ) {
+				summary->falseRemovals++;
+			}
+		}
+	}
+	summary->failed = failed.size();
+}
@@ -0,0 +1,259 @@
+/**********************************
+ * FILE NAME: TraceTool.cpp
+ *
+ * DESCRIPTION: Offline reader of the binary event trace.
+ * 				analyze: join and removal completeness, quorum outcomes and latencies of a run.
+ * 				dbg, stats: render dbg.log or stats.log text from the trace.
+ * 				The trace files of the node processes are merged in the order given.
+ **********************************/
+
+#include "stdincludes.h"
+#include "TraceAnalysis.h"
+
+static const char *opName[] = { "create", "read", "update", "delete" };
+
+/**
+ * FUNCTION NAME: formatAddress
+ *
+ * DESCRIPTION: Address text as the Log class prints it
+ */
+static string formatAddress(int32_t id, int16_t port) {
+	char buf[32];
+	char addr[6];
+	memcpy(addr, &id, sizeof(id));
+	memcpy(addr + 4, &port, sizeof(port));
+	sprintf(buf, "%d.%d.%d.%d:%d", addr[0], addr[1], addr[2], addr[3], port);
+	return buf;
+}
+
+/**
+ * FUNCTION NAME: recordStrings
+ *
+ * DESCRIPTION: Key, value and text of a record, empty for those it does not have
+ */
+static void recordStrings(TraceFile *tf, TraceRecord *rec, string *key, string *value, string *text) {
+	const char *p = tf->strings.c_str() + rec->str;
+	key->clear();
+	value->clear();
+	text->clear();
+	if ( rec->str == 0 || rec->str >= tf->strings.size() ) {
+		return;
+	}
+	if ( rec->flags & TRF_KEY ) {
+		*key = p;
+		p += key->size() + 1;
+	}
+	if ( rec->flags & TRF_VALUE ) {
+		*value = p;
+		p += value->size() + 1;
+	}
+	if ( rec->flags & TRF_TEXT ) {
+		*text = p;
+	}
+}
+
+/**
+ * FUNCTION NAME: renderText
+ *
+ * DESCRIPTION: The text of the record as logged, without address and time
+ */
+static string renderText(TraceFile *tf, TraceRecord *rec) {
+	string key, value, text;
+	char buf[256];
+	int op;
+
+	recordStrings(tf, rec, &key, &value, &text);
+	switch ( rec->type ) {
+		case TR_NODE_ADD:
+			sprintf(buf, "Node %s joined at time %d", formatAddress(rec->peer, rec->peerPort).c_str(), rec->time);
+			return buf;
+		case TR_NODE_REMOVE:
+			sprintf(buf, "Node %s removed at time %d", formatAddress(rec->peer, rec->peerPort).c_str(), rec->time);
+			return buf;
+		case TR_CREATE:
+		case TR_READ:
+		case TR_UPDATE:
+		case TR_DELETE:
+			op = rec->type - TR_CREATE;
+			text = (rec->flags & TRF_COORDINATOR) ? "coordinator" : "server";
+			text += string(": ") + opName[op] + ((rec->flags & TRF_SUCCESS) ? " success" : " fail");
+			sprintf(buf, " at time %d, transID=%d, key=", rec->time, rec->transID);
+			text += buf + key;
+			if ( rec->flags & TRF_VALUE ) {
+				text += ", value=" + value;
+			}
+			return text;
+		default:
+			return text;
+	}
+}
+
+/**
+ * FUNCTION NAME: render
+ *
+ * DESCRIPTION: Print dbg.log or stats.log as the Log class writes it.
+ * 				Several traces are merged by time as the node process logs are.
+ */
+static void render(vector<TraceFile> &traces, bool stats) {
+	vector<pair<TraceFile *, TraceRecord *> > lines;
+	bool header = false;
+	size_t f, i;
+
+	for ( f = 0; f < traces.size(); f++ ) {
+		for ( i = 0; i < traces[f].records.size(); i++ ) {
+			TraceRecord *rec = &traces[f].records[i];
+			if ( rec->type == TR_MAGIC ) {
+				// the merged log of the node processes has one magic number at the top
+				if ( !stats && (traces.size() == 1 || !header) ) {
+					if ( traces.size() == 1 ) {
+						lines.push_back(make_pair(&traces[f], rec));
+					}
+					else {
+						printf("%x\n", rec->transID);
+					}
+				}
+				header = true;
+			}
+			else if ( !(rec->flags & TRF_REQUEST) && (rec->type == TR_STATS) == stats ) {
+				lines.push_back(make_pair(&traces[f], rec));
+			}
+		}
+	}
+	if ( traces.size() > 1 ) {
+		stable_sort(lines.begin(), lines.end(), [](const pair<TraceFile *, TraceRecord *> &a, const pair<TraceFile *, TraceRecord *> &b) { return a.second->time < b.second->time; });
+	}
+
+	for ( i = 0; i < lines.size(); i++ ) {
+		TraceRecord *rec = lines[i].second;
+		if ( rec->type == TR_MAGIC ) {
+			printf("%x\n", rec->transID);
+			continue;
+		}
+		printf("\n %s[%d] %s", (rec->flags & TRF_NOADDR) ? "" : (formatAddress(rec->node, rec->nodePort) + " ").c_str(), rec->time, renderText(lines[i].first, rec).c_str());
+	}
+}
+
+/**
+ * FUNCTION NAME: printLatencies
+ *
+ * DESCRIPTION: Percentiles of the samples
+ */
+static void printLatencies(const char *what, Latencies *l) {
+	vector<int> &s = l->samples;
+	if ( s.empty() ) {
+		printf("  %-22s no samples\n", what);
+		return;
+	}
+	sort(s.begin(), s.end());
+	printf("  %-22s n=%-7zu p50=%-5d p90=%-5d p99=%-5d max=%d\n", what, s.size(), s[s.size() / 2], s[s.size() * 9 / 10], s[s.size() * 99 / 100], s.back());
+}
+
+/**
+ * FUNCTION NAME: analyze
+ *
+ * DESCRIPTION: Membership and KV store summary of a run
+ */
+static void analyze(vector<TraceFile> &traces) {
+	MembershipSummary membership;
+	// transactions opened by each coordinator and when
+	map<pair<int64_t, int>, pair<int, int> > requests;
+	set<pair<int64_t, int> > answered;
+	set<uint32_t> keys;
+	long outcomes[4][2][2];
+	long kvRecords = 0;
+	Latencies quorum[4];
+	size_t f, i;
+
+	memset(outcomes, 0, sizeof(outcomes));
+	summarizeMembership(traces, &membership);
+
+	for ( f = 0; f < traces.size(); f++ ) {
+		for ( i = 0; i < traces[f].records.size(); i++ ) {
+			TraceRecord *rec = &traces[f].records[i];
+			int64_t node = nodeKey(rec->node, rec->nodePort);
+			switch ( rec->type ) {
+				case TR_CREATE:
+				case TR_READ:
+				case TR_UPDATE:
+				case TR_DELETE:
+					keys.insert(rec->keyHash);
+					if ( rec->flags & TRF_REQUEST ) {
+						requests[make_pair(node, rec->transID)] = make_pair(rec->type - TR_CREATE, rec->time);
+						break;
+					}
+					kvRecords++;
+					outcomes[rec->type - TR_CREATE][(rec->flags & TRF_COORDINATOR) ? 1 : 0][(rec->flags & TRF_SUCCESS) ? 1 : 0]++;
+					if ( (rec->flags & TRF_COORDINATOR) && requests.count(make_pair(node, rec->transID)) != 0 && answered.insert(make_pair(node, rec->transID)).second ) {
+						pair<int, int> req = requests[make_pair(node, rec->transID)];
+						quorum[req.first].samples.push_back(rec->time - req.second);
+					}
+					break;
+				default:
+					break;
+			}
+		}
+	}
+
+	printf("%zu trace file(s), %d nodes\n", traces.size(), membership.nodes);
+
+	printf("\nmembership\n");
+	printf("  join completeness      %d/%d nodes added all %d peers", membership.joined, membership.nodes, membership.nodes - 1);
+	if ( membership.lastJoin >= 0 ) {
+		printf(", by time %d", membership.lastJoin);
+	}
+	printf("\n");
+	printf("  failed nodes           %d\n", membership.failed);
+	printf("  remove completeness    %ld/%ld live node removals of failed nodes\n", membership.found, membership.expected);
+	printf("  false removals         %ld\n", membership.falseRemovals);
+	printLatencies("detection (ticks)", &membership.detect);
+
+	if ( kvRecords == 0 && requests.empty() ) {
+		return;
+	}
+	printf("\nkv store, %zu keys\n", keys.size());
+	printf("  %-8s %21s %21s %9s\n", "", "coordinator ok/fail", "server ok/fail", "pending");
+	for ( int op = 0; op < 4; op++ ) {
+		long pending = 0;
+		for ( map<pair<int64_t, int>, pair<int, int> >::iterator r = requests.begin(); r != requests.end(); r++ ) {
+			if ( r->second.first == op && answered.count(r->first) == 0 ) {
+				pending++;
+			}
+		}
+		printf("  %-8s %10ld/%-10ld %10ld/%-10ld %9ld\n", opName[op], outcomes[op][1][1], outcomes[op][1][0], outcomes[op][0][1], outcomes[op][0][0], pending);
+	}
+	printf("\nquorum latency, request to coordinator outcome\n");
+	for ( int op = 0; op < 4; op++ ) {
+		string what = string(opName[op]) + " (ticks)";
+		printLatencies(what.c_str(), &quorum[op]);
+	}
+}
+
+/**********************************
+ * FUNCTION NAME: main
+ *
+ * DESCRIPTION: main function. Usage: ./TraceTool analyze|dbg|stats <trace.bin>...
+ **********************************/
+int main(int argc, char *argv[]) {
+	vector<TraceFile> traces;
+	int i;
+
+	if ( argc < 3 || (strcmp(argv[1], "analyze") != 0 && strcmp(argv[1], "dbg") != 0 && strcmp(argv[1], "stats") != 0) ) {
+		cout<<"Usage: ./TraceTool analyze|dbg|stats <trace.bin>..."<<endl;
+		return FAILURE;
+	}
+
+	traces.resize(argc - 2);
+	for ( i = 2; i < argc; i++ ) {
+		if ( !loadTrace(argv[i], &traces[i - 2]) ) {
+			return FAILURE;
+		}
+	}
+
+	if ( strcmp(argv[1], "analyze") == 0 ) {
+		analyze(traces);
+	}
+	else {
+		render(traces, strcmp(argv[1], "stats") == 0);
+	}
+	return SUCCESS;
+}
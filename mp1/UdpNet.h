@@ -0,0 +1,103 @@
+/**********************************
+ * FILE NAME: UdpNet.h
+ *
+ * DESCRIPTION: UDP loopback network classes header file
+ **********************************/
+
+#ifndef _UDPNET_H_
+#define _UDPNET_H_
+
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include "stdincludes.h"
+#include "Network.h"
+#include "Params.h"
+#include "Member.h"
+#include "Scheduler.h"
+#include "Random.h"
+
+/*
+ * Macros
+ */
+// kernel receive buffer of every node socket
+#define UDP_RCVBUF (1 << 20)
+// readiness events handled per epoll_wait
+#define UDP_MAX_EVENTS 64
+// largest datagram, the messages of a tick to the same node are packed into as few as possible
+#define UDP_DGRAM_SIZE 16384
+// datagrams per sendmmsg and recvmmsg
+#define UDP_BATCH 64
+// messages in a datagram are aligned to this
+#define UDP_ALIGN 8
+
+/**
+ * STRUCT NAME: UdpDatagram
+ *
+ * DESCRIPTION: Datagram waiting for the end of the tick, a run of en_msg headers each followed by its message
+ */
+typedef struct UdpDatagram {
+	int src;
+	int dst;
+	int size;
+	char data[UDP_DGRAM_SIZE];
+}UdpDatagram;
+
+/**
+ * CLASS NAME: UdpNet
+ *
+ * DESCRIPTION: Network of non-blocking UDP sockets on 127.0.0.1.
+ * 				Node id:port is bound to UDP_PORT + netId * (EN_GPSZ + 1) + id,
+ * 				so every node can run in its own process.
+ * 				Messages are queued until ENflush, which sends the datagrams of every
+ * 				node with sendmmsg. ENrecv drains a socket with recvmmsg.
+ */
+class UdpNet : public Network
+{
+private:
+	Params* par;
+	int netId;
+	int nextid;
+	// socket of every node run by this process, -1 for the others
+	vector<int> sock;
+	int epfd;
+	MsgCounts counts;
+	// UDP_BATCH receive buffers of UDP_DGRAM_SIZE bytes
+	char *buff;
+	// datagrams of the tick, the first npending are in use
+	vector<UdpDatagram *> pending;
+	int npending;
+	// index in pending of the datagram being filled for src * (EN_GPSZ + 1) + dst
+	map<long, int> open;
+	// send and receive syscalls, and the messages they carried
+	long sendCalls;
+	long recvCalls;
+	long msgsSent;
+	long msgsRecv;
+	// Scheduler notified of messages waiting for a node
+	Scheduler *sched;
+	EventType recvEvent;
+	// Random streams for message drops, indexed by the sending node
+	vector<Random> rng;
+	void peerAddr(int id, struct sockaddr_in *sa);
+	UdpDatagram *datagramFor(int src, int dst, int len);
+	void unpack(Address *myaddr, char *dgram, int len, int (* enq)(void *, char *, int), void *queue);
+	UdpNet(UdpNet &anotherUdpNet);
+	UdpNet& operator = (UdpNet &anotherUdpNet);
+public:
+	UdpNet(Params *p, int netId = 0);
+	virtual ~UdpNet();
+	using Network::ENsend;
+	void *ENinit(Address *myaddr, short port);
+	int ENsend(Address *myaddr, Address *toaddr, char *data, int size);
+	int ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue);
+	int ENwait(int timeout);
+	int ENflush();
+	int ENcleanup();
+	void syscallsPerMsg(double *send, double *recv);
+	void setScheduler(Scheduler *sched, EventType recvEvent);
+};
+
+#endif /* _UDPNET_H_ */
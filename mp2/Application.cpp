@@ -26,34 +26,66 @@ void handler(int sig) {
  **********************************/
 int main(int argc, char *argv[]) {
 	//signal(SIGSEGV, handler);
-	if ( argc != ARGS_COUNT ) {
+	if ( argc != ARGS_COUNT && argc != ARGS_COUNT + 1 ) {
 		cout<<"Configuration (i.e., *.conf) file File Required"<<endl;
+		cout<<"Usage: ./Application <conf file> [emul|udp|shm]"<<endl;
 		return FAILURE;
 	}
 
+	Params *par = new Params();
+	par->setparams(argv[1]);
+	if ( argc == ARGS_COUNT + 1 && par->settransport(argv[2]) == FAILURE ) {
+		cout<<"Unknown transport "<<argv[2]<<endl;
+		return FAILURE;
+	}
+	// The tests read and fail the nodes directly, they all have to live in this process
+	if ( par->NODE_PROCS ) {
+		cout<<"The KV store tests cannot run a process per node, use udp or shm"<<endl;
+		return FAILURE;
+	}
+	// Only the emulated network keeps its messages where a checkpoint can see them
+	if ( (par->CHECKPOINT_AT >= 0 || !par->RESTORE.empty()) && (par->TRANSPORT != EMUL_TRANSPORT || par->TICK_MS > 0) ) {
+		cout<<"Checkpoints need the emul transport and simulated time"<<endl;
+		return FAILURE;
+	}
+	LOG_INFO("Random seed: %llu\n", (unsigned long long)par->SEED);
+
 	// Create a new application object
-	Application *app = new Application(argv[1]);
+	Application *app = new Application(par);
 	// Call the run function
-	app->run();
+	int ret = app->run();
 	// When done delete the application object
 	delete(app);
 
-	return SUCCESS;
+	return ret;
 }
 
 /**
  * Constructor of the Application class
  */
-Application::Application(char *infile) {
+Application::Application(Params *par) {
 	int i;
-	par = new Params();
-	srand (time(NULL));
-	par->setparams(infile);
+	this->par = par;
+	failRng.seed(par->SEED, RNG_FAIL, 0);
+	if ( par->SPAN_TRACE ) {
+		Trace::start();
+	}
+	clientRng.seed(par->SEED, RNG_CLIENT, 0);
+	workloadRng.seed(par->SEED, RNG_WORKLOAD, 0);
 	log = new Log(par);
-	en = new EmulNet(par);
-	en1 = new EmulNet(par);
-	mp1 = (MP1Node **) malloc(par->EN_GPSZ * sizeof(MP1Node *));
-	mp2 = (MP2Node **) malloc(par->EN_GPSZ * sizeof(MP2Node *));
+	sched = new Scheduler();
+	createNetworks();
+	en->setScheduler(sched, EV_MP1_RECV);
+	en1->setScheduler(sched, EV_MP2_RECV);
+	mp1.resize(par->EN_GPSZ);
+	mp2.resize(par->EN_GPSZ);
+	workload = (par->WORKLOAD_RECORDS > 0) ? new Workload(par) : NULL;
+	timeWhenAllNodesHaveJoined = 0;
+	allNodesJoined = false;
+	kvRunning = false;
+	insertTime = par->BOOTSTRAP ? 0 : INSERT_TIME;
+	// a bootstrapped run skips the joins, not any of the ticks of the KV store
+	endTime = TOTAL_RUNNING_TIME - (INSERT_TIME - insertTime);
 
 	/*
 	 * Init all nodes
@@ -65,10 +97,18 @@ Application::Application(char *infile) {
 		Address joinaddr;
 		joinaddr = getjoinaddr();
 		addressOfMemberNode = (Address *) en->ENinit(addressOfMemberNode, par->PORTNUM);
+		// the KV store network hands out the same ids
+		Address kvAddressOfMemberNode;
+		en1->ENinit(&kvAddressOfMemberNode, par->PORTNUM);
 		mp1[i] = new MP1Node(memberNode, par, en, log, addressOfMemberNode);
 		mp2[i] = new MP2Node(memberNode, par, en1, log, addressOfMemberNode);
 		log->LOG(&(mp1[i]->getMemberNode()->addr), "APP");
 		log->LOG(&(mp2[i]->getMemberNode()->addr), "APP MP2");
+		if ( workload != NULL ) {
+			mp2[i]->setOutcomeListener(Workload::outcome, workload);
+		}
+		mp2[i]->setMembership(mp1[i]);
+		mp2[i]->setScheduler(sched, EV_MP2_TICK);
 		delete addressOfMemberNode;
 	}
 }
@@ -77,18 +117,65 @@ Application::Application(char *infile) {
  * Destructor
  */
 Application::~Application() {
+	char traceName[40];
+	// a node process writes a file of its own, as it does for the logs
+	traceName[0] = 0;
+	if ( par->nodeProcess != 0 ) {
+		sprintf(traceName, "node%d.", par->nodeProcess);
+	}
+	strcat(traceName, TRACE_FILE);
+	Trace::dump(traceName);
 	delete log;
-	delete en;
-	delete en1;
+	for ( unsigned int n = 0; n < nets.size(); n++ ) {
+		delete nets[n];
+	}
 	for ( int i = 0; i < par->EN_GPSZ; i++ ) {
 		delete mp1[i];
 		delete mp2[i];
 	}
-	free(mp1);
-	free(mp2);
+	delete workload;
+	delete sched;
 	delete par;
 }
 
+/**
+ * FUNCTION NAME: createNetwork
+ *
+ * DESCRIPTION: Network of the transport picked in the parameters
+ */
+Network *Application::createNetwork(int netId) {
+	if ( par->TRANSPORT == UDP_TRANSPORT ) {
+		return new UdpNet(par, netId);
+	}
+	if ( par->TRANSPORT == SHM_TRANSPORT ) {
+		return new ShmNet(par, netId);
+	}
+	return new EmulNet(par, netId);
+}
+
+/**
+ * FUNCTION NAME: createNetworks
+ *
+ * DESCRIPTION: Networks of the membership and of the KV store. The emulated network carries
+ * 				both, each on a channel of its own, so that they share its buffer and links
+ * 				and the membership goes first. The udp and shm transports bind a socket or a
+ * 				ring per node and network, they stay two networks.
+ */
+void Application::createNetworks() {
+	if ( par->TRANSPORT == EMUL_TRANSPORT ) {
+		EmulNet *emul = new EmulNet(par, 0, NET_CHANNELS);
+		nets.push_back(emul);
+		en = emul->channel(MEMBERSHIP_CHANNEL);
+		en1 = emul->channel(KV_CHANNEL);
+	}
+	else {
+		en = createNetwork(0);
+		en1 = createNetwork(1);
+		nets.push_back(en);
+		nets.push_back(en1);
+	}
+}
+
 /**
  * FUNCTION NAME: run
  *
@@ -97,13 +184,55 @@ Application::~Application() {
 int Application::run()
 {
 	int i;
-	int timeWhenAllNodesHaveJoined = 0;
-	// boolean indicating if all nodes have joined
-	bool allNodesJoined = false;
-	srand(time(NULL));
+	unsigned int n;
+	// tick before the first one to run
+	int start = -1;
+
+	/*
+	 * Pick the run up where the checkpoint left it
+	 */
+	if ( !par->RESTORE.empty() ) {
+		if ( restore(par->RESTORE.c_str()) == FAILURE ) {
+			LOG_ERROR("Cannot restore the run from %s\n", par->RESTORE.c_str());
+			return FAILURE;
+		}
+		start = par->globaltime;
+	}
+
+	/*
+	 * Introduce the ith node at time STEPRATE*i, or all of them in the group at tick 0,
+	 * insert and test at fixed times
+	 */
+	else {
+		if ( par->BOOTSTRAP ) {
+			bootstrap();
+		}
+		else {
+			for( i = 0; i < par->EN_GPSZ; i++ ) {
+				sched->schedule(startTime(i), i, EV_START);
+			}
+		}
+		sched->schedule(timeWhenAllNodesHaveJoined + 51, -1, EV_APP);
+		sched->schedule(INSERT_TIME, -1, EV_APP);
+		sched->schedule(TEST_TIME, -1, EV_APP);
+		sched->schedule(TEST_TIME + FIRST_FAIL_TIME, -1, EV_APP);
+		sched->schedule(TEST_TIME + FIRST_FAIL_TIME + STABILIZE_TIME, -1, EV_APP);
+		sched->schedule(TEST_TIME + FIRST_FAIL_TIME + STABILIZE_TIME + STABILIZE_TIME, -1, EV_APP);
+		sched->schedule(TEST_TIME + FIRST_FAIL_TIME + STABILIZE_TIME + STABILIZE_TIME + LAST_FAIL_TIME, -1, EV_APP);
+	}
+
+	if ( par->TICK_MS > 0 ) {
+		par->startwallclock(0);
+	}
+
+	// As time runs along, skipping the ticks in which nothing happens
+	for( par->globaltime = nextTime(start); par->globaltime < endTime; par->globaltime = nextTime(par->globaltime) ) {
+		// Nodes with messages that came in from a socket
+		for ( n = 0; n < nets.size(); n++ ) {
+			nets[n]->ENwait(0);
+		}
+		sched->advance(par->globaltime);
 
-	// As time runs along
-	for( par->globaltime = 0; par->globaltime < TOTAL_RUNNING_TIME; ++par->globaltime ) {
 		// Run the membership protocol
 		mp1Run();
 
@@ -111,18 +240,50 @@ int Application::run()
 		if ( par->allNodesJoined == nodeCount && !allNodesJoined ) {
 			timeWhenAllNodesHaveJoined = par->getcurrtime();
 			allNodesJoined = true;
+			sched->schedule(timeWhenAllNodesHaveJoined + 51, -1, EV_APP);
 		}
 		if ( par->getcurrtime() > timeWhenAllNodesHaveJoined + 50 ) {
+			if ( !kvRunning ) {
+				// Every node has to catch up with the ring when the KV store (re)starts
+				for( i = 0; i < par->EN_GPSZ; i++ ) {
+					sched->post(i, EV_MP2_TICK);
+				}
+				kvRunning = true;
+			}
 			// Call the KV store functionalities
 			mp2Run();
 		}
+		else {
+			// The KV store catches up with all nodes once it runs again
+			sched->readySet(EV_MP2_TICK).clear();
+			kvRunning = false;
+		}
 		// Fail some nodes
 		//fail();
+
+		sched->readySet(EV_APP).clear();
+		// The messages of the tick leave together
+		for ( n = 0; n < nets.size(); n++ ) {
+			nets[n]->ENflush();
+		}
+
+		// The state is the same until the next tick that runs
+		if ( par->CHECKPOINT_AT >= 0 && par->globaltime <= par->CHECKPOINT_AT && sched->nextTime(par->globaltime) > par->CHECKPOINT_AT ) {
+			if ( checkpoint(CHECKPOINT_FILE) == FAILURE ) {
+				LOG_ERROR("Cannot write the checkpoint to %s\n", CHECKPOINT_FILE);
+			}
+		}
 	}
+	par->globaltime = endTime;
 
 	// Clean up
-	en->ENcleanup();
-	en1->ENcleanup();
+	for ( n = 0; n < nets.size(); n++ ) {
+		nets[n]->ENcleanup();
+	}
+	writeMetrics();
+	if ( workload != NULL ) {
+		workload->report(stdout);
+	}
 
 	for(i=0;i<=par->EN_GPSZ-1;i++) {
 		 mp1[i]->finishUpThisNode();
@@ -131,44 +292,262 @@ int Application::run()
 	return SUCCESS;
 }
 
+/**
+ * FUNCTION NAME: bootstrap
+ *
+ * DESCRIPTION: Start all nodes in the group at tick 0, each with the membership table the
+ * 				joins converge to, and the ring of that table built once for all of them.
+ * 				The KV store and the workload run from tick 0.
+ */
+void Application::bootstrap() {
+	int i;
+	vector<Address> group;
+	vector<Node> ring;
+
+	for( i = 0; i < par->EN_GPSZ; i++ ) {
+		group.push_back(mp1[i]->getMemberNode()->addr);
+		ring.emplace_back(Node(group.back()));
+	}
+	sort(ring.begin(), ring.end());
+
+	for( i = 0; i < par->EN_GPSZ; i++ ) {
+		mp1[i]->bootstrap(group);
+		mp2[i]->installRing(ring);
+		nodeCount += i;
+		sched->schedule(0, i, EV_MP1_TICK);
+	}
+	LOG_INFO("%d nodes bootstrapped into the group\n", par->EN_GPSZ);
+
+	// as if the last node joined 51 ticks ago, the KV store starts 50 ticks after it
+	timeWhenAllNodesHaveJoined = -51;
+	allNodesJoined = true;
+}
+
+/**
+ * FUNCTION NAME: startTime
+ *
+ * DESCRIPTION: Last tick before node i is up, the node runs from the next one
+ */
+int Application::startTime(int i) {
+	return par->BOOTSTRAP ? -1 : (int)(par->STEP_RATE*i);
+}
+
+/**
+ * FUNCTION NAME: writeMetrics
+ *
+ * DESCRIPTION: Write the metrics of the nodes to metrics.json.
+ */
+void Application::writeMetrics() {
+	vector<pair<int, Metrics *> > nodes;
+
+	for ( int i = 0; i < par->EN_GPSZ; i++ ) {
+		Member *node = mp1[i]->getMemberNode();
+		nodes.push_back(make_pair(*(int *)(node->addr.addr), &node->metrics));
+	}
+	Metrics::writeRun(METRICS_JSON, par->globaltime, nodes);
+}
+
+/**
+ * FUNCTION NAME: checkpoint
+ *
+ * DESCRIPTION: Write the state of the run at the end of the current tick to fileName:
+ * 				the clock, the random streams and the test state of the application,
+ * 				the scheduler, both networks with the messages on their way and every node
+ *
+ * RETURNS:
+ * SUCCESS or FAILURE
+ */
+int Application::checkpoint(const char *fileName) {
+	Checkpoint ck;
+	int i;
+
+	ck.putLong(par->EN_GPSZ);
+	ck.put(&par->SEED, sizeof(par->SEED));
+	ck.putLong(par->globaltime);
+	ck.putLong(par->dropmsg);
+	ck.putLong(nodeCount);
+	ck.putLong(timeWhenAllNodesHaveJoined);
+	ck.putLong(allNodesJoined);
+	ck.putLong(kvRunning);
+	ck.put(&failRng, sizeof(failRng));
+	ck.put(&clientRng, sizeof(clientRng));
+	ck.put(&workloadRng, sizeof(workloadRng));
+	ck.putLong(testKVPairs.size());
+	for ( map<string, string>::iterator it = testKVPairs.begin(); it != testKVPairs.end(); ++it ) {
+		ck.putString(it->first);
+		ck.putString(it->second);
+	}
+	ck.putLong(workload != NULL);
+	if ( workload != NULL ) {
+		workload->checkpoint(&ck);
+	}
+	MP2Node::checkpointTransID(&ck);
+	sched->checkpoint(&ck);
+	for ( unsigned int n = 0; n < nets.size(); n++ ) {
+		if ( nets[n]->checkpoint(&ck) == FAILURE ) {
+			return FAILURE;
+		}
+	}
+	// the membership and the KV store of a node share its Member
+	for ( i = 0; i < par->EN_GPSZ; i++ ) {
+		mp1[i]->getMemberNode()->checkpoint(&ck);
+		mp1[i]->checkpoint(&ck);
+		mp2[i]->checkpoint(&ck);
+	}
+	if ( ck.write(fileName) == FAILURE ) {
+		return FAILURE;
+	}
+	LOG_INFO("\nCheckpoint of tick %d written to %s, %zu bytes\n", par->globaltime, fileName, ck.size());
+	return SUCCESS;
+}
+
+/**
+ * FUNCTION NAME: restore
+ *
+ * DESCRIPTION: Read back the run written by checkpoint, over the one the constructor set up.
+ * 				The test case has to have as many nodes and the same workload.
+ *
+ * RETURNS:
+ * SUCCESS or FAILURE
+ */
+int Application::restore(const char *fileName) {
+	Checkpoint ck;
+	struct timespec begin, end;
+	int i;
+
+	clock_gettime(CLOCK_MONOTONIC, &begin);
+	if ( ck.open(fileName) == FAILURE ) {
+		return FAILURE;
+	}
+	if ( ck.getLong() != par->EN_GPSZ ) {
+		LOG_ERROR("%s is a checkpoint of another number of nodes\n", fileName);
+		return FAILURE;
+	}
+	ck.get(&par->SEED, sizeof(par->SEED));
+	par->globaltime = (int)ck.getLong();
+	par->dropmsg = (int)ck.getLong();
+	nodeCount = ck.getLong();
+	timeWhenAllNodesHaveJoined = (int)ck.getLong();
+	allNodesJoined = ck.getLong() != 0;
+	kvRunning = ck.getLong() != 0;
+	ck.get(&failRng, sizeof(failRng));
+	ck.get(&clientRng, sizeof(clientRng));
+	ck.get(&workloadRng, sizeof(workloadRng));
+	testKVPairs.clear();
+	for ( size_t n = ck.getCount(2 * sizeof(long)); n > 0; n-- ) {
+		string key = ck.getString();
+		testKVPairs[key] = ck.getString();
+	}
+	if ( (ck.getLong() != 0) != (workload != NULL) ) {
+		LOG_ERROR("%s is a checkpoint of another workload\n", fileName);
+		return FAILURE;
+	}
+	if ( workload != NULL ) {
+		workload->restore(&ck);
+	}
+	MP2Node::restoreTransID(&ck);
+	sched->restore(&ck);
+	for ( unsigned int n = 0; n < nets.size(); n++ ) {
+		if ( nets[n]->restore(&ck) == FAILURE ) {
+			return FAILURE;
+		}
+	}
+	for ( i = 0; i < par->EN_GPSZ; i++ ) {
+		mp1[i]->getMemberNode()->restore(&ck);
+		mp1[i]->restore(&ck);
+		mp2[i]->restore(&ck);
+	}
+	if ( !ck.ok() ) {
+		return FAILURE;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	LOG_INFO("Restored tick %d from %s, seed %llu, in %.1f ms\n", par->globaltime, fileName, (unsigned long long)par->SEED,
+			(end.tv_sec - begin.tv_sec) * 1e3 + (end.tv_nsec - begin.tv_nsec) / 1e6);
+	return SUCCESS;
+}
+
+/**
+ * FUNCTION NAME: nextTime
+ *
+ * DESCRIPTION: Returns the next tick to run after now.
+ * 				Simulated time jumps to the next scheduled event, wall clock time
+ * 				waits for the clock while listening to the network.
+ * 				A process that fell behind the clock catches up tick by tick,
+ * 				it does not skip the events of the ticks it missed.
+ */
+int Application::nextTime(int now) {
+	int t;
+
+	if ( par->TICK_MS <= 0 ) {
+		return sched->nextTime(now);
+	}
+	while ( (t = par->getwallclocktime()) <= now ) {
+		nets[0]->ENwait((int)max(1L, (long)(now + 1) * par->TICK_MS - par->getwallclockms()));
+		for ( unsigned int n = 1; n < nets.size(); n++ ) {
+			nets[n]->ENwait(0);
+		}
+	}
+	return min(t, sched->nextTime(now));
+}
+
 /**
  * FUNCTION NAME: mp1Run
  *
  * DESCRIPTION:	This function performs all the membership protocol functionalities
  */
 void Application::mp1Run() {
+	TRACE_TICK_SPAN("Application::mp1Run", NULL);
 	int i;
+	long memberListVersion;
+	set<int> &start = sched->readySet(EV_START);
+	set<int> &mail = sched->readySet(EV_MP1_RECV);
+	set<int> &tick = sched->readySet(EV_MP1_TICK);
+	set<int> starting;
+	set<int> nodes;
 
-	// For all the nodes in the system
-	for( i = 0; i <= par->EN_GPSZ-1; i++) {
+	// For all the nodes with messages waiting in the network
+	for( set<int>::iterator it = mail.begin(); it != mail.end(); it = mail.erase(it) ) {
+		i = *it;
 
 		/*
 		 * Receive messages from the network and queue them in the membership protocol queue
 		 */
-		if( par->getcurrtime() > (int)(par->STEP_RATE*i) && !(mp1[i]->getMemberNode()->bFailed) ) {
+		if( par->getcurrtime() > startTime(i) && !(mp1[i]->getMemberNode()->bFailed) ) {
 			// Receive messages from the network and queue them
 			mp1[i]->recvLoop();
+			tick.insert(i);
+		}
+		else if( par->getcurrtime() <= startTime(i) ) {
+			// Messages stay in the network until the node is up
+			sched->schedule(startTime(i) + 1, i, EV_MP1_RECV);
 		}
 
 	}
 
-	// For all the nodes in the system
-	for( i = par->EN_GPSZ - 1; i >= 0; i-- ) {
+	starting.swap(start);
+	nodes.insert(starting.begin(), starting.end());
+	nodes.insert(tick.begin(), tick.end());
+	tick.clear();
+
+	// For all the nodes that have something to do
+	for( set<int>::reverse_iterator it = nodes.rbegin(); it != nodes.rend(); ++it ) {
+		i = *it;
+		memberListVersion = mp1[i]->getMemberNode()->memberListVersion;
 
 		/*
 		 * Introduce nodes into the distributed system
 		 */
-		if( par->getcurrtime() == (int)(par->STEP_RATE*i) ) {
+		if( starting.count(i) ) {
 			// introduce the ith node into the system at time STEPRATE*i
 			mp1[i]->nodeStart(JOINADDR, par->PORTNUM);
-			cout<<i<<"-th introduced node is assigned with the address: "<<mp1[i]->getMemberNode()->addr.getAddress() << endl;
+			LOG_INFO("%d-th introduced node is assigned with the address: %s\n", i, mp1[i]->getMemberNode()->addr.getAddress().c_str());
 			nodeCount += i;
 		}
 
 		/*
 		 * Handle all the messages in your queue and send heartbeats
 		 */
-		else if( par->getcurrtime() > (int)(par->STEP_RATE*i) && !(mp1[i]->getMemberNode()->bFailed) ) {
+		else if( par->getcurrtime() > startTime(i) && !(mp1[i]->getMemberNode()->bFailed) ) {
 			// handle messages and send heartbeats
 			mp1[i]->nodeLoop();
 			#ifdef DEBUGLOG
@@ -177,6 +556,22 @@ void Application::mp1Run() {
 			}
 			#endif
 		}
+		else {
+			continue;
+		}
+
+		// Heartbeats are due every tick once the node is in the group
+		if( mp1[i]->getMemberNode()->inGroup && !(mp1[i]->getMemberNode()->bFailed) ) {
+			sched->schedule(par->getcurrtime() + 1, i, EV_MP1_TICK);
+		}
+		// Until then the node only wakes up to retry a JOINREQ nobody answered
+		else if( mp1[i]->joinRetryTime() >= 0 ) {
+			sched->schedule(mp1[i]->joinRetryTime(), i, EV_MP1_TICK);
+		}
+		// The ring of the node has to follow its membership table
+		if( mp1[i]->getMemberNode()->memberListVersion != memberListVersion ) {
+			sched->post(i, EV_MP2_TICK);
+		}
 
 	}
 }
@@ -190,45 +585,76 @@ void Application::mp1Run() {
  * 				2) CRUD operations
  */
 void Application::mp2Run() {
-	int i;
-
-	// For all the nodes in the system
-	for( i = 0; i <= par->EN_GPSZ-1; i++) {
+	TRACE_TICK_SPAN("Application::mp2Run", NULL);
+	int i = -1;
+	set<int> &mail = sched->readySet(EV_MP2_RECV);
+	set<int> &tick = sched->readySet(EV_MP2_TICK);
+	set<int> nodes;
+
+	// For all the nodes with a timer due or messages waiting, in ascending order.
+	// Messages sent to a node later in the order during this loop are received in this tick.
+	while ( true ) {
+		set<int>::iterator nextMail = mail.upper_bound(i);
+		set<int>::iterator nextTick = tick.upper_bound(i);
+		if ( nextMail == mail.end() && nextTick == tick.end() ) {
+			break;
+		}
+		i = min(nextMail != mail.end() ? *nextMail : INT_MAX, nextTick != tick.end() ? *nextTick : INT_MAX);
+		mail.erase(i);
+		tick.erase(i);
 
 		/*
 		 * 1) Update the ring
 		 * 2) Receive messages from the network and queue them in the KV store queue
 		 */
-		if ( par->getcurrtime() > (int)(par->STEP_RATE*i) && !mp2[i]->getMemberNode()->bFailed ) {
+		if ( par->getcurrtime() > startTime(i) && !mp2[i]->getMemberNode()->bFailed ) {
 			if ( mp2[i]->getMemberNode()->inited && mp2[i]->getMemberNode()->inGroup ) {
 				// Step 1
 				mp2[i]->updateRing();
 			}
 			// Step 2
 			mp2[i]->recvLoop();
+			nodes.insert(i);
+		}
+		else if ( par->getcurrtime() <= startTime(i) ) {
+			// Messages stay in the network until the node is up
+			sched->schedule(startTime(i) + 1, i, EV_MP2_RECV);
 		}
 	}
 
 	/**
 	 * Handle messages from the queue and update the DHT
 	 */
-	for ( i = par->EN_GPSZ-1; i >= 0; i-- ) {
-		if ( par->getcurrtime() > (int)(par->STEP_RATE*i) && !mp2[i]->getMemberNode()->bFailed ) {
-			mp2[i]->checkMessages();
-		}
+	for ( set<int>::reverse_iterator it = nodes.rbegin(); it != nodes.rend(); ++it ) {
+		i = *it;
+		mp2[i]->checkMessages();
+	}
+
+	/**
+	 * Nothing else is scheduled for this tick
+	 */
+	if ( sched->readySet(EV_APP).empty() ) {
+		return;
+	}
+
+	/**
+	 * Run the workload of the test case instead of the CRUD test
+	 */
+	if ( workload != NULL ) {
+		runWorkload();
 	}
 
 	/**
 	 * Insert a set of test key value pairs into the system
 	 */
-	if ( par->getcurrtime() == INSERT_TIME ) {
+	else if ( par->getcurrtime() == INSERT_TIME ) {
 		insertTestKVPairs();
 	}
 
 	/**
 	 * Test CRUD operations
 	 */
-	if ( par->getcurrtime() >= TEST_TIME ) {
+	if ( workload == NULL && par->getcurrtime() >= TEST_TIME ) {
 		/**************
 		 * CREATE TEST
 		 **************/
@@ -237,7 +663,7 @@ void Application::mp2Run() {
 		 *
 		 */
 		if ( par->getcurrtime() == TEST_TIME && CREATE_TEST == par->CRUDTEST ) {
-			cout<<endl<<"Doing create test at time: "<<par->getcurrtime()<<endl;
+			LOG_INFO("\nDoing create test at time: %d\n", par->getcurrtime());
 		} // End of create test
 
 		/***************
@@ -342,14 +768,14 @@ void Application::fail() {
 	}
 
 	if( par->SINGLE_FAILURE && par->getcurrtime() == 100 ) {
-		removed = (rand() % par->EN_GPSZ);
+		removed = failRng.nextInt(par->EN_GPSZ);
 		#ifdef DEBUGLOG
 		log->LOG(&mp1[removed]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
 		#endif
 		mp1[removed]->getMemberNode()->bFailed = true;
 	}
 	else if( par->getcurrtime() == 100 ) {
-		removed = rand() % par->EN_GPSZ/2;
+		removed = failRng.nextInt(par->EN_GPSZ)/2;
 		for ( i = removed; i < removed + par->EN_GPSZ/2; i++ ) {
 			#ifdef DEBUGLOG
 			log->LOG(&mp1[i]->getMemberNode()->addr, "Node failed at time = %d", par->getcurrtime());
@@ -367,15 +793,14 @@ void Application::fail() {
 /**
  * FUNCTION NAME: getjoinaddr
  *
- * DESCRIPTION: This function returns the address of the coordinator
+ * DESCRIPTION: This function returns the address of the coordinator, the first introducer
  */
 Address Application::getjoinaddr(void){
-	//trace.funcEntry("Application::getjoinaddr");
+	TRACE_CALL_SPAN("Application::getjoinaddr", NULL);
     Address joinaddr;
     joinaddr.init();
-    *(int *)(&(joinaddr.addr))=1;
+    *(int *)(&(joinaddr.addr))=par->INTRODUCERS[0];
     *(short *)(&(joinaddr.addr[4]))=0;
-    //trace.funcExit("Application::getjoinaddr", SUCCESS);
     return joinaddr;
 }
 
@@ -387,7 +812,7 @@ Address Application::getjoinaddr(void){
 int Application::findARandomNodeThatIsAlive() {
 	int number;
 	do {
-		number = (rand()%par->EN_GPSZ);
+		number = clientRng.nextInt(par->EN_GPSZ);
 	}while (mp2[number]->getMemberNode()->bFailed);
 	return number;
 }
@@ -398,7 +823,6 @@ int Application::findARandomNodeThatIsAlive() {
  * DESCRIPTION: Init NUMBER_OF_INSERTS test KV pairs in the map
  */
 void Application::initTestKVPairs() {
-	srand(time(NULL));
 	int i;
 	string key;
 	key.clear();
@@ -406,9 +830,9 @@ void Application::initTestKVPairs() {
 	int alphanumLen = sizeof(alphanum) - 1;
 	while ( testKVPairs.size() != NUMBER_OF_INSERTS ) {
 		for ( i = 0; i < KEY_LENGTH; i++ ) {
-			key.push_back(alphanum[rand()%alphanumLen]);
+			key.push_back(alphanum[workloadRng.nextInt(alphanumLen)]);
 		}
-		string value = "value" + to_string(rand()%NUMBER_OF_INSERTS);
+		string value = "value" + to_string(workloadRng.nextInt(NUMBER_OF_INSERTS));
 		testKVPairs[key] = value;
 		key.clear();
 	}
@@ -436,7 +860,52 @@ void Application::insertTestKVPairs() {
 		mp2[number]->clientCreate(it->first, it->second);
 	}
 
-	cout<<endl<<"Sent " <<testKVPairs.size() <<" create messages to the ring"<<endl;
+	LOG_INFO("\nSent %zu create messages to the ring\n", testKVPairs.size());
+}
+
+/**
+ * FUNCTION NAME: runWorkload
+ *
+ * DESCRIPTION: Load the records of the workload from insertTime on, then run its operations.
+ * 				Every record and operation goes to a random node that is alive.
+ */
+void Application::runWorkload() {
+	string key, value;
+	int n, number;
+
+	if ( par->getcurrtime() < insertTime ) {
+		return;
+	}
+	for ( n = workload->recordsDue(par->getcurrtime()); n > 0; n-- ) {
+		workload->nextRecord(key, value);
+		mp2[findARandomNodeThatIsAlive()]->clientCreate(key, value);
+	}
+
+	// operations started later would not have their outcome by the end of the run
+	if ( par->getcurrtime() < endTime - TRANSACTION_TIMEOUT - 1 ) {
+		for ( n = workload->opsDue(par->getcurrtime()); n > 0; n-- ) {
+			number = findARandomNodeThatIsAlive();
+			switch ( workload->nextOp(key, value) ) {
+				case CREATE:
+					mp2[number]->clientCreate(key, value);
+					break;
+				case UPDATE:
+					mp2[number]->clientUpdate(key, value);
+					break;
+				case DELETE:
+					mp2[number]->clientDelete(key);
+					break;
+				default:
+					mp2[number]->clientRead(key);
+					break;
+			}
+		}
+	}
+
+	// The workload runs in every tick until all is issued
+	if ( !workload->issuedAll() ) {
+		sched->schedule(par->getcurrtime() + 1, -1, EV_APP);
+	}
 }
 
 /**
@@ -449,7 +918,7 @@ void Application::deleteTest() {
 	/**
 	 * Test 1: Delete half the KV pairs
 	 */
-	cout<<endl<<"Deleting "<<testKVPairs.size()/2 <<" valid keys.... ... .. . ."<<endl;
+	LOG_INFO("\nDeleting %zu valid keys.... ... .. . .\n", testKVPairs.size()/2);
 	map<string, string>::iterator it = testKVPairs.begin();
 	for ( int i = 0; i < testKVPairs.size()/2; i++ ) {
 		it++;
@@ -465,7 +934,7 @@ void Application::deleteTest() {
 	/**
 	 * Test 2: Delete a non-existent key
 	 */
-	cout<<endl<<"Deleting an invalid key.... ... .. . ."<<endl;
+	LOG_INFO("\nDeleting an invalid key.... ... .. . .\n");
 	string invalidKey = "invalidKey";
 	// Step 2.a. Find a node that is alive
 	number = findARandomNodeThatIsAlive();
@@ -499,7 +968,7 @@ void Application::readTest() {
 		number = findARandomNodeThatIsAlive();
 
 		// Step 1.b Do a read operation
-		cout<<endl<<"Reading a valid key.... ... .. . ."<<endl;
+		LOG_INFO("\nReading a valid key.... ... .. . .\n");
 		log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
 		mp2[number]->clientRead(it->first);
 	}
@@ -518,7 +987,7 @@ void Application::readTest() {
 		replicas = mp2[number]->findNodes(it->first);
 		// if less than quorum replicas are found then exit
 		if ( replicas.size() < (RF-1) ) {
-			cout<<endl<<"Could not find at least quorum replicas for this key. Exiting!!! size of replicas vector: "<<replicas.size()<<endl;
+			LOG_ERROR("\nCould not find at least quorum replicas for this key. Exiting!!! size of replicas vector: %zu\n", replicas.size());
 			log->LOG(&mp2[number]->getMemberNode()->addr, "Could not find at least quorum replicas for this key. Exiting!!! size of replicas vector: %d", replicas.size());
 			exit(1);
 		}
@@ -546,19 +1015,19 @@ void Application::readTest() {
 			log->LOG(&mp2[nodeToFail]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
 			mp2[nodeToFail]->getMemberNode()->bFailed = true;
 			mp1[nodeToFail]->getMemberNode()->bFailed = true;
-			cout<<endl<<"Failed a replica node"<<endl;
+			LOG_INFO("\nFailed a replica node\n");
 		}
 		else {
 			// The code can never reach here
 			log->LOG(&mp2[number]->getMemberNode()->addr, "Could not fail a node");
-			cout<<"Could not fail a node. Exiting!!!";
+			LOG_ERROR("Could not fail a node. Exiting!!!");
 			exit(1);
 		}
 
 		number = findARandomNodeThatIsAlive();
 
 		// Step 2.d Issue a read
-		cout<<endl<<"Reading a valid key.... ... .. . ."<<endl;
+		LOG_INFO("\nReading a valid key.... ... .. . .\n");
 		log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
 		mp2[number]->clientRead(it->first);
 
@@ -611,7 +1080,7 @@ void Application::readTest() {
 			}
 			else {
 				// If the code reaches here. Test your stabilization protocol
-				cout<<endl<<"Not enough replicas to fail two nodes. Number of replicas of this key: " <<replicas.size() <<". Exiting test case !! "<<endl;
+				LOG_ERROR("\nNot enough replicas to fail two nodes. Number of replicas of this key: %zu. Exiting test case !! \n", replicas.size());
 				exit(1);
 			}
 			if ( count == 2 ) {
@@ -620,21 +1089,21 @@ void Application::readTest() {
 					log->LOG(&mp2[nodesToFail.at(i)]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
 					mp2[nodesToFail.at(i)]->getMemberNode()->bFailed = true;
 					mp1[nodesToFail.at(i)]->getMemberNode()->bFailed = true;
-					cout<<endl<<"Failed a replica node"<<endl;
+					LOG_INFO("\nFailed a replica node\n");
 				}
 			}
 			else {
 				// The code can never reach here
 				log->LOG(&mp2[number]->getMemberNode()->addr, "Could not fail two nodes");
 				//cout<<"COUNT: " <<count;
-				cout<<"Could not fail two nodes. Exiting!!!";
+				LOG_ERROR("Could not fail two nodes. Exiting!!!");
 				exit(1);
 			}
 
 			number = findARandomNodeThatIsAlive();
 
 			// Step 3.c Issue a read
-			cout<<endl<<"Reading a valid key.... ... .. . ."<<endl;
+			LOG_INFO("\nReading a valid key.... ... .. . .\n");
 			log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
 			// This read should fail since at least quorum nodes are not alive
 			mp2[number]->clientRead(it->first);
@@ -647,7 +1116,7 @@ void Application::readTest() {
 		if ( par->getcurrtime() == (TEST_TIME + FIRST_FAIL_TIME + STABILIZE_TIME + STABILIZE_TIME) ) {
 			number = findARandomNodeThatIsAlive();
 			// Step 3.e Issue a read
-			cout<<endl<<"Reading a valid key.... ... .. . ."<<endl;
+			LOG_INFO("\nReading a valid key.... ... .. . .\n");
 			log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
 			// This read should be successful
 			mp2[number]->clientRead(it->first);
@@ -676,7 +1145,7 @@ void Application::readTest() {
 					mp2[i]->getMemberNode()->bFailed = true;
 					mp1[i]->getMemberNode()->bFailed = true;
 					failedOneNode = true;
-					cout<<endl<<"Failed a non-replica node"<<endl;
+					LOG_INFO("\nFailed a non-replica node\n");
 					break;
 				}
 			}
@@ -684,14 +1153,14 @@ void Application::readTest() {
 		if ( !failedOneNode ) {
 			// The code can never reach here
 			log->LOG(&mp2[number]->getMemberNode()->addr, "Could not fail a node(non-replica)");
-			cout<<"Could not fail a node(non-replica). Exiting!!!";
+			LOG_ERROR("Could not fail a node(non-replica). Exiting!!!");
 			exit(1);
 		}
 
 		number = findARandomNodeThatIsAlive();
 
 		// Step 4.d Issue a read operation
-		cout<<endl<<"Reading a valid key.... ... .. . ."<<endl;
+		LOG_INFO("\nReading a valid key.... ... .. . .\n");
 		log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), it->second.c_str(), par->getcurrtime());
 		// This read should fail since at least quorum nodes are not alive
 		mp2[number]->clientRead(it->first);
@@ -709,7 +1178,7 @@ void Application::readTest() {
 		number = findARandomNodeThatIsAlive();
 
 		// Step 5.b Issue a read operation
-		cout<<endl<<"Reading an invalid key.... ... .. . ."<<endl;
+		LOG_INFO("\nReading an invalid key.... ... .. . .\n");
 		log->LOG(&mp2[number]->getMemberNode()->addr, "READ OPERATION KEY: %s at time: %d", invalidKey.c_str(), par->getcurrtime());
 		// This read should fail since at least quorum nodes are not alive
 		mp2[number]->clientRead(invalidKey);
@@ -744,7 +1213,7 @@ void Application::updateTest() {
 		number = findARandomNodeThatIsAlive();
 
 		// Step 1.b Do a update operation
-		cout<<endl<<"Updating a valid key.... ... .. . ."<<endl;
+		LOG_INFO("\nUpdating a valid key.... ... .. . .\n");
 		log->LOG(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), newValue.c_str(), par->getcurrtime());
 		mp2[number]->clientUpdate(it->first, newValue);
 	}
@@ -764,7 +1233,7 @@ void Application::updateTest() {
 		// if quorum replicas are not found then exit
 		if ( replicas.size() < RF-1 ) {
 			log->LOG(&mp2[number]->getMemberNode()->addr, "Could not find at least quorum replicas for this key. Exiting!!! size of replicas vector: %d", replicas.size());
-			cout<<endl<<"Could not find at least quorum replicas for this key. Exiting!!! size of replicas vector: "<<replicas.size()<<endl;
+			LOG_ERROR("\nCould not find at least quorum replicas for this key. Exiting!!! size of replicas vector: %zu\n", replicas.size());
 			exit(1);
 		}
 
@@ -791,19 +1260,19 @@ void Application::updateTest() {
 			log->LOG(&mp2[nodeToFail]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
 			mp2[nodeToFail]->getMemberNode()->bFailed = true;
 			mp1[nodeToFail]->getMemberNode()->bFailed = true;
-			cout<<endl<<"Failed a replica node"<<endl;
+			LOG_INFO("\nFailed a replica node\n");
 		}
 		else {
 			// The code can never reach here
 			log->LOG(&mp2[number]->getMemberNode()->addr, "Could not fail a node");
-			cout<<"Could not fail a node. Exiting!!!";
+			LOG_ERROR("Could not fail a node. Exiting!!!");
 			exit(1);
 		}
 
 		number = findARandomNodeThatIsAlive();
 
 		// Step 2.d Issue a update
-		cout<<endl<<"Updating a valid key.... ... .. . ."<<endl;
+		LOG_INFO("\nUpdating a valid key.... ... .. . .\n");
 		log->LOG(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), newValue.c_str(), par->getcurrtime());
 		mp2[number]->clientUpdate(it->first, newValue);
 
@@ -855,7 +1324,7 @@ void Application::updateTest() {
 			}
 			else {
 				// If the code reaches here. Test your stabilization protocol
-				cout<<endl<<"Not enough replicas to fail two nodes. Exiting test case !! "<<endl;
+				LOG_ERROR("\nNot enough replicas to fail two nodes. Exiting test case !! \n");
 			}
 			if ( count == 2 ) {
 				for ( int i = 0; i < nodesToFail.size(); i++ ) {
@@ -863,20 +1332,20 @@ void Application::updateTest() {
 					log->LOG(&mp2[nodesToFail.at(i)]->getMemberNode()->addr, "Node failed at time=%d", par->getcurrtime());
 					mp2[nodesToFail.at(i)]->getMemberNode()->bFailed = true;
 					mp1[nodesToFail.at(i)]->getMemberNode()->bFailed = true;
-					cout<<endl<<"Failed a replica node"<<endl;
+					LOG_INFO("\nFailed a replica node\n");
 				}
 			}
 			else {
 				// The code can never reach here
 				log->LOG(&mp2[number]->getMemberNode()->addr, "Could not fail two nodes");
-				cout<<"Could not fail two nodes. Exiting!!!";
+				LOG_ERROR("Could not fail two nodes. Exiting!!!");
 				exit(1);
 			}
 
 			number = findARandomNodeThatIsAlive();
 
 			// Step 3.c Issue an update
-			cout<<endl<<"Updating a valid key.... ... .. . ."<<endl;
+			LOG_INFO("\nUpdating a valid key.... ... .. . .\n");
 			log->LOG(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), newValue.c_str(), par->getcurrtime());
 			// This update should fail since at least quorum nodes are not alive
 			mp2[number]->clientUpdate(it->first, newValue);
@@ -889,7 +1358,7 @@ void Application::updateTest() {
 		if ( par->getcurrtime() == (TEST_TIME + FIRST_FAIL_TIME + STABILIZE_TIME + STABILIZE_TIME) ) {
 			number = findARandomNodeThatIsAlive();
 			// Step 3.e Issue a update
-			cout<<endl<<"Updating a valid key.... ... .. . ."<<endl;
+			LOG_INFO("\nUpdating a valid key.... ... .. . .\n");
 			log->LOG(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), newValue.c_str(), par->getcurrtime());
 			// This update should be successful
 			mp2[number]->clientUpdate(it->first, newValue);
@@ -918,7 +1387,7 @@ void Application::updateTest() {
 					mp2[i]->getMemberNode()->bFailed = true;
 					mp1[i]->getMemberNode()->bFailed = true;
 					failedOneNode = true;
-					cout<<endl<<"Failed a non-replica node"<<endl;
+					LOG_INFO("\nFailed a non-replica node\n");
 					break;
 				}
 			}
@@ -927,14 +1396,14 @@ void Application::updateTest() {
 		if ( !failedOneNode ) {
 			// The code can never reach here
 			log->LOG(&mp2[number]->getMemberNode()->addr, "Could not fail a node(non-replica)");
-			cout<<"Could not fail a node(non-replica). Exiting!!!";
+			LOG_ERROR("Could not fail a node(non-replica). Exiting!!!");
 			exit(1);
 		}
 
 		number = findARandomNodeThatIsAlive();
 
 		// Step 4.d Issue a update operation
-		cout<<endl<<"Updating a valid key.... ... .. . ."<<endl;
+		LOG_INFO("\nUpdating a valid key.... ... .. . .\n");
 		log->LOG(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", it->first.c_str(), newValue.c_str(), par->getcurrtime());
 		// This read should fail since at least quorum nodes are not alive
 		mp2[number]->clientUpdate(it->first, newValue);
@@ -953,7 +1422,7 @@ void Application::updateTest() {
 		number = findARandomNodeThatIsAlive();
 
 		// Step 5.b Issue a read operation
-		cout<<endl<<"Updating a valid key.... ... .. . ."<<endl;
+		LOG_INFO("\nUpdating a valid key.... ... .. . .\n");
 		log->LOG(&mp2[number]->getMemberNode()->addr, "UPDATE OPERATION KEY: %s VALUE: %s at time: %d", invalidKey.c_str(), invalidValue.c_str(), par->getcurrtime());
 		// This read should fail since at least quorum nodes are not alive
 		mp2[number]->clientUpdate(invalidKey, invalidValue);
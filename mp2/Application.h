@@ -12,16 +12,24 @@
 #include "Log.h"
 #include "Params.h"
 #include "Member.h"
+#include "Network.h"
 #include "EmulNet.h"
+#include "UdpNet.h"
+#include "ShmNet.h"
 #include "Queue.h"
 #include "MP2Node.h"
 #include "Node.h"
 #include "common.h"
+#include "Scheduler.h"
+#include "Random.h"
+#include "Trace.h"
+#include "Workload.h"
+#include "Checkpoint.h"
 
 /**
  * global variables
  */
-int nodeCount = 0;
+long nodeCount = 0;
 static const char alphanum[] =
 "0123456789"
 "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
@@ -41,6 +49,9 @@ static const char alphanum[] =
 #define NUMBER_OF_INSERTS 100
 #define KEY_LENGTH 5
 
+// channels of the emulated network, the membership comes first
+enum netChannel { MEMBERSHIP_CHANNEL, KV_CHANNEL, NET_CHANNELS };
+
 /**
  * CLASS NAME: Application
  *
@@ -51,23 +62,50 @@ private:
 	// Address for introduction to the group
 	// Coordinator Node
 	char JOINADDR[30];
-	EmulNet *en;
-	EmulNet *en1;
+	// networks of the membership and of the KV store
+	Network *en;
+	Network *en1;
+	// transports they are on, one carries both on the emulated network
+	vector<Network *> nets;
     Log *log;
-	MP1Node **mp1;
-	MP2Node **mp2;
+	vector<MP1Node *> mp1;
+	vector<MP2Node *> mp2;
 	Params *par;
+	Scheduler *sched;
+	// Random streams of the application layer
+	Random failRng;
+	Random clientRng;
+	Random workloadRng;
 	map<string, string> testKVPairs;
+	// Workload of the test case, NULL for the CRUD test
+	Workload *workload;
+	// tick all nodes were in the group, whether they all were then
+	int timeWhenAllNodesHaveJoined;
+	bool allNodesJoined;
+	// whether the KV store ran in the previous tick
+	bool kvRunning;
+	// tick the records of the workload are loaded from, and the tick the run stops at
+	int insertTime;
+	int endTime;
 public:
-	Application(char *);
+	Application(Params *);
 	virtual ~Application();
+	Network *createNetwork(int netId);
+	void createNetworks();
 	Address getjoinaddr();
 	void initTestKVPairs();
 	int run();
+	void bootstrap();
+	int startTime(int i);
+	int nextTime(int now);
 	void mp1Run();
 	void mp2Run();
 	void fail();
+	void writeMetrics();
+	int checkpoint(const char *fileName);
+	int restore(const char *fileName);
 	void insertTestKVPairs();
+	void runWorkload();
 	int findARandomNodeThatIsAlive();
 	void deleteTest();
 	void readTest();
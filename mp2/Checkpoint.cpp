@@ -0,0 +1,172 @@
+/**********************************
+ * FILE NAME: Checkpoint.cpp
+ *
+ * DESCRIPTION: Simulation checkpoint definition
+ **********************************/
+
+#include "Checkpoint.h"
+
+/**
+ * Constructor
+ */
+Checkpoint::Checkpoint(): mapped(NULL), mappedSize(0), offset(0), bad(false) {
+	put(CHECKPOINT_MAGIC, 4);
+	putLong(CHECKPOINT_VERSION);
+}
+
+/**
+ * Destructor
+ */
+Checkpoint::~Checkpoint() {
+	if ( mapped != NULL ) {
+		munmap(mapped, mappedSize);
+	}
+}
+
+/**
+ * FUNCTION NAME: open
+ *
+ * DESCRIPTION: Map a checkpoint file for reading, the reads start right after its header
+ *
+ * RETURNS:
+ * FAILURE if the file cannot be mapped or is not a checkpoint of this version
+ */
+int Checkpoint::open(const char *fileName) {
+	struct stat st;
+	char magic[4];
+	int fd = ::open(fileName, O_RDONLY);
+
+	if ( fd < 0 ) {
+		perror(fileName);
+		return FAILURE;
+	}
+	if ( fstat(fd, &st) < 0 || st.st_size == 0 ) {
+		close(fd);
+		return FAILURE;
+	}
+	mapped = (char *) mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+	close(fd);
+	if ( mapped == MAP_FAILED ) {
+		perror("mmap");
+		mapped = NULL;
+		return FAILURE;
+	}
+	mappedSize = st.st_size;
+	offset = 0;
+	bad = false;
+	image.clear();
+
+	get(magic, sizeof(magic));
+	if ( memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) != 0 || getLong() != CHECKPOINT_VERSION ) {
+		return FAILURE;
+	}
+	return SUCCESS;
+}
+
+/**
+ * FUNCTION NAME: write
+ *
+ * DESCRIPTION: Write the image to a file, replacing it only once it is complete
+ */
+int Checkpoint::write(const char *fileName) {
+	string tmpName = string(fileName) + ".tmp";
+	FILE *fp = fopen(tmpName.c_str(), "w");
+
+	if ( fp == NULL ) {
+		perror(tmpName.c_str());
+		return FAILURE;
+	}
+	if ( fwrite(image.data(), 1, image.size(), fp) != image.size() ) {
+		fclose(fp);
+		unlink(tmpName.c_str());
+		return FAILURE;
+	}
+	fclose(fp);
+	return rename(tmpName.c_str(), fileName) == 0 ? SUCCESS : FAILURE;
+}
+
+/**
+ * FUNCTION NAME: put
+ *
+ * DESCRIPTION: Append size bytes to the image
+ */
+void Checkpoint::put(const void *data, size_t size) {
+	image.insert(image.end(), (const char *)data, (const char *)data + size);
+}
+
+/**
+ * FUNCTION NAME: putLong
+ *
+ * DESCRIPTION: Append a number, counts and sizes are all written as long
+ */
+void Checkpoint::putLong(long value) {
+	put(&value, sizeof(value));
+}
+
+/**
+ * FUNCTION NAME: putString
+ *
+ * DESCRIPTION: Append the length and the bytes of a string
+ */
+void Checkpoint::putString(const string &value) {
+	putLong(value.size());
+	put(value.data(), value.size());
+}
+
+/**
+ * FUNCTION NAME: get
+ *
+ * DESCRIPTION: Read the next size bytes of the mapping
+ */
+void Checkpoint::get(void *data, size_t size) {
+	if ( size == 0 ) {
+		return;
+	}
+	if ( bad || offset + size > mappedSize ) {
+		memset(data, 0, size);
+		bad = true;
+		return;
+	}
+	memcpy(data, mapped + offset, size);
+	offset += size;
+}
+
+/**
+ * FUNCTION NAME: getLong
+ *
+ * DESCRIPTION: Read a number written by putLong
+ */
+long Checkpoint::getLong() {
+	long value;
+	get(&value, sizeof(value));
+	return value;
+}
+
+/**
+ * FUNCTION NAME: getCount
+ *
+ * DESCRIPTION: Read the number of elements of a container, each at least elementSize bytes.
+ * 				A count the rest of the mapping cannot hold marks the checkpoint bad.
+ *
+ * RETURNS:
+ * the count, 0 once the checkpoint is bad
+ */
+size_t Checkpoint::getCount(size_t elementSize) {
+	long count = getLong();
+	if ( bad || count < 0 || (size_t)count > (mappedSize - offset) / max(elementSize, (size_t)1) ) {
+		bad = true;
+		return 0;
+	}
+	return (size_t)count;
+}
+
+/**
+ * FUNCTION NAME: getString
+ *
+ * DESCRIPTION: Read a string written by putString
+ */
+string Checkpoint::getString() {
+	size_t size = getCount(1);
+	offset += size;
+	return string(mapped + offset - size, size);
+}
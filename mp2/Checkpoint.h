@@ -0,0 +1,62 @@
+/**********************************
+ * FILE NAME: Checkpoint.h
+ *
+ * DESCRIPTION: Simulation checkpoint header file
+ **********************************/
+
+#ifndef _CHECKPOINT_H_
+#define _CHECKPOINT_H_
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "stdincludes.h"
+
+/*
+ * Macros
+ */
+#define CHECKPOINT_FILE "checkpoint.bin"
+#define CHECKPOINT_MAGIC "CKPT"
+// bumped whenever what a class writes changes, older files are refused
+#define CHECKPOINT_VERSION 7
+
+/**
+ * CLASS NAME: Checkpoint
+ *
+ * DESCRIPTION: Flat binary image of the state of a run. Every class writes its own state
+ * 				with put and reads it back in the same order with get. The image is built
+ * 				in memory and written at once, it is read back straight from a private
+ * 				mapping of the file. A read past the end zeroes what it reads and marks the
+ * 				checkpoint bad, the caller checks ok() once it has read everything.
+ */
+class Checkpoint {
+private:
+	// image being written
+	vector<char> image;
+	// mapping being read, and the offset of the next read
+	char *mapped;
+	size_t mappedSize;
+	size_t offset;
+	bool bad;
+	Checkpoint(Checkpoint &anotherCheckpoint);
+	Checkpoint& operator = (Checkpoint &anotherCheckpoint);
+public:
+	Checkpoint();
+	virtual ~Checkpoint();
+	int open(const char *fileName);
+	int write(const char *fileName);
+	void put(const void *data, size_t size);
+	void putLong(long value);
+	void putString(const string &value);
+	void get(void *data, size_t size);
+	long getLong();
+	size_t getCount(size_t elementSize);
+	string getString();
+	bool ok() {
+		return !bad;
+	}
+	size_t size() {
+		return mapped != NULL ? mappedSize : image.size();
+	}
+};
+
+#endif /* _CHECKPOINT_H_ */
@@ -9,60 +9,108 @@
 /**
  * Constructor
  */
-EmulNet::EmulNet(Params *p)
+EmulNet::EmulNet(Params *p, int netId, int channels)
 {
-	//trace.funcEntry("EmulNet::EmulNet");
-	int i,j;
+	TRACE_CALL_SPAN("EmulNet::EmulNet", NULL);
+	int i, c;
 	par = p;
+	this->channels = channels;
+	// Node ids handed out by ENinit run from 1 to EN_GPSZ
+	rng.resize((par->EN_GPSZ + 1) * channels);
+	delayRng.resize((par->EN_GPSZ + 1) * channels);
+	egressFree.assign((par->EN_GPSZ + 1) * channels, 0);
+	held.assign(channels, 0);
+	queued.assign((par->EN_GPSZ + 1) * channels, 0);
+	// streams of different networks must not repeat each other's drops,
+	// a channel draws the streams of the network of id netId + channel
+	for ( i = 0; i <= par->EN_GPSZ; i++ ) {
+		for ( c = 0; c < channels; c++ ) {
+			rng[slot(i, c)].seed(par->SEED, RNG_NET, (netId + c) * NET_NODE_STREAMS + i);
+			delayRng[slot(i, c)].seed(par->SEED, RNG_DELAY, (netId + c) * NET_NODE_STREAMS + i);
+		}
+	}
+	nextSeq = 0;
 	emulnet.setNextId(1);
 	emulnet.settCurrBuffSize(0);
+	emulnet.buff.resize((par->EN_GPSZ + 1) * channels);
 	enInited=0;
-	for ( i = 0; i < MAX_NODES; i++ ) {
-		for ( j = 0; j < MAX_TIME; j++ ) {
-			sent_msgs[i][j] = 0;
-			recv_msgs[i][j] = 0;
-		}
+	sched = NULL;
+	recvEvent.assign(channels, EV_MP1_RECV);
+	counts.init(par->EN_GPSZ, channels);
+	for ( c = 1; c < channels; c++ ) {
+		views.push_back(new EmulChannel(this, c));
 	}
-	//trace.funcExit("EmulNet::EmulNet", SUCCESS);
 }
 
 /**
  * Copy constructor
  */
 EmulNet::EmulNet(EmulNet &anotherEmulNet) {
-	int i, j;
 	this->par = anotherEmulNet.par;
 	this->enInited = anotherEmulNet.enInited;
-	for ( i = 0; i < MAX_NODES; i++ ) {
-		for ( j = 0; j < MAX_TIME; j++ ) {
-			this->sent_msgs[i][j] = anotherEmulNet.sent_msgs[i][j];
-			this->recv_msgs[i][j] = anotherEmulNet.recv_msgs[i][j];
-		}
-	}
+	this->channels = anotherEmulNet.channels;
+	this->sched = anotherEmulNet.sched;
+	this->recvEvent = anotherEmulNet.recvEvent;
+	this->rng = anotherEmulNet.rng;
+	this->delayRng = anotherEmulNet.delayRng;
+	this->egressFree = anotherEmulNet.egressFree;
+	this->held = anotherEmulNet.held;
+	this->queued = anotherEmulNet.queued;
+	this->inflight = anotherEmulNet.inflight;
+	this->nextSeq = anotherEmulNet.nextSeq;
+	this->counts = anotherEmulNet.counts;
 	this->emulnet = anotherEmulNet.emulnet;
+	for ( int c = 1; c < channels; c++ ) {
+		views.push_back(new EmulChannel(this, c));
+	}
 }
 
 /**
  * Assignment operator overloading
  */
 EmulNet& EmulNet::operator =(EmulNet &anotherEmulNet) {
-	int i, j;
 	this->par = anotherEmulNet.par;
 	this->enInited = anotherEmulNet.enInited;
-	for ( i = 0; i < MAX_NODES; i++ ) {
-		for ( j = 0; j < MAX_TIME; j++ ) {
-			this->sent_msgs[i][j] = anotherEmulNet.sent_msgs[i][j];
-			this->recv_msgs[i][j] = anotherEmulNet.recv_msgs[i][j];
-		}
-	}
+	this->channels = anotherEmulNet.channels;
+	this->sched = anotherEmulNet.sched;
+	this->recvEvent = anotherEmulNet.recvEvent;
+	this->rng = anotherEmulNet.rng;
+	this->delayRng = anotherEmulNet.delayRng;
+	this->egressFree = anotherEmulNet.egressFree;
+	this->held = anotherEmulNet.held;
+	this->queued = anotherEmulNet.queued;
+	this->inflight = anotherEmulNet.inflight;
+	this->nextSeq = anotherEmulNet.nextSeq;
+	this->counts = anotherEmulNet.counts;
 	this->emulnet = anotherEmulNet.emulnet;
+	for ( unsigned int c = 0; c < views.size(); c++ ) {
+		delete views[c];
+	}
+	views.clear();
+	for ( int c = 1; c < channels; c++ ) {
+		views.push_back(new EmulChannel(this, c));
+	}
 	return *this;
 }
 
 /**
  * Destructor
  */
-EmulNet::~EmulNet() {}
+EmulNet::~EmulNet() {
+	for ( unsigned int c = 0; c < views.size(); c++ ) {
+		delete views[c];
+	}
+}
+
+/**
+ * FUNCTION NAME: channel
+ *
+ * DESCRIPTION: The network as the protocol sending on a channel sees it
+ */
+Network *EmulNet::channel(int id) {
+	assert(id >= 0 && id < channels);
+	return (id == 0) ? (Network *)this : views[id - 1];
+}
 
 /**
  * FUNCTION NAME: ENinit
@@ -76,120 +124,409 @@ void *EmulNet::ENinit(Address *myaddr, short port) {
 	return myaddr;
 }
 
+/**
+ * FUNCTION NAME: load
+ *
+ * DESCRIPTION: Messages of a channel and of the channels before it, from the counts of
+ * 				channel 0 at first on. A channel only competes with itself and the ones
+ * 				coming first, the bulk of a later channel does not hold back an earlier one.
+ */
+int EmulNet::load(vector<int> &counts, int first, int channel) {
+	int sum = 0;
+	for ( int c = 0; c <= channel; c++ ) {
+		sum += counts[first + c];
+	}
+	return sum;
+}
+
+/**
+ * FUNCTION NAME: full
+ *
+ * DESCRIPTION: Whether a message to the node has no room, either in the network or, with
+ * 				INBOX_SIZE set, in the inbox of the node. A node flooded by one sender only
+ * 				loses its own messages instead of the network losing everybody's.
+ */
+bool EmulNet::full(int dst, int channel) {
+	if ( load(held, 0, channel) >= par->BUFFER_SIZE ) {
+		return true;
+	}
+	return par->INBOX_SIZE > 0 && load(queued, slot(dst, 0), channel) >= par->INBOX_SIZE;
+}
+
+/**
+ * FUNCTION NAME: ENcongested
+ *
+ * DESCRIPTION: Whether channel 0 of the node is congested
+ */
+bool EmulNet::ENcongested(Address *toaddr) {
+	return congested(0, toaddr);
+}
+
+/**
+ * FUNCTION NAME: congested
+ *
+ * DESCRIPTION: Whether the network or the inbox of the node is CONGESTION_LEVEL full for
+ * 				the channel
+ *
+ * RETURNS:
+ * true if the node is congested
+ */
+bool EmulNet::congested(int channel, Address *toaddr) {
+	int dst = *(int *)(toaddr->addr);
+
+	if ( (dst < 1) || (dst > par->EN_GPSZ) ) {
+		return false;
+	}
+	if ( load(held, 0, channel) >= par->BUFFER_SIZE * CONGESTION_LEVEL ) {
+		return true;
+	}
+	return par->INBOX_SIZE > 0 && load(queued, slot(dst, 0), channel) >= par->INBOX_SIZE * CONGESTION_LEVEL;
+}
+
 /**
  * FUNCTION NAME: ENsend
  *
- * DESCRIPTION: EmulNet send function
+ * DESCRIPTION: EmulNet send function, on channel 0
  *
  * RETURNS:
  * size
  */
 int EmulNet::ENsend(Address *myaddr, Address *toaddr, char *data, int size) {
+	return send(0, myaddr, toaddr, data, size);
+}
+
+/**
+ * FUNCTION NAME: send
+ *
+ * DESCRIPTION: Send a message on a channel. A message lost to the random drop or to a full
+ * 				inbox is counted against its sender.
+ *
+ * RETURNS:
+ * size
+ */
+int EmulNet::send(int channel, Address *myaddr, Address *toaddr, char *data, int size) {
 	en_msg *em;
-	static char temp[2048];
-	int sendmsg = rand() % 100;
+	int src = *(int *)(myaddr->addr);
+	int dst = *(int *)(toaddr->addr);
+
+	assert(src >= 1 && src <= par->EN_GPSZ);
+
+	// every sender draws from its own stream
+	int sendmsg = rng[slot(src, channel)].nextInt(100);
 
-	if( (emulnet.currbuffsize >= ENBUFFSIZE) || (size + (int)sizeof(en_msg) >= par->MAX_MSG_SIZE) || (par->dropmsg && sendmsg < (int) (par->MSG_DROP_PROB * 100)) ) {
+	if( (dst < 1) || (dst > par->EN_GPSZ) || (size + (int)sizeof(en_msg) >= par->MAX_MSG_SIZE) ) {
+		return 0;
+	}
+	if ( par->dropmsg && sendmsg < (int) (par->MSG_DROP_PROB * 100) ) {
+		counts.countDrop(src, RANDOM_DROP, channel);
+		return 0;
+	}
+	if ( full(dst, channel) ) {
+		counts.countDrop(src, OVERFLOW_DROP, channel);
 		return 0;
 	}
 
 	em = (en_msg *)malloc(sizeof(en_msg) + size);
 	em->size = size;
+	em->channel = channel;
 
 	memcpy(&(em->from.addr), &(myaddr->addr), sizeof(em->from.addr));
 	memcpy(&(em->to.addr), &(toaddr->addr), sizeof(em->from.addr));
 	memcpy(em + 1, data, size);
 
-	emulnet.buff[emulnet.currbuffsize++] = em;
-
-	int src = *(int *)(myaddr->addr);
 	int time = par->getcurrtime();
+	int due = par->linkModel ? arrival(src, dst, sizeof(en_msg) + size, time, channel) : time;
+
+	counts.countSent(src, time, channel);
+	held[channel]++;
+	queued[slot(dst, channel)]++;
+
+	// Node ids handed out by ENinit start at 1
+	if ( due <= time ) {
+		emulnet.buff[slot(dst, channel)].push_back(em);
+		emulnet.currbuffsize++;
+		if ( sched != NULL ) {
+			sched->post(dst - 1, recvEvent[channel]);
+		}
+	}
+	else {
+		InFlight f = { due, nextSeq++, em };
+		inflight.push(f);
+		if ( sched != NULL ) {
+			sched->schedule(due, dst - 1, recvEvent[channel]);
+		}
+	}
 
-	assert(src <= MAX_NODES);
-	assert(time < MAX_TIME);
-
-	sent_msgs[src][time]++;
-
-	#ifdef DEBUGLOG
-		sprintf(temp, "Sending 4+%d B msg type %d to %d.%d.%d.%d:%d ", size-4, *(int *)data, toaddr->addr[0], toaddr->addr[1], toaddr->addr[2], toaddr->addr[3], *(short *)&toaddr->addr[4]);
-	#endif
+	LOG_DEBUG("Sending 4+%d B msg type %d to %d.%d.%d.%d:%d\n", size-4, *(int *)data, toaddr->addr[0], toaddr->addr[1], toaddr->addr[2], toaddr->addr[3], *(short *)&toaddr->addr[4]);
 
 	return size;
 }
 
 /**
- * FUNCTION NAME: ENsend
+ * FUNCTION NAME: ENrecv
  *
- * DESCRIPTION: EmulNet send function
+ * DESCRIPTION: EmulNet receive function, on channel 0
  *
- * RETURNS:
- * size
+ * RETURN:
+ * 0
  */
-int EmulNet::ENsend(Address *myaddr, Address *toaddr, string data) {
-	char * str = (char *) malloc(data.length() * sizeof(char));
-	memcpy(str, data.c_str(), data.size());
-	int ret = this->ENsend(myaddr, toaddr, str, (data.length() * sizeof(char)));
-	free(str);
-	return ret;
+int EmulNet::ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue){
+	// times is always assumed to be 1
+	return recv(0, myaddr, enq, queue);
 }
 
 /**
- * FUNCTION NAME: ENrecv
+ * FUNCTION NAME: recv
  *
- * DESCRIPTION: EmulNet receive function
+ * DESCRIPTION: Hand the messages waiting for the node on a channel to enq
  *
  * RETURN:
  * 0
  */
-int EmulNet::ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue){
-	// times is always assumed to be 1
-	int i;
+int EmulNet::recv(int channel, Address *myaddr, int (* enq)(void *, char *, int), void *queue) {
+	unsigned int i;
 	char* tmp;
 	int sz;
 	en_msg *emsg;
+	int dst = *(int *)(myaddr->addr);
+	int time = par->getcurrtime();
+
+	assert(dst >= 1 && dst <= par->EN_GPSZ);
 
-	for( i = emulnet.currbuffsize - 1; i >= 0; i-- ) {
-		emsg = emulnet.buff[i];
+	// messages whose time has come join the ones waiting to be received
+	while ( !inflight.empty() && inflight.top().due <= time ) {
+		emsg = inflight.top().msg;
+		emulnet.buff[slot(*(int *)(emsg->to.addr), emsg->channel)].push_back(emsg);
+		emulnet.currbuffsize++;
+		inflight.pop();
+	}
 
-		if ( 0 == strcmp(emsg->to.addr, myaddr->addr) ) {
-			sz = emsg->size;
-			tmp = (char *) malloc(sz * sizeof(char));
-			memcpy(tmp, (char *)(emsg+1), sz);
+	// only the messages of this node are looked at, in the order they were sent
+	vector<en_msg *> &mine = emulnet.buff[slot(dst, channel)];
+	for( i = 0; i < mine.size(); i++ ) {
+		emsg = mine[i];
+		sz = emsg->size;
+		tmp = (char *) malloc(sz * sizeof(char));
+		memcpy(tmp, (char *)(emsg+1), sz);
 
-			emulnet.buff[i] = emulnet.buff[emulnet.currbuffsize-1];
-			emulnet.currbuffsize--;
+		(*enq)(queue, (char *)tmp, sz);
 
-			(*enq)(queue, (char *)tmp, sz);
+		free(emsg);
 
-			free(emsg);
+		counts.countRecv(dst, time, channel);
+	}
+	emulnet.currbuffsize -= mine.size();
+	held[channel] -= mine.size();
+	queued[slot(dst, channel)] -= mine.size();
+	mine.clear();
 
-			int dst = *(int *)(myaddr->addr);
-			int time = par->getcurrtime();
+	return 0;
+}
 
-			assert(dst <= MAX_NODES);
-			assert(time < MAX_TIME);
+/**
+ * FUNCTION NAME: sampleDelay
+ *
+ * DESCRIPTION: Draw the delay of a message from the distribution of its link, in whole ticks
+ */
+int EmulNet::sampleDelay(LinkDelay *delay, int src, int channel) {
+	Random &r = delayRng[slot(src, channel)];
+	double d = delay->a;
+
+	if ( delay->type == UNIFORM_DELAY ) {
+		d = delay->a + r.nextInt((uint32_t)(delay->b - delay->a) + 1);
+	}
+	else if ( delay->type == LOGNORMAL_DELAY ) {
+		// Box-Muller, 1 - u keeps the log away from 0
+		double u = 1 - r.nextDouble();
+		double v = r.nextDouble();
+		d = delay->a * exp(delay->b * sqrt(-2 * log(u)) * cos(2 * M_PI * v));
+	}
+	return (d > 0) ? (int)(d + 0.5) : 0;
+}
 
-			recv_msgs[dst][time]++;
+/**
+ * FUNCTION NAME: arrival
+ *
+ * DESCRIPTION: Tick a message sent now arrives in. With an egress cap the message
+ * 				first waits for the bytes queued before it to leave the sender,
+ * 				then it takes the delay of its link. Only the bytes of its channel and of
+ * 				the channels before it are ahead of it, its own bytes push back the
+ * 				channels after it.
+ */
+int EmulNet::arrival(int src, int dst, int bytes, int time, int channel) {
+	int leave = time;
+	int bandwidth = par->getbandwidth(src);
+
+	if ( bandwidth > 0 ) {
+		double busy = (double)bytes / bandwidth;
+		double &free = egressFree[slot(src, channel)];
+		free = max(free, (double)time) + busy;
+		// its last byte goes out in the tick before the link is free again
+		leave = max(time, (int)ceil(free) - 1);
+		for ( int c = channel + 1; c < channels; c++ ) {
+			egressFree[slot(src, c)] = max(egressFree[slot(src, c)], (double)time) + busy;
 		}
 	}
+	return leave + sampleDelay(par->getlinkdelay(src, dst), src, channel);
+}
 
-	return 0;
+/**
+ * FUNCTION NAME: setScheduler
+ *
+ * DESCRIPTION: Post recvEvent to the scheduler for the destination of every message sent
+ * 				on channel 0
+ */
+void EmulNet::setScheduler(Scheduler *sched, EventType recvEvent) {
+	setScheduler(sched, recvEvent, 0);
+}
+
+/**
+ * FUNCTION NAME: setScheduler
+ *
+ * DESCRIPTION: Post recvEvent to the scheduler for the destination of every message sent
+ * 				on a channel
+ */
+void EmulNet::setScheduler(Scheduler *sched, EventType recvEvent, int channel) {
+	this->sched = sched;
+	this->recvEvent[channel] = recvEvent;
+}
+
+/**
+ * FUNCTION NAME: putMessage
+ *
+ * DESCRIPTION: Write a message, header and bytes, to a checkpoint
+ */
+static void putMessage(Checkpoint *ck, en_msg *em) {
+	ck->putLong(em->size);
+	ck->put(em, sizeof(en_msg) + em->size);
+}
+
+/**
+ * FUNCTION NAME: getMessage
+ *
+ * DESCRIPTION: Read back a message written by putMessage
+ */
+static en_msg *getMessage(Checkpoint *ck) {
+	int size = (int)ck->getCount(1);
+	en_msg *em = (en_msg *)malloc(sizeof(en_msg) + size);
+	ck->get(em, sizeof(en_msg) + size);
+	em->size = size;
+	return em;
+}
+
+/**
+ * FUNCTION NAME: checkpoint
+ *
+ * DESCRIPTION: Write the messages waiting to be received and the ones on their way,
+ * 				the random streams and the link state to a checkpoint
+ *
+ * RETURNS:
+ * SUCCESS
+ */
+int EmulNet::checkpoint(Checkpoint *ck) {
+	priority_queue<InFlight, vector<InFlight>, greater<InFlight> > pending(inflight);
+	unsigned int i, j;
+
+	ck->putLong(emulnet.nextid);
+	ck->putLong(emulnet.buff.size());
+	for ( i = 0; i < emulnet.buff.size(); i++ ) {
+		ck->putLong(emulnet.buff[i].size());
+		for ( j = 0; j < emulnet.buff[i].size(); j++ ) {
+			putMessage(ck, emulnet.buff[i][j]);
+		}
+	}
+	ck->putLong(nextSeq);
+	ck->putLong(pending.size());
+	for ( ; !pending.empty(); pending.pop() ) {
+		ck->putLong(pending.top().due);
+		ck->putLong(pending.top().seq);
+		putMessage(ck, pending.top().msg);
+	}
+	// every node has a stream of each and an egress link per channel
+	ck->put(rng.data(), rng.size() * sizeof(Random));
+	ck->put(delayRng.data(), delayRng.size() * sizeof(Random));
+	ck->put(egressFree.data(), egressFree.size() * sizeof(double));
+	counts.checkpoint(ck);
+	return SUCCESS;
+}
+
+/**
+ * FUNCTION NAME: restore
+ *
+ * DESCRIPTION: Read back the network written by checkpoint, into a network of as many nodes
+ * 				and channels
+ *
+ * RETURNS:
+ * SUCCESS or FAILURE
+ */
+int EmulNet::restore(Checkpoint *ck) {
+	size_t i, n;
+	int dst;
+	en_msg *emsg;
+
+	emulnet.nextid = (int)ck->getLong();
+	if ( ck->getCount(sizeof(long)) != emulnet.buff.size() ) {
+		return FAILURE;
+	}
+	emulnet.currbuffsize = 0;
+	held.assign(channels, 0);
+	queued.assign(queued.size(), 0);
+	for ( i = 0; i < emulnet.buff.size(); i++ ) {
+		for ( n = ck->getCount(sizeof(long) + sizeof(en_msg)); n > 0; n-- ) {
+			emulnet.buff[i].push_back(getMessage(ck));
+			emulnet.currbuffsize++;
+			held[i % channels]++;
+			queued[i]++;
+		}
+	}
+	nextSeq = ck->getLong();
+	for ( n = ck->getCount(3 * sizeof(long) + sizeof(en_msg)); n > 0; n-- ) {
+		InFlight f;
+		f.due = (int)ck->getLong();
+		f.seq = ck->getLong();
+		f.msg = emsg = getMessage(ck);
+		dst = *(int *)(emsg->to.addr);
+		if ( dst < 1 || dst > par->EN_GPSZ || emsg->channel < 0 || emsg->channel >= channels ) {
+			free(emsg);
+			return FAILURE;
+		}
+		inflight.push(f);
+		held[emsg->channel]++;
+		queued[slot(dst, emsg->channel)]++;
+	}
+	ck->get(rng.data(), rng.size() * sizeof(Random));
+	ck->get(delayRng.data(), delayRng.size() * sizeof(Random));
+	ck->get(egressFree.data(), egressFree.size() * sizeof(double));
+	counts.restore(ck);
+	return ck->ok() ? SUCCESS : FAILURE;
 }
 
 /**
  * FUNCTION NAME: ENcleanup
  *
  * DESCRIPTION: Cleanup the EmulNet. Called exactly once at the end of the program.
+ * 				The counts of msgcount.log are those of all channels, with the totals of
+ * 				every channel after them when there are several.
  */
 int EmulNet::ENcleanup() {
 	emulnet.nextid=0;
-	int i, j;
+	int i, j, c;
 	int sent_total, recv_total;
 
 	FILE* file = fopen("msgcount.log", "w+");
 
-	while(emulnet.currbuffsize > 0) {
-		free(emulnet.buff[--emulnet.currbuffsize]);
+	for ( i = 0; i < (int)emulnet.buff.size(); i++ ) {
+		for ( j = 0; j < (int)emulnet.buff[i].size(); j++ ) {
+			free(emulnet.buff[i][j]);
+		}
+		emulnet.buff[i].clear();
+	}
+	emulnet.currbuffsize = 0;
+	held.assign(channels, 0);
+	queued.assign(queued.size(), 0);
+	while ( !inflight.empty() ) {
+		free(inflight.top().msg);
+		inflight.pop();
 	}
 
 	for ( i = 1; i <= par->EN_GPSZ; i++ ) {
@@ -199,20 +536,26 @@ int EmulNet::ENcleanup() {
 
 		for (j = 0; j < par->getcurrtime(); j++) {
 
-			sent_total += sent_msgs[i][j];
-			recv_total += recv_msgs[i][j];
+			sent_total += counts.getSent(i, j);
+			recv_total += counts.getRecv(i, j);
 			if (i != 67) {
-				fprintf(file, " (%4d, %4d)", sent_msgs[i][j], recv_msgs[i][j]);
+				fprintf(file, " (%4d, %4d)", counts.getSent(i, j), counts.getRecv(i, j));
 				if (j % 10 == 9) {
 					fprintf(file, "\n         ");
 				}
 			}
 			else {
-				fprintf(file, "special %4d %4d %4d\n", j, sent_msgs[i][j], recv_msgs[i][j]);
+				fprintf(file, "special %4d %4d %4d\n", j, counts.getSent(i, j), counts.getRecv(i, j));
 			}
 		}
 		fprintf(file, "\n");
-		fprintf(file, "node %3d sent_total %6u  recv_total %6u\n\n", i, sent_total, recv_total);
+		fprintf(file, "node %3d sent_total %6u  recv_total %6u  dropped_total %6ld  overflow_total %6ld\n", i, sent_total, recv_total,
+				counts.getDrops(i, RANDOM_DROP), counts.getDrops(i, OVERFLOW_DROP));
+		for ( c = 0; channels > 1 && c < channels; c++ ) {
+			fprintf(file, "node %3d channel %d sent %6ld  recv %6ld  dropped %6ld  overflow %6ld\n", i, c, counts.getChannelSent(i, c),
+					counts.getChannelRecv(i, c), counts.getDrops(i, RANDOM_DROP, c), counts.getDrops(i, OVERFLOW_DROP, c));
+		}
+		fprintf(file, "\n");
 	}
 
 	fclose(file);
@@ -0,0 +1,162 @@
+/**********************************
+ * FILE NAME: EventTrace.cpp
+ *
+ * DESCRIPTION: Binary event trace definition
+ **********************************/
+
+#include "EventTrace.h"
+
+/**
+ * Constructor
+ */
+EventTrace::EventTrace(const char *binName, const char *strName, Params *par) {
+	const char *names[2] = { binName, strName };
+	TraceHeader *header;
+	int i;
+
+	for ( i = 0; i < 2; i++ ) {
+		fd[i] = open(names[i], O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+		if ( fd[i] < 0 ) {
+			perror(names[i]);
+			exit(1);
+		}
+		base[i] = NULL;
+		mapped[i] = 0;
+		used[i] = 0;
+	}
+
+	reserve(0, sizeof(TraceHeader));
+	header = (TraceHeader *)base[0];
+	strcpy(header->magic, TRACE_MAGIC);
+	header->version = TRACE_VERSION;
+	header->recordSize = sizeof(TraceRecord);
+	header->records = 0;
+	header->nodes = par->EN_GPSZ;
+	header->nodeProcess = par->nodeProcess;
+	used[0] = sizeof(TraceHeader);
+
+	// offset 0 of the strings stands for none
+	reserve(1, 1);
+	used[1] = 1;
+}
+
+/**
+ * Destructor. Cuts the files down to what was written.
+ */
+EventTrace::~EventTrace() {
+	for ( int i = 0; i < 2; i++ ) {
+		munmap(base[i], mapped[i]);
+		if ( ftruncate(fd[i], used[i]) < 0 ) {
+			perror("ftruncate");
+		}
+		close(fd[i]);
+	}
+}
+
+/**
+ * FUNCTION NAME: reserve
+ *
+ * DESCRIPTION: Make room for bytes more in the file, growing it TRACE_GROW at a time
+ */
+void EventTrace::reserve(int file, size_t bytes) {
+	size_t size = mapped[file];
+
+	if ( used[file] + bytes <= size ) {
+		return;
+	}
+	while ( used[file] + bytes > size ) {
+		size += TRACE_GROW;
+	}
+	if ( ftruncate(fd[file], size) < 0 ) {
+		perror("ftruncate");
+		exit(1);
+	}
+	if ( base[file] == NULL ) {
+		base[file] = (char *) mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd[file], 0);
+	}
+	else {
+		base[file] = (char *) mremap(base[file], mapped[file], size, MREMAP_MAYMOVE);
+	}
+	if ( base[file] == MAP_FAILED ) {
+		perror("mmap");
+		exit(1);
+	}
+	mapped[file] = size;
+}
+
+/**
+ * FUNCTION NAME: addString
+ *
+ * DESCRIPTION: Append a string and its terminating zero to trace.str
+ *
+ * RETURNS:
+ * offset of the string
+ */
+uint32_t EventTrace::addString(const char *s) {
+	size_t len = strlen(s) + 1;
+	uint32_t off = used[1];
+
+	reserve(1, len);
+	memcpy(base[1] + off, s, len);
+	used[1] += len;
+	return off;
+}
+
+/**
+ * FUNCTION NAME: record
+ *
+ * DESCRIPTION: Append the event the node logged at time, with the text of the line if any
+ */
+void EventTrace::record(int time, Address *node, TraceEvent *ev, const char *text) {
+	TraceRecord *rec;
+	uint32_t str = 0;
+	int flags = ev->flags;
+	lock_guard<mutex> guard(lock);
+
+	if ( ev->key != NULL ) {
+		str = addString(ev->key);
+		flags |= TRF_KEY;
+	}
+	if ( ev->value != NULL ) {
+		str = (str != 0) ? str : used[1];
+		addString(ev->value);
+		flags |= TRF_VALUE;
+	}
+	if ( text != NULL ) {
+		str = (str != 0) ? str : used[1];
+		addString(text);
+		flags |= TRF_TEXT;
+	}
+
+	reserve(0, sizeof(TraceRecord));
+	rec = (TraceRecord *)(base[0] + used[0]);
+	memset(rec, 0, sizeof(TraceRecord));
+	rec->time = time;
+	rec->node = *(int *)(node->addr);
+	rec->nodePort = *(short *)(&node->addr[4]);
+	if ( ev->peer != NULL ) {
+		rec->peer = *(int *)(ev->peer->addr);
+		rec->peerPort = *(short *)(&ev->peer->addr[4]);
+	}
+	rec->transID = ev->transID;
+	rec->keyHash = (ev->key != NULL) ? keyHash(ev->key) : 0;
+	rec->str = str;
+	rec->type = ev->type;
+	rec->flags = flags;
+	used[0] += sizeof(TraceRecord);
+
+	((TraceHeader *)base[0])->records++;
+}
+
+/**
+ * FUNCTION NAME: keyHash
+ *
+ * DESCRIPTION: 32 bit FNV-1a hash of a key
+ */
+uint32_t EventTrace::keyHash(const char *key) {
+	uint32_t h = 2166136261u;
+	for ( ; *key; key++ ) {
+		h = (h ^ (unsigned char)*key) * 16777619u;
+	}
+	return h;
+}
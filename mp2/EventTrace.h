@@ -0,0 +1,130 @@
+/**********************************
+ * FILE NAME: EventTrace.h
+ *
+ * DESCRIPTION: Binary event trace header file
+ **********************************/
+
+#ifndef _EVENTTRACE_H_
+#define _EVENTTRACE_H_
+
+#include <sys/mman.h>
+#include <mutex>
+#include "stdincludes.h"
+#include "Params.h"
+#include "Member.h"
+
+/*
+ * Macros
+ */
+#define TRACE_MAGIC "MPTRACE"
+#define TRACE_VERSION 1
+#define TRACE_BIN "trace.bin"
+#define TRACE_STR "trace.str"
+// bytes the files grow by when full
+#define TRACE_GROW (16 << 20)
+
+/**
+ * Event Types, the KV store operations in the order of MessageType
+ */
+enum TraceEventType {
+	TR_MAGIC,		// magic number line at the top of dbg.log, in transID
+	TR_TEXT,		// free text line of dbg.log
+	TR_STATS,		// free text line of stats.log
+	TR_NODE_FAIL,	// the application failed the node
+	TR_NODE_ADD,	// node added peer to its membership list
+	TR_NODE_REMOVE,	// node removed peer from its membership list
+	TR_CREATE,
+	TR_READ,
+	TR_UPDATE,
+	TR_DELETE,
+	TR_TYPES
+};
+
+/**
+ * Event Flags
+ */
+#define TRF_NOADDR 0x01			// rendered without the address of the node
+#define TRF_COORDINATOR 0x02	// KV outcome logged by the coordinator, not a replica
+#define TRF_SUCCESS 0x04		// KV outcome is a success
+#define TRF_REQUEST 0x08		// KV transaction opened by a coordinator, not in dbg.log
+#define TRF_KEY 0x10			// strings of the record start with the key
+#define TRF_VALUE 0x20			// then the value
+#define TRF_TEXT 0x40			// then the text
+
+/**
+ * STRUCT NAME: TraceHeader
+ *
+ * DESCRIPTION: First bytes of trace.bin, the records follow
+ */
+typedef struct TraceHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t recordSize;
+	// records written so far, kept up to date so that a trace cut short is readable
+	uint64_t records;
+	int32_t nodes;
+	int32_t nodeProcess;
+	char pad[32];
+}TraceHeader;
+
+/**
+ * STRUCT NAME: TraceRecord
+ *
+ * DESCRIPTION: Fixed size event record
+ */
+typedef struct TraceRecord {
+	int32_t time;
+	int32_t node;
+	int32_t peer;
+	int32_t transID;
+	uint32_t keyHash;
+	// offset of the strings of the record in trace.str, 0 for none
+	uint32_t str;
+	int16_t nodePort;
+	int16_t peerPort;
+	uint8_t type;
+	uint8_t flags;
+	uint16_t pad;
+}TraceRecord;
+
+/**
+ * STRUCT NAME: TraceEvent
+ *
+ * DESCRIPTION: What a caller knows about an event, NULL for what does not apply
+ */
+typedef struct TraceEvent {
+	int type;
+	int flags;
+	Address *peer;
+	int transID;
+	const char *key;
+	const char *value;
+}TraceEvent;
+
+/**
+ * CLASS NAME: EventTrace
+ *
+ * DESCRIPTION: Writes the events of a run as fixed size records to trace.bin
+ * 				and their strings to trace.str, both through memory maps.
+ * 				A node process writes node<id>.trace.bin and node<id>.trace.str.
+ */
+class EventTrace {
+private:
+	int fd[2];
+	char *base[2];
+	size_t mapped[2];
+	size_t used[2];
+	// the threads of the process share the files
+	mutex lock;
+	void reserve(int file, size_t bytes);
+	uint32_t addString(const char *s);
+	EventTrace(EventTrace &anotherEventTrace);
+	EventTrace& operator = (EventTrace &anotherEventTrace);
+public:
+	EventTrace(const char *binName, const char *strName, Params *par);
+	virtual ~EventTrace();
+	void record(int time, Address *node, TraceEvent *ev, const char *text);
+	static uint32_t keyHash(const char *key);
+};
+
+#endif /* _EVENTTRACE_H_ */
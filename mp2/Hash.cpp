@@ -0,0 +1,78 @@
+/**********************************
+ * FILE NAME: Hash.cpp
+ *
+ * DESCRIPTION: Hash of the ring positions definition
+ **********************************/
+
+#include "Hash.h"
+
+/**
+ * FUNCTION NAME: mum
+ *
+ * DESCRIPTION: 64 x 64 bit multiply folded to 64 bits, the mixing step of wyhash
+ */
+static inline uint64_t mum(uint64_t a, uint64_t b) {
+	__uint128_t r = (__uint128_t)a * b;
+	return (uint64_t)r ^ (uint64_t)(r >> 64);
+}
+
+/**
+ * FUNCTION NAME: read64
+ *
+ * DESCRIPTION: 8 bytes at p, unaligned
+ */
+static inline uint64_t read64(const uint8_t *p) {
+	uint64_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+/**
+ * FUNCTION NAME: read32
+ *
+ * DESCRIPTION: 4 bytes at p, unaligned
+ */
+static inline uint64_t read32(const uint8_t *p) {
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+/**
+ * FUNCTION NAME: ringHash
+ *
+ * DESCRIPTION: 64 bit hash of len bytes, wyhash style: every 16 bytes are folded into the
+ * 				state with one multiply, the last 16 bytes (or all of them for short inputs,
+ * 				which is every address and most keys) decide the result with two more.
+ * 				All the bytes count, zeros included. Not cryptographic.
+ */
+uint64_t ringHash(const void *data, size_t len, uint64_t seed) {
+	const uint8_t *p = (const uint8_t *)data;
+	uint64_t a, b;
+
+	seed ^= mum(seed ^ HASH_P0, HASH_P1);
+	if ( len <= 16 ) {
+		if ( len >= 4 ) {
+			a = (read32(p) << 32) | read32(p + ((len >> 3) << 2));
+			b = (read32(p + len - 4) << 32) | read32(p + len - 4 - ((len >> 3) << 2));
+		}
+		else if ( len > 0 ) {
+			a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+			b = 0;
+		}
+		else {
+			a = b = 0;
+		}
+	}
+	else {
+		size_t i = len;
+		while ( i > 16 ) {
+			seed = mum(read64(p) ^ HASH_P1, read64(p + 8) ^ seed);
+			p += 16;
+			i -= 16;
+		}
+		a = read64(p + i - 16);
+		b = read64(p + i - 8);
+	}
+	return mum(HASH_P1 ^ len, mum(a ^ HASH_P1, b ^ seed ^ HASH_P2));
+}
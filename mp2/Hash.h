@@ -0,0 +1,33 @@
+/**********************************
+ * FILE NAME: Hash.h
+ *
+ * DESCRIPTION: Hash of the ring positions header file
+ **********************************/
+
+#ifndef _HASH_H_
+#define _HASH_H_
+
+#include "stdincludes.h"
+
+/*
+ * Macros
+ */
+// constants of wyhash, odd with half of the bits set in every byte
+#define HASH_P0 0xa0761d6478bd642fULL
+#define HASH_P1 0xe7037ed1a0b428dbULL
+#define HASH_P2 0x8ebc6af09c88c6e3ULL
+// seed of the ring, every node has to place nodes and keys alike
+#define HASH_SEED 0x5851f42d4c957f2dULL
+
+uint64_t ringHash(const void *data, size_t len, uint64_t seed = HASH_SEED);
+
+/**
+ * FUNCTION NAME: ringHash
+ *
+ * DESCRIPTION: Position on the ring of a key
+ */
+inline uint64_t ringHash(const string &key) {
+	return ringHash(key.data(), key.size());
+}
+
+#endif /* _HASH_H_ */
@@ -0,0 +1,167 @@
+/**********************************
+ * FILE NAME: HashBench.cpp
+ *
+ * DESCRIPTION: Throughput of the ring hash and balance of the ring it builds, against
+ * 				std::hash over the address as a C string reduced modulo 512 as the ring
+ * 				was built before.
+ **********************************/
+
+#include "stdincludes.h"
+#include "Member.h"
+#include "Node.h"
+#include "Hash.h"
+
+/*
+ * Macros
+ */
+// positions of the old ring
+#define OLD_RING_SIZE 512
+
+/**
+ * FUNCTION NAME: nowSec
+ *
+ * DESCRIPTION: Monotonic clock in seconds
+ */
+static double nowSec() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * FUNCTION NAME: nodeAddress
+ *
+ * DESCRIPTION: Address of node id, as the network hands them out
+ */
+static Address nodeAddress(int id) {
+	Address address;
+	address.init();
+	memcpy(&address.addr[0], &id, sizeof(int));
+	return address;
+}
+
+/**
+ * FUNCTION NAME: oldPosition
+ *
+ * DESCRIPTION: Position of a node on the old ring
+ */
+static uint64_t oldPosition(Address &address) {
+	return std::hash<string>()(address.addr) % OLD_RING_SIZE;
+}
+
+/**
+ * FUNCTION NAME: benchHash
+ *
+ * DESCRIPTION: Nanoseconds per hash of the keys with both hashes
+ */
+static void benchHash(const char *name, vector<string> &keys, int rounds) {
+	std::hash<string> stdHash;
+	uint64_t sum = 0;
+	double start, mid, end;
+	size_t bytes = 0;
+	int r;
+
+	for ( unsigned int i = 0; i < keys.size(); i++ ) {
+		bytes += keys[i].size();
+	}
+	start = nowSec();
+	for ( r = 0; r < rounds; r++ ) {
+		for ( unsigned int i = 0; i < keys.size(); i++ ) {
+			sum += stdHash(keys[i]);
+		}
+	}
+	mid = nowSec();
+	for ( r = 0; r < rounds; r++ ) {
+		for ( unsigned int i = 0; i < keys.size(); i++ ) {
+			sum += ringHash(keys[i]);
+		}
+	}
+	end = nowSec();
+
+	double n = (double)keys.size() * rounds;
+	printf("%-22s %12.1f %10.0f %12.1f %10.0f   (%llx)\n", name, (mid - start) / n * 1e9, bytes * rounds / (mid - start) / 1e6,
+			(end - mid) / n * 1e9, bytes * rounds / (end - mid) / 1e6, (unsigned long long)(sum & 0xffff));
+}
+
+/**
+ * FUNCTION NAME: balance
+ *
+ * DESCRIPTION: Distinct positions of the nodes and the keys per node, owner being the first
+ * 				node at or after the key as in MP2Node::findNodes
+ */
+static void balance(const char *name, vector<uint64_t> &nodes, vector<uint64_t> &keys) {
+	vector<uint64_t> ring(nodes);
+	vector<long> owned;
+	long most = 0, empty = 0;
+	double mean, var = 0;
+
+	sort(ring.begin(), ring.end());
+	size_t distinct = unique(ring.begin(), ring.end()) - ring.begin();
+	ring.resize(distinct);
+	owned.assign(ring.size(), 0);
+	for ( unsigned int k = 0; k < keys.size(); k++ ) {
+		size_t i = lower_bound(ring.begin(), ring.end(), keys[k]) - ring.begin();
+		owned[(i == ring.size()) ? 0 : i]++;
+	}
+	// nodes sharing a position share its keys, the first of them gets them all
+	owned.resize(nodes.size(), 0);
+	mean = (double)keys.size() / nodes.size();
+	for ( unsigned int i = 0; i < owned.size(); i++ ) {
+		most = max(most, owned[i]);
+		empty += (owned[i] == 0);
+		var += (owned[i] - mean) * (owned[i] - mean);
+	}
+	printf("%-6s %8zu %10zu %10zu %10.1f %8ld %8.2f %8ld\n", name, nodes.size(), distinct, nodes.size() - distinct,
+			mean, most, sqrt(var / owned.size()) / mean, empty);
+}
+
+/**********************************
+ * FUNCTION NAME: main
+ *
+ * DESCRIPTION: main function. Usage: ./HashBench [keys] [rounds]
+ * 				Hash throughput over addresses and keys of a few sizes, then the balance of the
+ * 				old and the new ring at a few group sizes.
+ **********************************/
+int main(int argc, char *argv[]) {
+	int keyCount = (argc > 1) ? atoi(argv[1]) : 100000;
+	int rounds = (argc > 2) ? atoi(argv[2]) : 20;
+	static const int groupSizes[] = { 10, 100, 1000, 10000 };
+	vector<string> addresses, shortKeys, longKeys;
+	vector<uint64_t> keyPositions, oldKeyPositions;
+
+	if ( keyCount <= 0 || rounds <= 0 ) {
+		cout<<"Usage: ./HashBench [keys] [rounds]"<<endl;
+		return FAILURE;
+	}
+
+	for ( int i = 0; i < keyCount; i++ ) {
+		Address address = nodeAddress(i + 1);
+		addresses.push_back(string(address.addr, sizeof(address.addr)));
+		shortKeys.push_back("key" + to_string(i));
+		longKeys.push_back(string(100, 'v') + to_string(i));
+	}
+
+	printf("%-22s %12s %10s %12s %10s\n", "", "std ns/hash", "std MB/s", "ring ns/hash", "ring MB/s");
+	benchHash("addresses (6 B)", addresses, rounds);
+	benchHash("keys (4-9 B)", shortKeys, rounds);
+	benchHash("values (101-106 B)", longKeys, rounds);
+
+	for ( int i = 0; i < keyCount; i++ ) {
+		keyPositions.push_back(ringHash(shortKeys[i]));
+		oldKeyPositions.push_back(std::hash<string>()(shortKeys[i]) % OLD_RING_SIZE);
+	}
+	printf("\n%d keys, owner is the first node at or after the key\n", keyCount);
+	printf("%-6s %8s %10s %10s %10s %8s %8s %8s\n", "ring", "nodes", "positions", "collisions", "keys/node", "most", "stddev", "no keys");
+	for ( unsigned int g = 0; g < sizeof(groupSizes) / sizeof(groupSizes[0]); g++ ) {
+		vector<uint64_t> oldNodes, newNodes;
+		for ( int id = 1; id <= groupSizes[g]; id++ ) {
+			Address address = nodeAddress(id);
+			oldNodes.push_back(oldPosition(address));
+			newNodes.push_back(Node(address).getHashCode());
+		}
+		balance("old", oldNodes, oldKeyPositions);
+		balance("new", newNodes, keyPositions);
+	}
+
+	return SUCCESS;
+}
@@ -19,8 +19,10 @@ HashTable::~HashTable() {}
  * true on SUCCESS
  * false in FAILURE
  */
-bool HashTable::create(string key, string value) {
-	hashTable.emplace(key, value);
+bool HashTable::create(string key, string value, long version) {
+	if ( hashTable.emplace(key, value).second ) {
+		versionTable[key] = version;
+	}
 	return true;
 }
 
@@ -47,6 +49,20 @@ string HashTable::read(string key) {
 	}
 }
 
+/**
+ * FUNCTION NAME: version
+ *
+ * DESCRIPTION: This function returns the version of the value of the key
+ *
+ * RETURNS:
+ * version of the value, -1 if the key is not found
+ */
+long HashTable::version(string key) {
+	map<string, long>::iterator search = versionTable.find(key);
+
+	return search != versionTable.end() ? search->second : -1;
+}
+
 /**
  * FUNCTION NAME: update
  *
@@ -57,7 +73,7 @@ string HashTable::read(string key) {
  * true on SUCCESS
  * false on FAILURE
  */
-bool HashTable::update(string key, string newValue) {
+bool HashTable::update(string key, string newValue, long version) {
 	map<string, string>::iterator update;
 
 	if (read(key).empty()) {
@@ -67,10 +83,32 @@ bool HashTable::update(string key, string newValue) {
 	// Key found
 	//update = hashTable.at(key) = newValue;
 	hashTable.at(key) = newValue;
+	versionTable[key] = version;
 	// Update successful
 	return true;
 }
 
+/**
+ * FUNCTION NAME: write
+ *
+ * DESCRIPTION: This function inserts the key, or replaces its value if the given version
+ * 				is newer than the one in the table
+ *
+ * RETURNS:
+ * true if the value was written
+ * false if the table already holds this version or a newer one
+ */
+bool HashTable::write(string key, string value, long version) {
+	map<string, long>::iterator search = versionTable.find(key);
+
+	if ( search != versionTable.end() && search->second >= version ) {
+		return false;
+	}
+	hashTable[key] = value;
+	versionTable[key] = version;
+	return true;
+}
+
 /**
  * FUNCTION NAME: deleteKey
  *
@@ -88,6 +126,7 @@ bool HashTable::deleteKey(string key) {
 		return false;
 	}
 	eraseCount = hashTable.erase(key);
+	versionTable.erase(key);
 	if ( eraseCount < 1 ) {
 		// Could not erase
 		return false;
@@ -128,6 +167,7 @@ unsigned long HashTable::currentSize() {
  */
 void HashTable::clear() {
 	hashTable.clear();
+	versionTable.clear();
 }
 
 /**
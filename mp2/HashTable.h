@@ -18,16 +18,19 @@
  * CLASS NAME: HashTable
  *
  * DESCRIPTION: This class is a wrapper to the map provided by C++ STL.
- *
+ * 				Every key also has the version of the write that put its value there.
  */
 class HashTable {
 public:
 	map<string, string> hashTable;
+	map<string, long> versionTable;
 //public:
 	HashTable();
-	bool create(string key, string value);
+	bool create(string key, string value, long version = 0);
 	string read(string key);
-	bool update(string key, string newValue);
+	long version(string key);
+	bool update(string key, string newValue, long version = 0);
+	bool write(string key, string value, long version);
 	bool deleteKey(string key);
 	bool isEmpty();
 	unsigned long currentSize();
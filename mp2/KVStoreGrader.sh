@@ -8,6 +8,11 @@
 # RUN PROCEDURE:
 # $ chmod +x KVStoreGrader.sh
 # $ ./KVStoreGrader.sh
+#
+# To run the tests over real sockets:
+# $ TRANSPORT=udp ./KVStoreGrader.sh
+# or over shared memory rings:
+# $ TRANSPORT=shm ./KVStoreGrader.sh
 #################################################
 
 function contains () {
@@ -69,7 +74,7 @@ then
     	echo "COMPILATION ERROR !!!"
     	exit
     fi
-    ./Application ./testcases/create.conf > /dev/null 2>&1
+    ./Application ./testcases/create.conf $TRANSPORT > /dev/null 2>&1
 else
 	make clean
 	make
@@ -78,7 +83,7 @@ else
     	echo "COMPILATION ERROR !!!"
     	exit
     fi
-	./Application ./testcases/create.conf
+	./Application ./testcases/create.conf $TRANSPORT
 fi
 
 echo "TEST 1: Create 3 replicas of every key"
@@ -139,7 +144,7 @@ then
     	echo "COMPILATION ERROR !!!"
     	exit
     fi
-    ./Application ./testcases/delete.conf > /dev/null 2>&1
+    ./Application ./testcases/delete.conf $TRANSPORT > /dev/null 2>&1
 else
 	make clean
 	make
@@ -148,7 +153,7 @@ else
     	echo "COMPILATION ERROR !!!"
     	exit
     fi
-	./Application ./testcases/delete.conf
+	./Application ./testcases/delete.conf $TRANSPORT
 fi
 
 echo "TEST 1: Delete 3 replicas of every key"
@@ -237,7 +242,7 @@ then
     	echo "COMPILATION ERROR !!!"
     	exit
     fi
-    ./Application ./testcases/read.conf > /dev/null 2>&1
+    ./Application ./testcases/read.conf $TRANSPORT > /dev/null 2>&1
 else
 	make clean
 	make
@@ -246,7 +251,7 @@ else
     	echo "COMPILATION ERROR !!!"
     	exit
     fi
-	./Application ./testcases/read.conf
+	./Application ./testcases/read.conf $TRANSPORT
 fi
 
 read_operations=`grep -i "${READ_OPERATION}" dbg.log  | cut -d" " -f3 | tr -s ']' ' '  | tr -s '[' ' ' | sort`
@@ -445,7 +450,7 @@ then
     	echo "COMPILATION ERROR !!!"
     	exit
     fi
-    ./Application ./testcases/update.conf > /dev/null 2>&1
+    ./Application ./testcases/update.conf $TRANSPORT > /dev/null 2>&1
 else
 	make clean
 	make
@@ -454,7 +459,7 @@ else
     	echo "COMPILATION ERROR !!!"
     	exit
     fi
-	./Application ./testcases/update.conf
+	./Application ./testcases/update.conf $TRANSPORT
 fi
 
 update_operations=`grep -i "${UPDATE_OPERATION}" dbg.log  | cut -d" " -f3 | tr -s ']' ' '  | tr -s '[' ' ' | sort`
@@ -7,33 +7,104 @@
 #ifndef _LOG_H_
 #define _LOG_H_
 
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include "stdincludes.h"
 #include "Params.h"
 #include "Member.h"
+#include "EventTrace.h"
 
 /*
  * Macros
  */
-// number of writes after which to flush file
-#define MAXWRITES 1
 #define MAGIC_NUMBER "CS425"
 #define DBG_LOG "dbg.log"
 #define STATS_LOG "stats.log"
+// bytes of the buffers records are formatted into, handed to the writer thread once full
+#define LOG_CHUNK_SIZE (256 * 1024)
+// largest record
+#define LOG_RECORD_SIZE 30000
+// ms the writer thread sleeps when nobody wakes it up
+#define LOG_IDLE_MS 100
+
+enum logFILE { LOG_DBG, LOG_STATS, LOG_FILES };
+
+/**
+ * STRUCT NAME: LogChunk
+ *
+ * DESCRIPTION: Records of one thread for one log file, in the order they were logged
+ */
+typedef struct LogChunk {
+	atomic<LogChunk *> next;
+	int file;
+	int size;
+	char data[LOG_CHUNK_SIZE];
+}LogChunk;
+
+/**
+ * CLASS NAME: LogWriter
+ *
+ * DESCRIPTION: Background thread writing the chunks of records to the log files.
+ * 				Threads hand their chunks over through a lock-free multi producer single consumer
+ * 				queue, the writer only takes a lock to sleep when the queue is empty.
+ */
+class LogWriter {
+private:
+	FILE *files[LOG_FILES];
+	// producers exchange head, the writer consumes at tail, stub keeps the queue from being empty
+	atomic<LogChunk *> head;
+	LogChunk *tail;
+	LogChunk *stub;
+	atomic<bool> sleeping;
+	atomic<bool> stopping;
+	mutex lock;
+	condition_variable wakeup;
+	thread worker;
+	void enqueue(LogChunk *chunk);
+	LogChunk *dequeue();
+	bool empty();
+	void run();
+	LogWriter(LogWriter &anotherLogWriter);
+	LogWriter& operator = (LogWriter &anotherLogWriter);
+public:
+	LogWriter(const char *dbgName, const char *statsName);
+	virtual ~LogWriter();
+	void push(LogChunk *chunk);
+};
 
 /**
  * CLASS NAME: Log
  *
- * DESCRIPTION: Functions to log messages in a debug log
+ * DESCRIPTION: Functions to log messages in a debug log.
+ * 				Records are formatted into buffers of the logging thread and written
+ * 				by the writer thread shared by all the Logs of the process.
+ * 				Everything logged is on disk once the last Log is deleted.
+ * 				With EVENT_TRACE set, every record also goes to the binary event trace.
  */
 class Log{
 private:
 	Params *par;
 	bool firstTime;
+	static LogWriter *writer;
+	static int users;
+	// binary event trace of the process, NULL unless EVENT_TRACE is set
+	static EventTrace *trace;
+	// whether anything was logged yet, the very first record of the process carries no address
+	static bool addressed;
+	// chunks being filled by this thread
+	static thread_local LogChunk *chunks[LOG_FILES];
+	LogChunk *chunkFor(int file);
+	void append(int file, const char *format, ...);
+	void appendRecord(int file, const char *addr, int time, const char *record, int len);
+	void write(Address *addr, TraceEvent *ev, const char *record, int len);
 public:
 	Log(Params *p);
 	Log(const Log &anotherLog);
 	Log& operator = (const Log &anotherLog);
 	virtual ~Log();
+	void flush();
 	void LOG(Address *, const char * str, ...);
 	void logNodeAdd(Address *, Address *);
 	void logNodeRemove(Address *, Address *);
@@ -47,6 +118,8 @@ public:
 	void logReadFail(Address * address, bool isCoordinator, int transID, string key);
 	void logUpdateFail(Address * address, bool isCoordinator, int transID, string key, string newValue);
 	void logDeleteFail(Address * address, bool isCoordinator, int transID, string key);
+	// trace only
+	void logRequest(Address * address, int type, int transID, string key);
 };
 
 #endif /* _LOG_H_ */
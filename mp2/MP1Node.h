@@ -12,14 +12,21 @@
 #include "Log.h"
 #include "Params.h"
 #include "Member.h"
-#include "EmulNet.h"
+#include "Network.h"
 #include "Queue.h"
+#include "Trace.h"
 
 /**
  * Macros
  */
 #define TREMOVE 5
 #define TFAIL 2
+// ticks to wait for a JOINREP before asking the next introducer
+#define TJOIN 10
+// member entries of the gossip riding on a message of the KV store
+#define PIGGYBACK_MEMBERS 4
+// ticks a member that got such gossip goes without a PING
+#define PIGGYBACK_TICKS 1
 
 /*
  * Note: You can change/add any functions in MP1Node.{h,cpp}
@@ -37,7 +44,9 @@ enum MsgTypes{
 /**
  * STRUCT NAME: MessageHdr
  *
- * DESCRIPTION: Header and content of a message
+ * DESCRIPTION: Header and content of a message.
+ * 				The countMembers entries are sent right after the header,
+ * 				members points at them once the message is received.
  */
 typedef struct MessageHdr {
 	enum MsgTypes msgType;
@@ -53,23 +62,39 @@ typedef struct MessageHdr {
  */
 class MP1Node {
 private:
-	EmulNet *emulNet;
+	Network *emulNet;
 	Log *log;
 	Params *par;
 	Member *memberNode;
 	char NULLADDR[6];
-	MessageHdr * createMessage(MsgTypes t);
+	// JOINREQs of this tick, answered with one JOINREP once the queue is empty
+	vector<Address> pendingJoins;
+	// JOINREQs sent before this one and the tick the last one went out, -1 before the first
+	int joinAttempts;
+	int joinSentAt;
+	// tick gossip last rode on a message to every node id, -1 if never
+	vector<int> piggybackSentAt;
+	// entry of the list the next piggybacked gossip starts at
+	int piggybackNext;
+	MessageHdr * createMessage(MsgTypes t, int *size);
+	void copyMembers(MemberListEntry *to, int first, int count);
+	bool piggybacked(int id);
+	int maxGossipMembers();
 	void addNewMember(MessageHdr *m);
     void addNewMember(MemberListEntry *e);
 	Address* getAddr(MemberListEntry e);
     Address* getAddr(int id, short port);
     int getMemberPosition(MemberListEntry *e);
 	void pingHandler(MessageHdr *m);
+	void pingTableHandler(MessageHdr *m);
+	void expireTableMembers();
+	void answerJoins();
+	void retryJoin();
     MemberListEntry* findMember(int id, short port);
     MemberListEntry* findMember(Address *addr);
 
 public:
-	MP1Node(Member *, Params *, EmulNet *, Log *, Address *);
+	MP1Node(Member *, Params *, Network *, Log *, Address *);
 	Member * getMemberNode() {
 		return memberNode;
 	}
@@ -78,6 +103,9 @@ public:
 	void nodeStart(char *servaddrstr, short serverport);
 	int initThisNode(Address *joinaddr);
 	int introduceSelfToGroup(Address *joinAddress);
+	void bootstrap(vector<Address> &group);
+	string piggyback(Address *to, int room);
+	void receivePiggyback(const char *data, int size);
 	int finishUpThisNode();
 	void nodeLoop();
 	void checkMessages();
@@ -85,8 +113,11 @@ public:
 	void nodeLoopOps();
 	int isNullAddress(Address *addr);
 	Address getJoinAddress();
+	int joinRetryTime();
 	void initMemberListTable(Member *memberNode);
 	void printAddress(Address *addr);
+	void checkpoint(Checkpoint *ck);
+	void restore(Checkpoint *ck);
 	virtual ~MP1Node();
 };
 
@@ -8,19 +8,34 @@
 /**
  * constructor
  */
-MP2Node::MP2Node(Member *memberNode, Params *par, EmulNet * emulNet, Log * log, Address * address) {
+MP2Node::MP2Node(Member *memberNode, Params *par, Network * emulNet, Log * log, Address * address) {
 	this->memberNode = memberNode;
 	this->par = par;
 	this->emulNet = emulNet;
 	this->log = log;
 	ht = new HashTable();
 	this->memberNode->addr = *address;
+	ringVersion = -1;
+	outcomeListener = NULL;
+	outcomeEnv = NULL;
+	membership = NULL;
+	sched = NULL;
+	timeoutScheduled = -1;
 }
 
 /**
  * Destructor
  */
 MP2Node::~MP2Node() {
+	for ( map<int, TransactionInfo*>::iterator it = transactionTable.begin(); it != transactionTable.end(); ++it ) {
+		delete it->second;
+	}
+	for ( map<int, TransactionInfo*>::iterator it = readRepairs.begin(); it != readRepairs.end(); ++it ) {
+		delete it->second;
+	}
+	for ( unsigned int i = 0; i < freeTransactions.size(); i++ ) {
+		delete freeTransactions[i];
+	}
 	delete ht;
 	delete memberNode;
 }
@@ -35,12 +50,21 @@ MP2Node::~MP2Node() {
  * 				3) Calls the Stabilization Protocol
  */
 void MP2Node::updateRing() {
+	TRACE_TICK_SPAN("MP2Node::updateRing", &memberNode->addr);
 	/*
 	 * Implement this. Parts of it are already implemented
 	 */
 	vector<Node> curMemList;
 	bool change = false;
 
+	/*
+	 * The ring only depends on the membership table, nothing to do while it has not changed
+	 */
+	if ( ringVersion == this->memberNode->memberListVersion ) {
+		return;
+	}
+	ringVersion = this->memberNode->memberListVersion;
+
 	/*
 	 *  Step 1. Get the current membership list from Membership Protocol / MP1
 	 */
@@ -58,10 +82,11 @@ void MP2Node::updateRing() {
 	* Step 3: Run the stabilization protocol IF REQUIRED
 	*/
 	if (!ring.empty()) {
-		for (int i = 0; i < curMemList.size(); i++) {
-			if (curMemList[i].getHashCode() != ring[i].getHashCode()) {
+		changed = (curMemList.size() != ring.size());
+		for (unsigned int i = 0; !changed && i < curMemList.size(); i++) {
+			if (curMemList[i].getHashCode() != ring[i].getHashCode() ||
+				!(*curMemList[i].getAddress() == *ring[i].getAddress())) {
 				changed = true;
-				break;
 			}
 		}
 	}
@@ -69,10 +94,22 @@ void MP2Node::updateRing() {
 	ring = curMemList;
 
 	if (changed) {
+		memberNode->metrics.add(MC_RING_CHANGES);
 		stabilizationProtocol();
 	}
 }
 
+/**
+ * FUNCTION NAME: installRing
+ *
+ * DESCRIPTION: Take the ring of the current membership table built elsewhere. All nodes of a
+ * 				bootstrapped group share one ring, built once instead of once per node.
+ */
+void MP2Node::installRing(const vector<Node> &ring) {
+	this->ring = ring;
+	ringVersion = this->memberNode->memberListVersion;
+}
+
 /**
  * FUNCTION NAME: getMemberhipList
  *
@@ -105,21 +142,17 @@ vector<Node> MP2Node::getMembershipList() {
  * 				HASH FUNCTION USED FOR CONSISTENT HASHING
  *
  * RETURNS:
- * size_t position on the ring
+ * uint64_t position on the ring, the whole 64 bit space
  */
-size_t MP2Node::hashFunction(string key) {
-	std::hash<string> hashFunc;
-	size_t ret = hashFunc(key);
-	return ret%RING_SIZE;
+uint64_t MP2Node::hashFunction(string key) {
+	return ringHash(key);
 }
 
 /**
  * Compute own Hash
  */
-size_t MP2Node::myHash() {
-	std::hash<string> hashFunc;
-	size_t ret = hashFunc(this->memberNode->addr.addr);
-	return ret%RING_SIZE;
+uint64_t MP2Node::myHash() {
+	return ringHash(this->memberNode->addr.addr, sizeof(this->memberNode->addr.addr));
 }
 
 /**
@@ -177,15 +210,54 @@ void MP2Node::clientDelete(string key){
 void MP2Node::handleAction(MessageType mType, string key, string value) {
 	auto nodes = findNodes(key);
 	int tId = createTransaction(mType, this->par->getcurrtime(), 3, key, value);
+	long version = writeVersion();
 
 	for(auto node: nodes) {
-		auto message = new Message(tId, memberNode->addr, mType, key, value);
-		dispatchMessages(message, node.getAddress());
+		Message message(tId, memberNode->addr, mType, key, value);
+		message.version = version;
+		dispatchMessages(&message, node.getAddress());
 	}
 }
 
+/**
+ * FUNCTION NAME: writeVersion
+ *
+ * DESCRIPTION: Version of a write coordinated by this node now: the tick, then the id of the
+ * 				node, so that a later write has a higher version whichever node coordinates it.
+ * 				It is a long, the product outgrows an int after a few thousand ticks of a large group.
+ */
+long MP2Node::writeVersion() {
+	return (long)par->getcurrtime() * (par->EN_GPSZ + 1) + *(int *)(&memberNode->addr.addr);
+}
+
+/**
+ * FUNCTION NAME: setMembership
+ *
+ * DESCRIPTION: Let the gossip of the membership protocol ride on the messages of this node
+ */
+void MP2Node::setMembership(MP1Node *membership) {
+	this->membership = membership;
+}
+
+/**
+ * FUNCTION NAME: dispatchMessages
+ *
+ * DESCRIPTION: Send the message serialized with Message::toString. With PIGGYBACK set the
+ * 				gossip of the membership protocol follows it, then an int with the size of
+ * 				the gossip, 0 if none fitted.
+ */
 void MP2Node::dispatchMessages(Message *message, Address *addr) {
-	emulNet->ENsend(&memberNode->addr, addr, (char *)message, sizeof(Message));
+	string data = message->toString();
+
+	if ( par->PIGGYBACK && membership != NULL ) {
+		int room = par->MAX_MSG_SIZE - (int)sizeof(en_msg) - 1 - (int)data.size() - (int)sizeof(int);
+		string gossip = membership->piggyback(addr, room);
+		int gossipSize = gossip.size();
+
+		data += gossip;
+		data.append((char *)&gossipSize, sizeof(int));
+	}
+	emulNet->ENsend(&memberNode->addr, addr, data);
 }
 
 void MP2Node::sendReply(Message *msg, bool res) {
@@ -200,20 +272,39 @@ void MP2Node::sendReply(Message *msg, bool res) {
 	dispatchMessages(msg, &sendToAddr);
 }
 
+/**
+ * FUNCTION NAME: createTransaction
+ *
+ * DESCRIPTION: Open a transaction coordinated by this node, on a finished one if there is any
+ *
+ * RETURNS:
+ * id of the transaction
+ */
 int MP2Node::createTransaction(MessageType mType, int time, int rf, string key, string value) {
 	auto id = g_transID++;
-	auto t = new TransactionInfo {
-		id: id,
-		type: mType,
-		createTime: time,
-		replicationFactor: rf,
-		replyCount: 0,
-		key: key,
-		value: value,
-		logged: false,
-		successCount: 0
-	};
-	transactionTable.emplace(id, t);
+	TransactionInfo *t;
+
+	if (freeTransactions.empty()) {
+		t = new TransactionInfo;
+	} else {
+		t = freeTransactions.back();
+		freeTransactions.pop_back();
+	}
+	t->id = id;
+	t->type = mType;
+	t->createTime = time;
+	t->replicationFactor = rf;
+	t->replyCount = 0;
+	t->key = key;
+	t->value = value;
+	t->successCount = 0;
+	t->version = -1;
+	t->readers.clear();
+	transactionTable.emplace_hint(transactionTable.end(), id, t);
+	scheduleTimeout();
+	memberNode->metrics.add(MC_TRANSACTIONS);
+	// the trace types of the operations are in the order of MessageType
+	log->logRequest(&memberNode->addr, TR_CREATE + mType, id, key);
 	return id;
 }
 
@@ -224,9 +315,10 @@ int MP2Node::createTransaction(MessageType mType, int time, int rf, string key,
  * 			   	The function does the following:
  * 			   	1) Inserts key value into the local hash table
  * 			   	2) Return true or false based on success or failure
+ * 			   	The stabilization protocol and the read repairs also replace an older value.
  */
-bool MP2Node::createKeyValue(string key, string value, int tId) {
-	auto res = this->ht->create(key, value);
+bool MP2Node::createKeyValue(string key, string value, int tId, long version) {
+	auto res = (tId == -1) ? this->ht->write(key, value, version) : this->ht->create(key, value, version);
 
 	// hack for recover: not log recover messages
 	if (tId != -1) {
@@ -262,8 +354,8 @@ string MP2Node::readKey(string key, int tId) {
  * 				1) Update the key to the new value in the local hash table
  * 				2) Return true or false based on success or failure
  */
-bool MP2Node::updateKeyValue(string key, string value, int tId) {
-	auto res = this->ht->update(key, value);
+bool MP2Node::updateKeyValue(string key, string value, int tId, long version) {
+	auto res = this->ht->update(key, value, version);
 
 	logOperation(MessageType::UPDATE, false, res, tId, key, value);
 
@@ -295,6 +387,7 @@ bool MP2Node::deletekey(string key, int tId) {
  * 				2) Handles the messages according to message types
  */
 void MP2Node::checkMessages() {
+	TRACE_TICK_SPAN("MP2Node::checkMessages", &memberNode->addr);
 	/*
 	 * Implement this. Parts of it are already implemented
 	 */
@@ -304,6 +397,7 @@ void MP2Node::checkMessages() {
 	/*
 	 * Declare your local variables here
 	 */
+	memberNode->metrics.set(MG_MP2Q_DEPTH, memberNode->mp2q.size());
 
 	// dequeue all messages and handle them
 	while ( !memberNode->mp2q.empty() ) {
@@ -314,16 +408,29 @@ void MP2Node::checkMessages() {
 		size = memberNode->mp2q.front().size;
 		memberNode->mp2q.pop();
 
-		string message(data, data + size);
+		/*
+		 * Hand the gossip riding on the message to the membership protocol
+		 */
+		if ( par->PIGGYBACK && membership != NULL && size >= (int)sizeof(int) ) {
+			int gossipSize;
+			memcpy(&gossipSize, data + size - sizeof(int), sizeof(int));
+			size -= sizeof(int);
+			gossipSize = max(0, min(gossipSize, size));
+			size -= gossipSize;
+			membership->receivePiggyback(data + size, gossipSize);
+		}
+
+		Message parsed(string(data, data + size));
+		free(data);
 
-		auto msg = (Message *) data;
+		auto msg = &parsed;
 
 		/*
 			* Handle the message types here
  		*/
 		switch(msg->type) {
 			case MessageType::CREATE: {
-				auto res = createKeyValue(msg->key, msg->value, msg->transID);
+				auto res = createKeyValue(msg->key, msg->value, msg->transID, msg->version);
 
 				// hack for recover: not reply on recover messages
 				if (msg->transID != -1) {
@@ -334,11 +441,12 @@ void MP2Node::checkMessages() {
 			case MessageType::READ: {
 				auto res = readKey(msg->key, msg->transID);
 				msg->value = res;
+				msg->version = ht->version(msg->key);
 				sendReply(msg, !res.empty());
 			}
 				break;
 			case MessageType::UPDATE: {
-				auto res = updateKeyValue(msg->key, msg->value, msg->transID);
+				auto res = updateKeyValue(msg->key, msg->value, msg->transID, msg->version);
 				sendReply(msg, res);
 			}
 				break;
@@ -347,53 +455,211 @@ void MP2Node::checkMessages() {
 				sendReply(msg, res);
 			}
 				break;
-			case MessageType::REPLY: {
-				auto trans = transactionTable[msg->transID];
-				trans->replyCount++;
-				if (msg->success) {
-					trans->successCount++;
-				}
-			}
-			case MessageType::READREPLY: {
-				auto trans = transactionTable[msg->transID];
-				trans->replyCount++;
-				trans->value = msg->value;
-				if (msg->success) {
-					trans->successCount++;
-				}
-			}
+			case MessageType::REPLY:
+			case MessageType::READREPLY:
+				handleReply(msg);
 				break;
 		}
 	}
 
 	/*
-	 * This function should also ensure all READ and UPDATE operation
-	 * get QUORUM replies
+	 * The replies finished the transactions they decided, fail the ones out of time
 	 */
-	checkTransaction();
-}
+	expireTransactions();
 
+	sendStabilizationBacklog();
 
+	// the node has to run again for the next open transaction or the keys still held back
+	scheduleTimeout();
+}
 
-void MP2Node::checkTransaction() {
-	// check completed transaction
-	for(auto t: transactionTable) {
-		if (!t.second->logged && t.second->replyCount >= 2) {
-			auto res = t.second->successCount == t.second->replyCount;
-			logOperation(t.second->type, true, res, t.first, t.second->key, t.second->value);
-			t.second->logged = true;
+/**
+ * FUNCTION NAME: handleReply
+ *
+ * DESCRIPTION: Count the reply of a replica to a transaction this node coordinates. The
+ * 				transaction succeeds once a quorum of the replicas succeeded and fails once
+ * 				so many failed that no quorum is left, whichever reply decides it.
+ * 				A read keeps the newest value the replicas answered. A reply to a finished
+ * 				transaction only counts for the read repairs.
+ */
+void MP2Node::handleReply(Message *msg) {
+	map<int, TransactionInfo*>::iterator it = transactionTable.find(msg->transID);
+	TransactionInfo *t;
+	int quorum;
+
+	if (it == transactionTable.end()) {
+		handleLateReply(msg);
+		return;
+	}
+	t = it->second;
+	quorum = t->replicationFactor / 2 + 1;
+	t->replyCount++;
+	if (msg->type == MessageType::READREPLY) {
+		t->readers.emplace_back(msg->fromAddr, msg->success ? msg->version : -1);
+	}
+	if (msg->success) {
+		// a REPLY does not carry the value back, the coordinator keeps its own
+		if (msg->type == MessageType::READREPLY && (t->successCount == 0 || msg->version > t->version)) {
+			t->value = msg->value;
+			t->version = msg->version;
 		}
+		t->successCount++;
+	}
+
+	if (t->successCount >= quorum || t->replyCount - t->successCount > t->replicationFactor - quorum) {
+		// the quorum histograms are in the order of MessageType
+		memberNode->metrics.record(MH_QUORUM_CREATE + t->type, par->getcurrtime() - t->createTime);
+		finishTransaction(it, t->successCount >= quorum);
+	}
+}
+
+/**
+ * FUNCTION NAME: handleLateReply
+ *
+ * DESCRIPTION: Repair the replica behind a reply to a read that already succeeded, if it
+ * 				answered an older value or none
+ */
+void MP2Node::handleLateReply(Message *msg) {
+	map<int, TransactionInfo*>::iterator it = readRepairs.find(msg->transID);
+	TransactionInfo *t;
+
+	if (it == readRepairs.end()) {
+		return;
 	}
+	t = it->second;
+	t->replyCount++;
+	if ((msg->success ? msg->version : -1) < t->version) {
+		repairReplica(t, &msg->fromAddr);
+	}
+	if (t->replyCount >= t->replicationFactor) {
+		readRepairs.erase(it);
+		freeTransactions.push_back(t);
+	}
+}
+
+/**
+ * FUNCTION NAME: repairReplica
+ *
+ * DESCRIPTION: Send the value a read found to a replica that holds an older one. It goes out
+ * 				as the CREATE of the stabilization protocol, which gets no reply and only
+ * 				replaces an older version.
+ */
+void MP2Node::repairReplica(TransactionInfo *t, Address *addr) {
+	Message message(-1, memberNode->addr, CREATE, t->key, t->value);
+
+	message.version = t->version;
+	dispatchMessages(&message, addr);
+	memberNode->metrics.add(MC_READ_REPAIRS);
+}
 
-	// Check timeouts
-	for(auto t: transactionTable) {
-		if (!t.second->logged) {
-			if (par->getcurrtime() - t.second->createTime > 10) {
-				logOperation(t.second->type, true, false, t.first, t.second->key, t.second->value);
-				t.second->logged = true;
+/**
+ * FUNCTION NAME: finishTransaction
+ *
+ * DESCRIPTION: Log the outcome of a transaction, tell the listener and close it. A read that
+ * 				succeeded repairs the replicas that answered an older value, and waits for
+ * 				the replicas that did not answer yet to repair them as well.
+ */
+void MP2Node::finishTransaction(map<int, TransactionInfo*>::iterator it, bool isSuccess) {
+	TransactionInfo *t = it->second;
+
+	logOperation(t->type, true, isSuccess, t->id, t->key, t->value);
+	if ( outcomeListener != NULL ) {
+		outcomeListener(outcomeEnv, t->type, isSuccess, t->createTime);
+	}
+	transactionTable.erase(it);
+	if ( t->type == MessageType::READ && isSuccess ) {
+		for ( unsigned int i = 0; i < t->readers.size(); i++ ) {
+			if ( t->readers[i].second < t->version ) {
+				repairReplica(t, &t->readers[i].first);
 			}
 		}
+		if ( t->replyCount < t->replicationFactor ) {
+			readRepairs.emplace_hint(readRepairs.end(), t->id, t);
+			return;
+		}
+	}
+	freeTransactions.push_back(t);
+}
+
+/**
+ * FUNCTION NAME: expireTransactions
+ *
+ * DESCRIPTION: Fail the transactions that got no decision within TRANSACTION_TIMEOUT ticks.
+ * 				Ids grow with the creation time, so they time out in the order of the table
+ * 				and only the ones that do are looked at.
+ */
+void MP2Node::expireTransactions() {
+	TRACE_PHASE_SPAN("MP2Node::expireTransactions", &memberNode->addr);
+	while (!transactionTable.empty() && nextTimeout() <= par->getcurrtime()) {
+		memberNode->metrics.add(MC_TRANSACTION_TIMEOUTS);
+		finishTransaction(transactionTable.begin(), false);
+	}
+	// the replies still missing from the reads are not coming any more
+	while (!readRepairs.empty() &&
+			readRepairs.begin()->second->createTime + TRANSACTION_TIMEOUT < par->getcurrtime()) {
+		freeTransactions.push_back(readRepairs.begin()->second);
+		readRepairs.erase(readRepairs.begin());
+	}
+}
+
+/**
+ * FUNCTION NAME: nextTimeout
+ *
+ * DESCRIPTION: Returns the tick at which expireTransactions fails the oldest open transaction,
+ * 				or the next tick while the stabilization protocol holds keys back
+ *
+ * RETURNS:
+ * -1 if there is no open transaction and no key held back
+ */
+int MP2Node::nextTimeout() {
+	if (!stabilizationBacklog.empty()) {
+		return par->getcurrtime() + 1;
+	}
+	if (transactionTable.empty()) {
+		return -1;
+	}
+	return transactionTable.begin()->second->createTime + TRANSACTION_TIMEOUT + 1;
+}
+
+/**
+ * FUNCTION NAME: scheduleTimeout
+ *
+ * DESCRIPTION: Queue the timeout event of the node at nextTimeout, unless the one already
+ * 				queued comes first. A timeout firing before it is due only wakes the node up.
+ */
+void MP2Node::scheduleTimeout() {
+	int timeout = nextTimeout();
+
+	if (sched == NULL || timeout == -1) {
+		return;
 	}
+	if (timeoutScheduled > par->getcurrtime() && timeoutScheduled <= timeout) {
+		return;
+	}
+	sched->schedule(timeout, *(int *)(&memberNode->addr.addr) - 1, timeoutEvent);
+	timeoutScheduled = timeout;
+}
+
+/**
+ * FUNCTION NAME: setScheduler
+ *
+ * DESCRIPTION: Queue timeoutEvent to the scheduler for this node whenever it has to run again
+ * 				for a transaction timeout or for the keys held back
+ */
+void MP2Node::setScheduler(Scheduler *sched, EventType timeoutEvent) {
+	this->sched = sched;
+	this->timeoutEvent = timeoutEvent;
+}
+
+/**
+ * FUNCTION NAME: setOutcomeListener
+ *
+ * DESCRIPTION: Call listener with env once a transaction coordinated by this node
+ * 				succeeds, fails or times out
+ */
+void MP2Node::setOutcomeListener(void (*listener)(void *, MessageType, bool, int), void *env) {
+	outcomeListener = listener;
+	outcomeEnv = env;
 }
 
 void MP2Node::logOperation(MessageType mType, bool isCoordinator, bool isSuccess, int transID, string key, string value) {
@@ -430,6 +696,8 @@ void MP2Node::logOperation(MessageType mType, bool isCoordinator, bool isSuccess
 			}
 		}
 			break;
+		default:
+			break;
 	}
 }
 
@@ -440,27 +708,16 @@ void MP2Node::logOperation(MessageType mType, bool isCoordinator, bool isSuccess
  * 				This function is responsible for finding the replicas of a key
  */
 vector<Node> MP2Node::findNodes(string key) {
-	size_t pos = hashFunction(key);
+	uint64_t pos = hashFunction(key);
 	vector<Node> addr_vec;
 	if (ring.size() >= 3) {
-		// if pos <= min || pos > max, the leader is the min
-		if (pos <= ring.at(0).getHashCode() || pos > ring.at(ring.size()-1).getHashCode()) {
-			addr_vec.emplace_back(ring.at(0));
-			addr_vec.emplace_back(ring.at(1));
-			addr_vec.emplace_back(ring.at(2));
-		}
-		else {
-			// go through the ring until pos <= node
-			for (int i=1; i<ring.size(); i++){
-				Node addr = ring.at(i);
-				if (pos <= addr.getHashCode()) {
-					addr_vec.emplace_back(addr);
-					addr_vec.emplace_back(ring.at((i+1)%ring.size()));
-					addr_vec.emplace_back(ring.at((i+2)%ring.size()));
-					break;
-				}
-			}
-		}
+		// the leader is the first node at or after pos, the min if pos > max
+		auto leader = lower_bound(ring.begin(), ring.end(), pos,
+				[](Node &node, uint64_t position) { return node.getHashCode() < position; });
+		size_t i = (leader == ring.end()) ? 0 : leader - ring.begin();
+		addr_vec.emplace_back(ring.at(i));
+		addr_vec.emplace_back(ring.at((i+1)%ring.size()));
+		addr_vec.emplace_back(ring.at((i+2)%ring.size()));
 	}
 	return addr_vec;
 }
@@ -471,6 +728,7 @@ vector<Node> MP2Node::findNodes(string key) {
  * DESCRIPTION: Receive messages from EmulNet and push into the queue (mp2q)
  */
 bool MP2Node::recvLoop() {
+    TRACE_PHASE_SPAN("MP2Node::recvLoop", &memberNode->addr);
     if ( memberNode->bFailed ) {
     	return false;
     }
@@ -486,7 +744,7 @@ bool MP2Node::recvLoop() {
  */
 int MP2Node::enqueueWrapper(void *env, char *buff, int size) {
 	Queue q;
-	return q.enqueue((queue<q_elt> *)env, (void *)buff, size);
+	return q.enqueue((MsgQueue *)env, (void *)buff, size);
 }
 /**
  * FUNCTION NAME: stabilizationProtocol
@@ -498,12 +756,211 @@ int MP2Node::enqueueWrapper(void *env, char *buff, int size) {
  *				Note:- "CORRECT" replicas implies that every key is replicated in its two neighboring nodes in the ring
  */
 void MP2Node::stabilizationProtocol() {
+	TRACE_PHASE_SPAN("MP2Node::stabilizationProtocol", &memberNode->addr);
+	// this pass sends every key to its replicas on the new ring, what was held back is stale
+	stabilizationBacklog.clear();
 	for(auto d: ht->hashTable) {
 		auto nodes = findNodes(d.first);
 
 		for(auto node: nodes) {
-			auto message = new Message(-1, memberNode->addr, CREATE, d.first, d.second);
-			dispatchMessages(message, node.getAddress());
+			// a congested replica gets the key once it has room, instead of losing it
+			if (emulNet->ENcongested(node.getAddress())) {
+				stabilizationBacklog.emplace_back(d.first, *node.getAddress());
+				memberNode->metrics.add(MC_STABILIZATION_DEFERRED);
+				continue;
+			}
+			Message message(-1, memberNode->addr, CREATE, d.first, d.second);
+			message.version = ht->version(d.first);
+			dispatchMessages(&message, node.getAddress());
+			memberNode->metrics.add(MC_STABILIZATION_KEYS);
+		}
+	}
+	scheduleTimeout();
+}
+
+/**
+ * FUNCTION NAME: sendStabilizationBacklog
+ *
+ * DESCRIPTION: Send the keys held back to the replicas that are no longer congested, with
+ * 				the value they have now. A key deleted in the meantime is not sent.
+ */
+void MP2Node::sendStabilizationBacklog() {
+	size_t kept = 0;
+
+	for (size_t i = 0; i < stabilizationBacklog.size(); i++) {
+		pair<string, Address> &held = stabilizationBacklog[i];
+		if (emulNet->ENcongested(&held.second)) {
+			stabilizationBacklog[kept++] = held;
+			continue;
+		}
+		map<string, string>::iterator it = ht->hashTable.find(held.first);
+		if (it != ht->hashTable.end()) {
+			Message message(-1, memberNode->addr, CREATE, it->first, it->second);
+			message.version = ht->version(it->first);
+			dispatchMessages(&message, &held.second);
+			memberNode->metrics.add(MC_STABILIZATION_KEYS);
+		}
+	}
+	stabilizationBacklog.resize(kept);
+}
+
+/**
+ * FUNCTION NAME: putNodes
+ *
+ * DESCRIPTION: Write the addresses of a list of nodes to a checkpoint
+ */
+static void putNodes(Checkpoint *ck, vector<Node> &nodes) {
+	ck->putLong(nodes.size());
+	for ( unsigned int i = 0; i < nodes.size(); i++ ) {
+		ck->put(nodes[i].getAddress()->addr, sizeof(nodes[i].getAddress()->addr));
+	}
+}
+
+/**
+ * FUNCTION NAME: getNodes
+ *
+ * DESCRIPTION: Read back the nodes written by putNodes, their positions on the ring follow
+ * 				from the addresses
+ */
+static void getNodes(Checkpoint *ck, vector<Node> &nodes) {
+	Address address;
+
+	nodes.clear();
+	for ( size_t n = ck->getCount(sizeof(address.addr)); n > 0; n-- ) {
+		ck->get(address.addr, sizeof(address.addr));
+		nodes.emplace_back(Node(address));
+	}
+}
+
+/**
+ * FUNCTION NAME: putTransactions
+ *
+ * DESCRIPTION: Write a table of transactions to a checkpoint
+ */
+static void putTransactions(Checkpoint *ck, map<int, TransactionInfo*> &table) {
+	ck->putLong(table.size());
+	for ( map<int, TransactionInfo*>::iterator it = table.begin(); it != table.end(); ++it ) {
+		TransactionInfo *t = it->second;
+		ck->putLong(t->id);
+		ck->putLong(t->type);
+		ck->putLong(t->createTime);
+		ck->putLong(t->replicationFactor);
+		ck->putLong(t->replyCount);
+		ck->putString(t->key);
+		ck->putString(t->value);
+		ck->putLong(t->successCount);
+		ck->putLong(t->version);
+		ck->putLong(t->readers.size());
+		for ( unsigned int i = 0; i < t->readers.size(); i++ ) {
+			ck->put(t->readers[i].first.addr, sizeof(t->readers[i].first.addr));
+			ck->putLong(t->readers[i].second);
 		}
 	}
 }
+
+/**
+ * FUNCTION NAME: getTransactions
+ *
+ * DESCRIPTION: Read back a table written by putTransactions, the transactions in it go back
+ * 				to the free ones first
+ */
+static void getTransactions(Checkpoint *ck, map<int, TransactionInfo*> &table, vector<TransactionInfo*> &freeTransactions) {
+	for ( map<int, TransactionInfo*>::iterator it = table.begin(); it != table.end(); ++it ) {
+		freeTransactions.push_back(it->second);
+	}
+	table.clear();
+	for ( size_t n = ck->getCount(10 * sizeof(long)); n > 0; n-- ) {
+		TransactionInfo *t = new TransactionInfo;
+		t->id = (int)ck->getLong();
+		t->type = (MessageType)ck->getLong();
+		t->createTime = (int)ck->getLong();
+		t->replicationFactor = (int)ck->getLong();
+		t->replyCount = (int)ck->getLong();
+		t->key = ck->getString();
+		t->value = ck->getString();
+		t->successCount = (int)ck->getLong();
+		t->version = ck->getLong();
+		for ( size_t r = ck->getCount(sizeof(Address) + sizeof(long)); r > 0; r-- ) {
+			Address address;
+			ck->get(address.addr, sizeof(address.addr));
+			t->readers.emplace_back(address, ck->getLong());
+		}
+		table[t->id] = t;
+	}
+}
+
+/**
+ * FUNCTION NAME: checkpoint
+ *
+ * DESCRIPTION: Write the ring, the hash table, the open transactions, the reads waiting to
+ * 				repair late replicas, the keys held back by the stabilization protocol and
+ * 				the timeout queued to a checkpoint
+ */
+void MP2Node::checkpoint(Checkpoint *ck) {
+	putNodes(ck, hasMyReplicas);
+	putNodes(ck, haveReplicasOf);
+	putNodes(ck, ring);
+	ck->putLong(ringVersion);
+	ck->putLong(ht->hashTable.size());
+	for ( map<string, string>::iterator it = ht->hashTable.begin(); it != ht->hashTable.end(); ++it ) {
+		ck->putString(it->first);
+		ck->putString(it->second);
+		ck->putLong(ht->version(it->first));
+	}
+	putTransactions(ck, transactionTable);
+	putTransactions(ck, readRepairs);
+	ck->putLong(stabilizationBacklog.size());
+	for ( unsigned int i = 0; i < stabilizationBacklog.size(); i++ ) {
+		ck->putString(stabilizationBacklog[i].first);
+		ck->put(stabilizationBacklog[i].second.addr, sizeof(stabilizationBacklog[i].second.addr));
+	}
+	ck->putLong(timeoutScheduled);
+}
+
+/**
+ * FUNCTION NAME: restore
+ *
+ * DESCRIPTION: Read back the state written by checkpoint
+ */
+void MP2Node::restore(Checkpoint *ck) {
+	size_t n;
+
+	getNodes(ck, hasMyReplicas);
+	getNodes(ck, haveReplicasOf);
+	getNodes(ck, ring);
+	ringVersion = ck->getLong();
+	ht->clear();
+	for ( n = ck->getCount(3 * sizeof(long)); n > 0; n-- ) {
+		string key = ck->getString();
+		ht->hashTable[key] = ck->getString();
+		ht->versionTable[key] = ck->getLong();
+	}
+	getTransactions(ck, transactionTable, freeTransactions);
+	getTransactions(ck, readRepairs, freeTransactions);
+	stabilizationBacklog.clear();
+	for ( n = ck->getCount(sizeof(long) + sizeof(Address)); n > 0; n-- ) {
+		Address address;
+		string key = ck->getString();
+		ck->get(address.addr, sizeof(address.addr));
+		stabilizationBacklog.emplace_back(key, address);
+	}
+	timeoutScheduled = (int)ck->getLong();
+}
+
+/**
+ * FUNCTION NAME: checkpointTransID
+ *
+ * DESCRIPTION: Write the id the next transaction of any node gets to a checkpoint
+ */
+void MP2Node::checkpointTransID(Checkpoint *ck) {
+	ck->putLong(g_transID);
+}
+
+/**
+ * FUNCTION NAME: restoreTransID
+ *
+ * DESCRIPTION: Read back the id written by checkpointTransID
+ */
+void MP2Node::restoreTransID(Checkpoint *ck) {
+	g_transID = (int)ck->getLong();
+}
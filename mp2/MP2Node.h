@@ -11,13 +11,21 @@
  * Header files
  */
 #include "stdincludes.h"
-#include "EmulNet.h"
+#include "Network.h"
 #include "Node.h"
 #include "HashTable.h"
 #include "Log.h"
 #include "Params.h"
 #include "Message.h"
 #include "Queue.h"
+#include "Trace.h"
+#include "MP1Node.h"
+
+/**
+ * Macros
+ */
+// number of ticks after which a coordinator gives up on a transaction
+#define TRANSACTION_TIMEOUT 10
 
 typedef struct TransactionInfo {
 	int id;
@@ -27,8 +35,10 @@ typedef struct TransactionInfo {
 	int replyCount;
 	string key;
 	string value;
-	bool logged;
 	int successCount;
+	// version of value, and the replicas that answered a read with the version they hold
+	long version;
+	vector<pair<Address, long> > readers;
 }TransactionInfo;
 
 /**
@@ -49,33 +59,62 @@ private:
 	vector<Node> haveReplicasOf;
 	// Ring
 	vector<Node> ring;
+	// memberListVersion of the membership table the ring was built from
+	long ringVersion;
 	// Hash Table
 	HashTable * ht;
 	// Member representing this member
 	Member *memberNode;
 	// Params object
 	Params *par;
-	// Object of EmulNet
-	EmulNet * emulNet;
+	// Object of the network
+	Network * emulNet;
 	// Object of Log
 	Log * log;
+	// Membership protocol of this node, its gossip rides on the messages of the KV store
+	MP1Node *membership;
 
-	// Transactions
+	// Told the outcome of every transaction this node coordinates
+	void (*outcomeListener)(void *env, MessageType mType, bool isSuccess, int createTime);
+	void *outcomeEnv;
+
+	// Open transactions by id, ids grow with the creation time
 	map<int, TransactionInfo*> transactionTable;
+	// Finished transactions, reused by the next ones
+	vector<TransactionInfo*> freeTransactions;
 	int createTransaction(MessageType mType, int time, int rf, string key, string value);
-	void checkTransaction();
+	void handleReply(Message *msg);
+	void finishTransaction(map<int, TransactionInfo*>::iterator it, bool isSuccess);
+	void expireTransactions();
+	long writeVersion();
+
+	// Reads that succeeded before every replica answered, the late ones are repaired too
+	map<int, TransactionInfo*> readRepairs;
+	void repairReplica(TransactionInfo *t, Address *addr);
+	void handleLateReply(Message *msg);
+
+	// Keys the stabilization protocol holds back until their replica is no longer congested
+	vector<pair<string, Address> > stabilizationBacklog;
+	void sendStabilizationBacklog();
+
+	// Wakes the node up for nextTimeout, timeoutScheduled is the tick already queued
+	Scheduler *sched;
+	EventType timeoutEvent;
+	int timeoutScheduled;
+	void scheduleTimeout();
 
 public:
-	MP2Node(Member *memberNode, Params *par, EmulNet *emulNet, Log *log, Address *addressOfMember);
+	MP2Node(Member *memberNode, Params *par, Network *emulNet, Log *log, Address *addressOfMember);
 	Member * getMemberNode() {
 		return this->memberNode;
 	}
 
 	// ring functionalities
 	void updateRing();
+	void installRing(const vector<Node> &ring);
 	vector<Node> getMembershipList();
-	size_t hashFunction(string key);
-	size_t myHash();
+	uint64_t hashFunction(string key);
+	uint64_t myHash();
 	void findNeighbors();
 
 
@@ -86,6 +125,9 @@ public:
 	void clientDelete(string key);
 
 	void logOperation(MessageType mType, bool isCoordinator, bool isSuccess, int transID, string key, string value);
+	void setOutcomeListener(void (*listener)(void *, MessageType, bool, int), void *env);
+	void setMembership(MP1Node *membership);
+	void setScheduler(Scheduler *sched, EventType timeoutEvent);
 
 	// receive messages from Emulnet
 	bool recvLoop();
@@ -94,6 +136,9 @@ public:
 	// handle messages from receiving queue
 	void checkMessages();
 
+	// tick at which the node has to run again, for a timeout or for held back keys
+	int nextTimeout();
+
 	// handle client CRUD operation
 	void handleAction(MessageType mType, string key, string value);
 
@@ -105,14 +150,20 @@ public:
 	vector<Node> findNodes(string key);
 
 	// server
-	bool createKeyValue(string key, string value, int tId);
+	bool createKeyValue(string key, string value, int tId, long version = 0);
 	string readKey(string key, int tId);
-	bool updateKeyValue(string key, string value, int tId);
+	bool updateKeyValue(string key, string value, int tId, long version = 0);
 	bool deletekey(string key, int tId);
 
 	// stabilization protocol - handle multiple failures
 	void stabilizationProtocol();
 
+	// state of the node and of the transaction ids in a checkpoint
+	void checkpoint(Checkpoint *ck);
+	void restore(Checkpoint *ck);
+	static void checkpointTransID(Checkpoint *ck);
+	static void restoreTransID(Checkpoint *ck);
+
 	~MP2Node();
 };
 
@@ -11,6 +11,17 @@
  */
 q_elt::q_elt(void *elt, int size): elt(elt), size(size) {}
 
+/**
+ * Destructor
+ */
+q_spare_nodes::~q_spare_nodes() {
+	for ( unsigned int i = 0; i < nodes.size(); i++ ) {
+		delete nodes[i];
+	}
+}
+
+thread_local q_spare_nodes MsgQueue::spareNodes;
+
 /**
  * Copy constructor
  */
@@ -152,8 +163,11 @@ Member::Member(const Member &anotherMember) {
 	this->pingCounter = anotherMember.pingCounter;
 	this->timeOutCounter = anotherMember.timeOutCounter;
 	this->memberList = anotherMember.memberList;
+	this->memberTable = anotherMember.memberTable;
+	this->memberListVersion = anotherMember.memberListVersion;
 	this->myPos = anotherMember.myPos;
 	this->mp1q = anotherMember.mp1q;
+	this->metrics = anotherMember.metrics;
 	this->mp2q = anotherMember.mp2q;
 }
 
@@ -170,8 +184,85 @@ Member& Member::operator =(const Member& anotherMember) {
 	this->pingCounter = anotherMember.pingCounter;
 	this->timeOutCounter = anotherMember.timeOutCounter;
 	this->memberList = anotherMember.memberList;
+	this->memberTable = anotherMember.memberTable;
+	this->memberListVersion = anotherMember.memberListVersion;
 	this->myPos = anotherMember.myPos;
 	this->mp1q = anotherMember.mp1q;
+	this->metrics = anotherMember.metrics;
 	this->mp2q = anotherMember.mp2q;
 	return *this;
 }
+
+/**
+ * FUNCTION NAME: putQueue
+ *
+ * DESCRIPTION: Write the entries of a queue, size and bytes, to a checkpoint
+ */
+static void putQueue(Checkpoint *ck, MsgQueue &queue) {
+	ck->putLong(queue.size());
+	queue.forEach([ck](q_elt &element) {
+		ck->putLong(element.size);
+		ck->put(element.elt, element.size);
+	});
+}
+
+/**
+ * FUNCTION NAME: getQueue
+ *
+ * DESCRIPTION: Read back the entries written by putQueue into an empty queue
+ */
+static void getQueue(Checkpoint *ck, MsgQueue &queue) {
+	for ( size_t n = ck->getCount(sizeof(long)); n > 0; n-- ) {
+		int size = (int)ck->getCount(1);
+		void *elt = malloc(size);
+		ck->get(elt, size);
+		queue.push(q_elt(elt, size));
+	}
+}
+
+/**
+ * FUNCTION NAME: checkpoint
+ *
+ * DESCRIPTION: Write the member, its membership table and its queues to a checkpoint
+ */
+void Member::checkpoint(Checkpoint *ck) {
+	ck->put(&addr, sizeof(addr));
+	ck->put(&inited, sizeof(inited));
+	ck->put(&inGroup, sizeof(inGroup));
+	ck->put(&bFailed, sizeof(bFailed));
+	ck->putLong(nnb);
+	ck->putLong(heartbeat);
+	ck->putLong(pingCounter);
+	ck->putLong(timeOutCounter);
+	ck->putLong(memberList.size());
+	ck->put(memberList.data(), memberList.size() * sizeof(MemberListEntry));
+	memberTable.checkpoint(ck);
+	ck->putLong(memberListVersion);
+	putQueue(ck, mp1q);
+	metrics.checkpoint(ck);
+	putQueue(ck, mp2q);
+}
+
+/**
+ * FUNCTION NAME: restore
+ *
+ * DESCRIPTION: Read back the member written by checkpoint
+ */
+void Member::restore(Checkpoint *ck) {
+	ck->get(&addr, sizeof(addr));
+	ck->get(&inited, sizeof(inited));
+	ck->get(&inGroup, sizeof(inGroup));
+	ck->get(&bFailed, sizeof(bFailed));
+	nnb = (int)ck->getLong();
+	heartbeat = ck->getLong();
+	pingCounter = (int)ck->getLong();
+	timeOutCounter = (int)ck->getLong();
+	memberList.resize(ck->getCount(sizeof(MemberListEntry)));
+	ck->get(memberList.data(), memberList.size() * sizeof(MemberListEntry));
+	memberTable.restore(ck);
+	memberListVersion = ck->getLong();
+	myPos = memberList.begin();
+	getQueue(ck, mp1q);
+	metrics.restore(ck);
+	getQueue(ck, mp2q);
+}
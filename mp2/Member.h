@@ -7,7 +7,20 @@
 #ifndef MEMBER_H_
 #define MEMBER_H_
 
+#include <atomic>
 #include "stdincludes.h"
+#include "Metrics.h"
+#include "MemberTable.h"
+
+/*
+ * Macros
+ */
+// entries a node inbox holds at once
+#define MSGQUEUE_CAPACITY (1 << 20)
+// bytes between the producer and the consumer side of a queue
+#define MSGQUEUE_CACHE_LINE 64
+// links a thread keeps for its next pushes
+#define MSGQUEUE_SPARE_NODES 4096
 
 /**
  * CLASS NAME: q_elt
@@ -21,6 +34,134 @@ public:
 	q_elt(void *elt, int size);
 };
 
+/**
+ * STRUCT NAME: q_node
+ *
+ * DESCRIPTION: Link of a MsgQueue holding one entry
+ */
+typedef struct q_node {
+	atomic<q_node *> next;
+	q_elt element;
+	q_node(const q_elt &element): next(NULL), element(element) {}
+}q_node;
+
+/**
+ * STRUCT NAME: q_spare_nodes
+ *
+ * DESCRIPTION: Spare links of a thread, deleted once the thread exits
+ */
+typedef struct q_spare_nodes {
+	vector<q_node *> nodes;
+	~q_spare_nodes();
+}q_spare_nodes;
+
+/**
+ * CLASS NAME: MsgQueue
+ *
+ * DESCRIPTION: Bounded lock-free multi producer single consumer FIFO, the inbox of a node.
+ * 				Any thread pushes, only the thread of the node looks at and pops the entries.
+ * 				Producers exchange the tail and link the previous one to their entry, the
+ * 				consumer follows the links from the head, which is the last entry it popped.
+ * 				The sides sit on cache lines of their own. An idle node costs the queue
+ * 				itself. Links are taken from and given back to a spare list of the thread,
+ * 				so a thread that delivers the messages it drains allocates nothing.
+ */
+class MsgQueue {
+private:
+	// producers
+	atomic<q_node *> tail;
+	atomic<size_t> count;
+	char producerPad[MSGQUEUE_CACHE_LINE];
+	// consumer
+	q_node *head;
+	q_node stub;
+	size_t capacity;
+	char consumerPad[MSGQUEUE_CACHE_LINE];
+	static thread_local q_spare_nodes spareNodes;
+	static q_node *newNode(const q_elt &element) {
+		if ( spareNodes.nodes.empty() ) {
+			return new q_node(element);
+		}
+		q_node *n = spareNodes.nodes.back();
+		spareNodes.nodes.pop_back();
+		n->next.store(NULL, memory_order_relaxed);
+		n->element = element;
+		return n;
+	}
+	static void freeNode(q_node *n) {
+		if ( spareNodes.nodes.size() < MSGQUEUE_SPARE_NODES ) {
+			spareNodes.nodes.push_back(n);
+		}
+		else {
+			delete n;
+		}
+	}
+	void clear() {
+		while ( !empty() ) {
+			pop();
+		}
+	}
+	void copy(const MsgQueue &anotherQueue) {
+		for ( q_node *n = anotherQueue.head->next.load(memory_order_acquire); n != NULL; n = n->next.load(memory_order_acquire) ) {
+			push(n->element);
+		}
+	}
+public:
+	MsgQueue(size_t capacity = MSGQUEUE_CAPACITY): tail(&stub), count(0), head(&stub), stub(q_elt(NULL, 0)), capacity(capacity) {}
+	MsgQueue(const MsgQueue &anotherQueue): MsgQueue(anotherQueue.capacity) {
+		copy(anotherQueue);
+	}
+	MsgQueue& operator =(const MsgQueue &anotherQueue) {
+		if ( this != &anotherQueue ) {
+			clear();
+			capacity = anotherQueue.capacity;
+			copy(anotherQueue);
+		}
+		return *this;
+	}
+	virtual ~MsgQueue() {
+		clear();
+		if ( head != &stub ) {
+			freeNode(head);
+		}
+	}
+	// consumer side, empty also while a producer is still linking its entry in
+	bool empty() const {
+		return head->next.load(memory_order_acquire) == NULL;
+	}
+	size_t size() const {
+		return count.load(memory_order_relaxed);
+	}
+	q_elt &front() {
+		return head->next.load(memory_order_acquire)->element;
+	}
+	void pop() {
+		q_node *next = head->next.load(memory_order_acquire);
+		if ( head != &stub ) {
+			freeNode(head);
+		}
+		head = next;
+		count.fetch_sub(1, memory_order_relaxed);
+	}
+	// entries from the oldest on, consumer side
+	template <typename F> void forEach(F f) {
+		for ( q_node *n = head->next.load(memory_order_acquire); n != NULL; n = n->next.load(memory_order_acquire) ) {
+			f(n->element);
+		}
+	}
+	// any thread, false and nothing queued when capacity entries are queued already
+	bool push(const q_elt &element) {
+		if ( count.fetch_add(1, memory_order_relaxed) >= capacity ) {
+			count.fetch_sub(1, memory_order_relaxed);
+			return false;
+		}
+		q_node *n = newNode(element);
+		q_node *prev = tail.exchange(n, memory_order_acq_rel);
+		prev->next.store(n, memory_order_release);
+		return true;
+	}
+};
+
 /**
  * CLASS NAME: Address
  *
@@ -106,20 +247,28 @@ public:
 	int timeOutCounter;
 	// Membership table
 	vector<MemberListEntry> memberList;
+	// Heartbeats and timestamps of the membership table by node id, when the test case sets MEMBER_TABLE
+	MemberTable memberTable;
+	// Bumped whenever an entry is added to or removed from the membership table
+	long memberListVersion;
 	// My position in the membership table
 	vector<MemberListEntry>::iterator myPos;
 	// Queue for failure detection messages
-	queue<q_elt> mp1q;
+	MsgQueue mp1q;
+	// Counters, gauges and histograms of this node
+	Metrics metrics;
 	// Queue for KVstore messages
-	queue<q_elt> mp2q;
+	MsgQueue mp2q;
 	/**
 	 * Constructor
 	 */
-	Member(): inited(false), inGroup(false), bFailed(false), nnb(0), heartbeat(0), pingCounter(0), timeOutCounter(0) {}
+	Member(): inited(false), inGroup(false), bFailed(false), nnb(0), heartbeat(0), pingCounter(0), timeOutCounter(0), memberListVersion(0) {}
 	// copy constructor
 	Member(const Member &anotherMember);
 	// Assignment operator overloading
 	Member& operator =(const Member &anotherMember);
+	void checkpoint(Checkpoint *ck);
+	void restore(Checkpoint *ck);
 	virtual ~Member() {}
 };
 
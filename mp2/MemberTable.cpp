@@ -0,0 +1,288 @@
+/**********************************
+ * FILE NAME: MemberTable.cpp
+ *
+ * DESCRIPTION: Dense membership table definition
+ **********************************/
+
+#include "MemberTable.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+thread_local vector<int64_t> MemberTable::incoming;
+#if defined(__x86_64__) || defined(__i386__)
+bool MemberTable::useAvx2 = __builtin_cpu_supports("avx2");
+#else
+bool MemberTable::useAvx2 = false;
+#endif
+
+/**
+ * Constructor
+ */
+MemberTable::MemberTable(): count(0), stagedLow(INT_MAX), stagedHigh(-1) {}
+
+/**
+ * FUNCTION NAME: clear
+ *
+ * DESCRIPTION: Empty the table, keeping its room
+ */
+void MemberTable::clear() {
+	fill(heartbeat.begin(), heartbeat.end(), MT_ABSENT);
+	fill(timestamp.begin(), timestamp.end(), MT_ABSENT);
+	fill(position.begin(), position.end(), -1);
+	count = 0;
+}
+
+/**
+ * FUNCTION NAME: reserve
+ *
+ * DESCRIPTION: Make room for the ids up to id
+ */
+void MemberTable::reserve(int id) {
+	if ( id < (int)position.size() ) {
+		return;
+	}
+	heartbeat.resize(id + 1, MT_ABSENT);
+	timestamp.resize(id + 1, MT_ABSENT);
+	position.resize(id + 1, -1);
+}
+
+/**
+ * FUNCTION NAME: add
+ *
+ * DESCRIPTION: Add the member id, at position pos of the membership list
+ */
+void MemberTable::add(int id, int pos, int64_t hb, int64_t ts) {
+	reserve(id);
+	if ( position[id] < 0 ) {
+		count++;
+	}
+	heartbeat[id] = hb;
+	timestamp[id] = ts;
+	position[id] = pos;
+}
+
+/**
+ * FUNCTION NAME: remove
+ *
+ * DESCRIPTION: Remove the member id. The caller moves the members after it in the list.
+ */
+void MemberTable::remove(int id) {
+	if ( !contains(id) ) {
+		return;
+	}
+	heartbeat[id] = MT_ABSENT;
+	timestamp[id] = MT_ABSENT;
+	position[id] = -1;
+	count--;
+}
+
+/**
+ * FUNCTION NAME: moved
+ *
+ * DESCRIPTION: The member id is now at position pos of the membership list
+ */
+void MemberTable::moved(int id, int pos) {
+	position[id] = pos;
+}
+
+/**
+ * FUNCTION NAME: touch
+ *
+ * DESCRIPTION: Heard from the member id itself: one more heartbeat, seen now
+ */
+void MemberTable::touch(int id, int64_t now) {
+	heartbeat[id]++;
+	timestamp[id] = now;
+}
+
+/**
+ * FUNCTION NAME: stage
+ *
+ * DESCRIPTION: Heartbeat of the member id in a gossiped view, taken in by the next merge.
+ * 				Only members of the table are staged, new ones are added on their own.
+ */
+void MemberTable::stage(int id, int64_t hb) {
+	if ( id >= (int)incoming.size() ) {
+		incoming.resize(max((size_t)id + 1, incoming.size() * 2), MT_NO_NEWS);
+	}
+	incoming[id] = hb;
+	stagedLow = min(stagedLow, id);
+	stagedHigh = max(stagedHigh, id);
+}
+
+/**
+ * FUNCTION NAME: merge
+ *
+ * DESCRIPTION: Take the newer of the staged and the known heartbeat of every staged member,
+ * 				a member with a newer heartbeat is seen now
+ *
+ * RETURNS:
+ * number of members with a newer heartbeat
+ */
+int MemberTable::merge(int64_t now) {
+	int n = stagedHigh - stagedLow + 1;
+	int updated;
+
+	if ( n <= 0 ) {
+		return 0;
+	}
+	if ( useAvx2 ) {
+		updated = mergeAvx2(&heartbeat[stagedLow], &timestamp[stagedLow], &incoming[stagedLow], n, now);
+	}
+	else {
+		updated = mergeScalar(&heartbeat[stagedLow], &timestamp[stagedLow], &incoming[stagedLow], n, now);
+	}
+	stagedLow = INT_MAX;
+	stagedHigh = -1;
+	return updated;
+}
+
+/**
+ * FUNCTION NAME: expired
+ *
+ * DESCRIPTION: Append the members not seen for timeout ticks to ids, lowest id first
+ *
+ * RETURNS:
+ * number of members appended
+ */
+int MemberTable::expired(int64_t now, int64_t timeout, vector<int> &ids) {
+	int n = (int)timestamp.size();
+
+	if ( n == 0 ) {
+		return 0;
+	}
+	if ( useAvx2 ) {
+		return expiredAvx2(&timestamp[0], n, now - timeout, 0, ids);
+	}
+	return expiredScalar(&timestamp[0], n, now - timeout, 0, ids);
+}
+
+/**
+ * FUNCTION NAME: checkpoint
+ *
+ * DESCRIPTION: Write the table to a checkpoint. Nothing is staged between two ticks.
+ */
+void MemberTable::checkpoint(Checkpoint *ck) {
+	ck->putLong(position.size());
+	ck->put(heartbeat.data(), heartbeat.size() * sizeof(int64_t));
+	ck->put(timestamp.data(), timestamp.size() * sizeof(int64_t));
+	ck->put(position.data(), position.size() * sizeof(int));
+	ck->putLong(count);
+}
+
+/**
+ * FUNCTION NAME: restore
+ *
+ * DESCRIPTION: Read back the table written by checkpoint
+ */
+void MemberTable::restore(Checkpoint *ck) {
+	size_t n = ck->getCount(2 * sizeof(int64_t) + sizeof(int));
+	heartbeat.resize(n);
+	timestamp.resize(n);
+	position.resize(n);
+	ck->get(heartbeat.data(), n * sizeof(int64_t));
+	ck->get(timestamp.data(), n * sizeof(int64_t));
+	ck->get(position.data(), n * sizeof(int));
+	count = (int)ck->getLong();
+	stagedLow = INT_MAX;
+	stagedHigh = -1;
+}
+
+/**
+ * FUNCTION NAME: mergeScalar
+ *
+ * DESCRIPTION: Merge of n ids one at a time. The staged heartbeats are reset to MT_NO_NEWS.
+ */
+int MemberTable::mergeScalar(int64_t *hb, int64_t *ts, int64_t *in, int n, int64_t now) {
+	int updated = 0;
+
+	for ( int i = 0; i < n; i++ ) {
+		if ( in[i] > hb[i] ) {
+			hb[i] = in[i];
+			ts[i] = now;
+			updated++;
+		}
+		in[i] = MT_NO_NEWS;
+	}
+	return updated;
+}
+
+/**
+ * FUNCTION NAME: expiredScalar
+ *
+ * DESCRIPTION: Ids first + i of the timestamps at or below limit, one at a time
+ */
+int MemberTable::expiredScalar(int64_t *ts, int n, int64_t limit, int first, vector<int> &ids) {
+	int found = 0;
+
+	for ( int i = 0; i < n; i++ ) {
+		if ( ts[i] <= limit ) {
+			ids.push_back(first + i);
+			found++;
+		}
+	}
+	return found;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+/**
+ * FUNCTION NAME: mergeAvx2
+ *
+ * DESCRIPTION: Merge of n ids 4 at a time: a signed compare picks the lanes with a newer
+ * 				heartbeat, the heartbeats and timestamps of those lanes are blended in
+ */
+__attribute__((target("avx2")))
+int MemberTable::mergeAvx2(int64_t *hb, int64_t *ts, int64_t *in, int n, int64_t now) {
+	__m256i vnow = _mm256_set1_epi64x(now);
+	__m256i none = _mm256_set1_epi64x(MT_NO_NEWS);
+	int updated = 0;
+	int i;
+
+	for ( i = 0; i + 4 <= n; i += 4 ) {
+		__m256i known = _mm256_loadu_si256((__m256i *)(hb + i));
+		__m256i staged = _mm256_loadu_si256((__m256i *)(in + i));
+		__m256i newer = _mm256_cmpgt_epi64(staged, known);
+		int mask = _mm256_movemask_pd(_mm256_castsi256_pd(newer));
+		if ( mask != 0 ) {
+			__m256i seen = _mm256_loadu_si256((__m256i *)(ts + i));
+			_mm256_storeu_si256((__m256i *)(hb + i), _mm256_blendv_epi8(known, staged, newer));
+			_mm256_storeu_si256((__m256i *)(ts + i), _mm256_blendv_epi8(seen, vnow, newer));
+			updated += __builtin_popcount(mask);
+		}
+		_mm256_storeu_si256((__m256i *)(in + i), none);
+	}
+	return updated + mergeScalar(hb + i, ts + i, in + i, n - i, now);
+}
+
+/**
+ * FUNCTION NAME: expiredAvx2
+ *
+ * DESCRIPTION: Ids first + i of the timestamps at or below limit, 4 at a time
+ */
+__attribute__((target("avx2")))
+int MemberTable::expiredAvx2(int64_t *ts, int n, int64_t limit, int first, vector<int> &ids) {
+	__m256i above = _mm256_set1_epi64x(limit + 1);
+	int found = 0;
+	int i;
+
+	for ( i = 0; i + 4 <= n; i += 4 ) {
+		__m256i seen = _mm256_loadu_si256((__m256i *)(ts + i));
+		int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(above, seen)));
+		while ( mask != 0 ) {
+			ids.push_back(first + i + __builtin_ctz(mask));
+			mask &= mask - 1;
+			found++;
+		}
+	}
+	return found + expiredScalar(ts + i, n - i, limit, first + i, ids);
+}
+#else
+int MemberTable::mergeAvx2(int64_t *hb, int64_t *ts, int64_t *in, int n, int64_t now) {
+	return mergeScalar(hb, ts, in, n, now);
+}
+
+int MemberTable::expiredAvx2(int64_t *ts, int n, int64_t limit, int first, vector<int> &ids) {
+	return expiredScalar(ts, n, limit, first, ids);
+}
+#endif
@@ -0,0 +1,77 @@
+/**********************************
+ * FILE NAME: MemberTable.h
+ *
+ * DESCRIPTION: Dense membership table header file
+ **********************************/
+
+#ifndef _MEMBERTABLE_H_
+#define _MEMBERTABLE_H_
+
+#include "stdincludes.h"
+#include "Checkpoint.h"
+
+/*
+ * Macros
+ */
+// heartbeat and timestamp of the ids not in the table: never older than a view, never expired
+#define MT_ABSENT INT64_MAX
+// incoming heartbeat of the ids a view says nothing about
+#define MT_NO_NEWS INT64_MIN
+
+/**
+ * CLASS NAME: MemberTable
+ *
+ * DESCRIPTION: Membership table as a structure of arrays indexed by node id: heartbeat,
+ * 				timestamp and position in the membership list. Node ids are small dense
+ * 				integers handed out by the network, so merging a gossiped view is an
+ * 				element-wise max over a range of ids and failure detection a compare over
+ * 				the timestamps, 4 ids at a time with AVX2 when the CPU has it.
+ */
+class MemberTable {
+private:
+	vector<int64_t> heartbeat;
+	vector<int64_t> timestamp;
+	vector<int> position;
+	int count;
+	// ids staged for the next merge lie in [stagedLow, stagedHigh]
+	int stagedLow;
+	int stagedHigh;
+	// heartbeats staged for the next merge, MT_NO_NEWS everywhere else
+	static thread_local vector<int64_t> incoming;
+	void reserve(int id);
+public:
+	// the AVX2 kernels are used, on by default when the CPU has AVX2
+	static bool useAvx2;
+	MemberTable();
+	void clear();
+	int size() {
+		return count;
+	}
+	bool contains(int id) {
+		return id >= 0 && id < (int)position.size() && position[id] >= 0;
+	}
+	int positionOf(int id) {
+		return contains(id) ? position[id] : -1;
+	}
+	int64_t heartbeatOf(int id) {
+		return heartbeat[id];
+	}
+	int64_t timestampOf(int id) {
+		return timestamp[id];
+	}
+	void add(int id, int pos, int64_t hb, int64_t ts);
+	void remove(int id);
+	void moved(int id, int pos);
+	void touch(int id, int64_t now);
+	void stage(int id, int64_t hb);
+	int merge(int64_t now);
+	int expired(int64_t now, int64_t timeout, vector<int> &ids);
+	void checkpoint(Checkpoint *ck);
+	void restore(Checkpoint *ck);
+	static int mergeScalar(int64_t *hb, int64_t *ts, int64_t *in, int n, int64_t now);
+	static int mergeAvx2(int64_t *hb, int64_t *ts, int64_t *in, int n, int64_t now);
+	static int expiredScalar(int64_t *ts, int n, int64_t limit, int first, vector<int> &ids);
+	static int expiredAvx2(int64_t *ts, int n, int64_t limit, int first, vector<int> &ids);
+};
+
+#endif /* _MEMBERTABLE_H_ */
@@ -8,14 +8,15 @@
 /**
  * Constructor
  */
-// transID::fromAddr::CREATE::key::value::ReplicaType
+// transID::fromAddr::CREATE::key::value::ReplicaType::version
 // transID::fromAddr::READ::key
-// transID::fromAddr::UPDATE::key::value::ReplicaType
+// transID::fromAddr::UPDATE::key::value::ReplicaType::version
 // transID::fromAddr::DELETE::key
 // transID::fromAddr::REPLY::sucess
-// transID::fromAddr::READREPLY::value
+// transID::fromAddr::READREPLY::value::version
 Message::Message(string message){
 	this->delimiter = "::";
+	version = 0;
 	vector<string> tuple;
 	size_t pos = message.find(delimiter);
 	size_t start = 0;
@@ -38,6 +39,8 @@ Message::Message(string message){
 			value = tuple.at(4);
 			if (tuple.size() > 5)
 				replica = static_cast<ReplicaType>(stoi(tuple.at(5)));
+			if (tuple.size() > 6)
+				version = stol(tuple.at(6));
 			break;
 		case READ:
 		case DELETE:
@@ -51,6 +54,10 @@ Message::Message(string message){
 			break;
 		case READREPLY:
 			value = tuple.at(3);
+			// a read succeeds when it finds a value
+			success = !value.empty();
+			if (tuple.size() > 4)
+				version = stol(tuple.at(4));
 			break;
 	}
 }
@@ -61,6 +68,7 @@ Message::Message(string message){
 // construct a create or update message
 Message::Message(int _transID, Address _fromAddr, MessageType _type, string _key, string _value, ReplicaType _replica){
 	this->delimiter = "::";
+	version = 0;
 	transID = _transID;
 	fromAddr = _fromAddr;
 	type = _type;
@@ -78,6 +86,7 @@ Message::Message(const Message& anotherMessage) {
 	this->key = anotherMessage.key;
 	this->replica = anotherMessage.replica;
 	this->success = anotherMessage.success;
+	this->version = anotherMessage.version;
 	this->transID = anotherMessage.transID;
 	this->type = anotherMessage.type;
 	this->value = anotherMessage.value;
@@ -88,11 +97,13 @@ Message::Message(const Message& anotherMessage) {
  */
 Message::Message(int _transID, Address _fromAddr, MessageType _type, string _key, string _value){
 	this->delimiter = "::";
+	version = 0;
 	transID = _transID;
 	fromAddr = _fromAddr;
 	type = _type;
 	key = _key;
 	value = _value;
+	replica = PRIMARY;
 }
 
 /**
@@ -101,6 +112,7 @@ Message::Message(int _transID, Address _fromAddr, MessageType _type, string _key
 // construct a read or delete message
 Message::Message(int _transID, Address _fromAddr, MessageType _type, string _key){
 	this->delimiter = "::";
+	version = 0;
 	transID = _transID;
 	fromAddr = _fromAddr;
 	type = _type;
@@ -113,6 +125,7 @@ Message::Message(int _transID, Address _fromAddr, MessageType _type, string _key
 // construct reply message
 Message::Message(int _transID, Address _fromAddr, MessageType _type, bool _success){
 	this->delimiter = "::";
+	version = 0;
 	transID = _transID;
 	fromAddr = _fromAddr;
 	type = _type;
@@ -125,6 +138,7 @@ Message::Message(int _transID, Address _fromAddr, MessageType _type, bool _succe
 // construct read reply message
 Message::Message(int _transID, Address _fromAddr, string _value){
 	this->delimiter = "::";
+	version = 0;
 	transID = _transID;
 	fromAddr = _fromAddr;
 	type = READREPLY;
@@ -141,7 +155,7 @@ string Message::toString(){
 	switch(type){
 		case CREATE:
 		case UPDATE:
-			message += key + delimiter + value + delimiter + to_string(replica);
+			message += key + delimiter + value + delimiter + to_string(replica) + delimiter + to_string(version);
 			break;
 		case READ:
 		case DELETE:
@@ -154,7 +168,7 @@ string Message::toString(){
 				message += "0";
 			break;
 		case READREPLY:
-			message += value;
+			message += value + delimiter + to_string(version);
 			break;
 	}
 	return message;
@@ -169,6 +183,7 @@ Message& Message::operator =(const Message& anotherMessage) {
 	this->key = anotherMessage.key;
 	this->replica = anotherMessage.replica;
 	this->success = anotherMessage.success;
+	this->version = anotherMessage.version;
 	this->transID = anotherMessage.transID;
 	this->type = anotherMessage.type;
 	this->value = anotherMessage.value;
@@ -24,6 +24,7 @@ public:
 	Address fromAddr;
 	int transID;
 	bool success; // success or not 
+	long version; // version of the value of a write or read reply
 	// delimiter
 	string delimiter;
 	// construct a message from a string
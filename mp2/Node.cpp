@@ -27,10 +27,11 @@ Node::~Node() {}
 /**
  * FUNCTION NAME: computeHashCode
  *
- * DESCRIPTION: This function computes the hash code of the node address
+ * DESCRIPTION: This function computes the hash code of the node address,
+ * 				over all its bytes
  */
 void Node::computeHashCode() {
-	nodeHashCode = hashFunc(nodeAddress.addr)%RING_SIZE;
+	nodeHashCode = ringHash(nodeAddress.addr, sizeof(nodeAddress.addr));
 }
 
 /**
@@ -52,9 +53,13 @@ Node& Node::operator=(const Node& another) {
 
 /**
  * operator overloading
+ * Nodes at the same position are ordered by address, every node builds the same ring
  */
 bool Node::operator < (const Node& another) const {
-	return this->nodeHashCode < another.nodeHashCode;
+	if ( this->nodeHashCode != another.nodeHashCode ) {
+		return this->nodeHashCode < another.nodeHashCode;
+	}
+	return memcmp(this->nodeAddress.addr, another.nodeAddress.addr, sizeof(nodeAddress.addr)) < 0;
 }
 
 /**
@@ -62,7 +67,7 @@ bool Node::operator < (const Node& another) const {
  *
  * DESCRIPTION: return hash code of the node
  */
-size_t Node::getHashCode() {
+uint64_t Node::getHashCode() {
 	return nodeHashCode;
 }
 
@@ -80,7 +85,7 @@ Address * Node::getAddress() {
  *
  * DESCRIPTION: set the hash code of the node
  */
-void Node::setHashCode(size_t hashCode) {
+void Node::setHashCode(uint64_t hashCode) {
 	this->nodeHashCode = hashCode;
 }
 
@@ -17,15 +17,158 @@ Params::Params(): PORTNUM(8001) {}
  * DESCRIPTION: Set the parameters for this test case
  */
 void Params::setparams(char *config_file) {
-	//trace.funcEntry("Params::setparams");
+	TRACE_CALL_SPAN("Params::setparams", NULL);
 	char CRUD[10];
+	char line[256];
+	char key[64];
+	char value[64];
+	int from, to;
 	FILE *fp = fopen(config_file,"r");
 
-	fscanf(fp,"MAX_NNB: %d", &MAX_NNB);
-	fscanf(fp,"\nSINGLE_FAILURE: %d", &SINGLE_FAILURE);
-	fscanf(fp,"\nDROP_MSG: %d", &DROP_MSG);
-	fscanf(fp,"\nMSG_DROP_PROB: %lf", &MSG_DROP_PROB);
-	fscanf(fp,"\nCRUD_TEST: %s", CRUD);
+	SINGLE_FAILURE = 0;
+	DROP_MSG = 0;
+	MSG_DROP_PROB = 0;
+	CRUD[0] = 0;
+	// YCSB workload B unless the test case says otherwise
+	WORKLOAD_RECORDS = 0;
+	WORKLOAD_OPS = 1000;
+	WORKLOAD_RATE = 10;
+	WORKLOAD_DIST = ZIPFIAN_KEYS;
+	WORKLOAD_READ = 95;
+	WORKLOAD_UPDATE = 5;
+	WORKLOAD_INSERT = 0;
+	WORKLOAD_DELETE = 0;
+	KEY_SIZE_MIN = KEY_SIZE_MAX = 10;
+	VALUE_SIZE_MIN = VALUE_SIZE_MAX = 100;
+	// a different run every time unless the test case pins the seed
+	SEED = time(NULL);
+	TRANSPORT = EMUL_TRANSPORT;
+	STEP_RATE = DEFAULT_STEP_RATE;
+	BUFFER_SIZE = ENBUFFSIZE;
+	INBOX_SIZE = 0;
+	MEMBER_TABLE = 0;
+	PIGGYBACK = 1;
+	INTRODUCERS.assign(1, 1);
+	NODE_PROCS = 0;
+	UDP_PORT = 20000;
+	TICK_MS = 0;
+	EVENT_TRACE = 0;
+	SPAN_TRACE = 0;
+	CHECKPOINT_AT = -1;
+	RESTORE.clear();
+	BOOTSTRAP = 0;
+	LINK_DELAY.type = FIXED_DELAY;
+	LINK_DELAY.a = 0;
+	LINK_DELAY.b = 0;
+	NODE_BANDWIDTH = 0;
+	linkDelays.clear();
+	nodeBandwidths.clear();
+	linkModel = 0;
+	nodeProcess = 0;
+	epochMs = 0;
+
+	// One "KEY: value" per line, in any order
+	while ( fgets(line, sizeof(line), fp) != NULL ) {
+		if ( sscanf(line, " %63[^: ]: %63s", key, value) != 2 ) {
+			continue;
+		}
+		if ( 0 == strcmp(key, "MAX_NNB") ) {
+			MAX_NNB = atoi(value);
+		}
+		else if ( 0 == strcmp(key, "SINGLE_FAILURE") ) {
+			SINGLE_FAILURE = atoi(value);
+		}
+		else if ( 0 == strcmp(key, "DROP_MSG") ) {
+			DROP_MSG = atoi(value);
+		}
+		else if ( 0 == strcmp(key, "MSG_DROP_PROB") ) {
+			MSG_DROP_PROB = atof(value);
+		}
+		else if ( 0 == strcmp(key, "CRUD_TEST") ) {
+			strncpy(CRUD, value, sizeof(CRUD) - 1);
+			CRUD[sizeof(CRUD) - 1] = 0;
+		}
+		else if ( 0 == strcmp(key, "STEP_RATE") ) {
+			STEP_RATE = atof(value);
+		}
+		else if ( 0 == strcmp(key, "BUFFER_SIZE") ) {
+			BUFFER_SIZE = atoi(value);
+		}
+		else if ( 0 == strcmp(key, "INBOX_SIZE") ) {
+			INBOX_SIZE = atoi(value);
+		}
+		else if ( 0 == strcmp(key, "PIGGYBACK") ) {
+			PIGGYBACK = atoi(value);
+		}
+		else if ( 0 == strcmp(key, "MEMBER_TABLE") ) {
+			MEMBER_TABLE = atoi(value);
+		}
+		else if ( 0 == strcmp(key, "INTRODUCERS") ) {
+			setintroducers(value);
+		}
+		else if ( 0 == strcmp(key, "SEED") ) {
+			SEED = strtoull(value, NULL, 10);
+		}
+		else if ( 0 == strcmp(key, "TRANSPORT") ) {
+			settransport(value);
+		}
+		else if ( 0 == strcmp(key, "UDP_PORT") ) {
+			UDP_PORT = atoi(value);
+		}
+		else if ( 0 == strcmp(key, "TICK_MS") ) {
+			TICK_MS = atoi(value);
+		}
+		else if ( 0 == strcmp(key, "EVENT_TRACE") ) {
+			EVENT_TRACE = atoi(value);
+		}
+		else if ( 0 == strcmp(key, "SPAN_TRACE") ) {
+			SPAN_TRACE = atoi(value);
+		}
+		else if ( 0 == strcmp(key, "CHECKPOINT_AT") ) {
+			CHECKPOINT_AT = atoi(value);
+		}
+		else if ( 0 == strcmp(key, "RESTORE") ) {
+			RESTORE = value;
+		}
+		else if ( 0 == strcmp(key, "BOOTSTRAP") ) {
+			BOOTSTRAP = atoi(value);
+		}
+		else if ( 0 == strcmp(key, "WORKLOAD_RECORDS") ) {
+			WORKLOAD_RECORDS = atoi(value);
+		}
+		else if ( 0 == strcmp(key, "WORKLOAD_OPS") ) {
+			WORKLOAD_OPS = atoi(value);
+		}
+		else if ( 0 == strcmp(key, "WORKLOAD_RATE") ) {
+			WORKLOAD_RATE = atof(value);
+		}
+		else if ( 0 == strcmp(key, "WORKLOAD_DISTRIBUTION") ) {
+			WORKLOAD_DIST = (0 == strcmp(value, "uniform")) ? UNIFORM_KEYS : ((0 == strcmp(value, "latest")) ? LATEST_KEYS : ZIPFIAN_KEYS);
+		}
+		else if ( 0 == strcmp(key, "WORKLOAD_MIX") ) {
+			sscanf(value, "%lf,%lf,%lf,%lf", &WORKLOAD_READ, &WORKLOAD_UPDATE, &WORKLOAD_INSERT, &WORKLOAD_DELETE);
+		}
+		else if ( 0 == strcmp(key, "KEY_SIZE") ) {
+			setsizes(&KEY_SIZE_MIN, &KEY_SIZE_MAX, value);
+		}
+		else if ( 0 == strcmp(key, "VALUE_SIZE") ) {
+			setsizes(&VALUE_SIZE_MIN, &VALUE_SIZE_MAX, value);
+		}
+		else if ( 0 == strcmp(key, "LINK_DELAY") ) {
+			setlinkdelay(&LINK_DELAY, value);
+		}
+		else if ( 2 == sscanf(key, "LINK_DELAY_%d_%d", &from, &to) ) {
+			setlinkdelay(&linkDelays[make_pair(from, to)], value);
+		}
+		else if ( 0 == strcmp(key, "NODE_BANDWIDTH") ) {
+			NODE_BANDWIDTH = atoi(value);
+			linkModel = 1;
+		}
+		else if ( 1 == sscanf(key, "NODE_BANDWIDTH_%d", &from) ) {
+			nodeBandwidths[from] = atoi(value);
+			linkModel = 1;
+		}
+	}
 
 	if ( 0 == strcmp(CRUD, "CREATE") ) {
 		this->CRUDTEST = CREATE_TEST;
@@ -43,19 +186,179 @@ void Params::setparams(char *config_file) {
 	//printf("Parameters of the test case: %d %d %d %lf\n", MAX_NNB, SINGLE_FAILURE, DROP_MSG, MSG_DROP_PROB);
 
 	EN_GPSZ = MAX_NNB;
-	STEP_RATE=.25;
 	MAX_MSG_SIZE = 4000;
 	globaltime = 0;
 	dropmsg = 0;
-	allNodesJoined = 0;
-	for ( unsigned int i = 0; i < EN_GPSZ; i++ ) {
-		allNodesJoined += i;
-	}
+	// the node numbers added up, 0 to EN_GPSZ - 1
+	allNodesJoined = (long)EN_GPSZ * (EN_GPSZ - 1) / 2;
 	fclose(fp);
-	//trace.funcExit("Params::setparams", SUCCESS);
+	// nobody would boot the group or answer the JOINREQs sent to a node that does not exist
+	if ( checkintroducers() == FAILURE ) {
+		fprintf(stderr, "%s: INTRODUCERS are node ids from 1 to %d\n", config_file, EN_GPSZ);
+		exit(FAILURE);
+	}
 	return;
 }
 
+/**
+ * FUNCTION NAME: settransport
+ *
+ * DESCRIPTION: Pick the network by name: emul, udp or shm runs all the nodes in this process,
+ * 				udp-procs or shm-procs runs one process per node
+ *
+ * RETURNS:
+ * FAILURE for an unknown name
+ */
+int Params::settransport(char *name) {
+	int len = strlen(name);
+	int procs = (len > 6 && 0 == strcmp(name + len - 6, "-procs"));
+	string network(name, procs ? len - 6 : len);
+
+	if ( network == "emul" && !procs ) {
+		TRANSPORT = EMUL_TRANSPORT;
+	}
+	else if ( network == "udp" ) {
+		TRANSPORT = UDP_TRANSPORT;
+	}
+	else if ( network == "shm" ) {
+		TRANSPORT = SHM_TRANSPORT;
+	}
+	else {
+		return FAILURE;
+	}
+	NODE_PROCS = procs;
+	// node processes can only agree on the time through the wall clock
+	if ( NODE_PROCS && TICK_MS <= 0 ) {
+		TICK_MS = 20;
+	}
+	return SUCCESS;
+}
+
+/**
+ * FUNCTION NAME: setintroducers
+ *
+ * DESCRIPTION: Parse the introducers, node ids separated by commas
+ *
+ * RETURNS:
+ * FAILURE for anything but node ids, the introducers are left as they are
+ */
+int Params::setintroducers(const char *value) {
+	vector<int> ids;
+	char *end;
+
+	for ( const char *p = value; *p != 0; p = (*end == ',') ? end + 1 : end ) {
+		long id = strtol(p, &end, 10);
+		if ( end == p || id < 1 ) {
+			return FAILURE;
+		}
+		ids.push_back((int)id);
+	}
+	if ( ids.empty() ) {
+		return FAILURE;
+	}
+	INTRODUCERS.swap(ids);
+	return SUCCESS;
+}
+
+/**
+ * FUNCTION NAME: checkintroducers
+ *
+ * DESCRIPTION: Check that the introducers are nodes of the group, once EN_GPSZ is known
+ *
+ * RETURNS:
+ * FAILURE if an introducer id is above EN_GPSZ
+ */
+int Params::checkintroducers() {
+	for ( unsigned int i = 0; i < INTRODUCERS.size(); i++ ) {
+		if ( INTRODUCERS[i] > EN_GPSZ ) {
+			return FAILURE;
+		}
+	}
+	return SUCCESS;
+}
+
+/**
+ * FUNCTION NAME: setlinkdelay
+ *
+ * DESCRIPTION: Parse a delay distribution in ticks: fixed,<ticks>, uniform,<lowest>,<highest>
+ * 				or lognormal,<median>,<sigma>
+ *
+ * RETURNS:
+ * FAILURE for an unknown distribution
+ */
+int Params::setlinkdelay(LinkDelay *delay, char *value) {
+	char name[16];
+	double a = 0, b = 0;
+
+	if ( sscanf(value, "%15[^,],%lf,%lf", name, &a, &b) < 2 ) {
+		return FAILURE;
+	}
+	if ( 0 == strcmp(name, "fixed") ) {
+		delay->type = FIXED_DELAY;
+	}
+	else if ( 0 == strcmp(name, "uniform") ) {
+		delay->type = UNIFORM_DELAY;
+	}
+	else if ( 0 == strcmp(name, "lognormal") ) {
+		delay->type = LOGNORMAL_DELAY;
+	}
+	else {
+		return FAILURE;
+	}
+	delay->a = a;
+	delay->b = b;
+	linkModel = 1;
+	return SUCCESS;
+}
+
+/**
+ * FUNCTION NAME: setsizes
+ *
+ * DESCRIPTION: Parse a length, or the shortest and longest length as <shortest>,<longest>
+ *
+ * RETURNS:
+ * FAILURE unless 0 < shortest <= longest
+ */
+int Params::setsizes(int *shortest, int *longest, char *value) {
+	int a, b;
+
+	switch ( sscanf(value, "%d,%d", &a, &b) ) {
+	case 1:
+		b = a;
+		break;
+	case 2:
+		break;
+	default:
+		return FAILURE;
+	}
+	if ( a <= 0 || b < a ) {
+		return FAILURE;
+	}
+	*shortest = a;
+	*longest = b;
+	return SUCCESS;
+}
+
+/**
+ * FUNCTION NAME: getlinkdelay
+ *
+ * DESCRIPTION: Delay distribution of the link between two nodes
+ */
+LinkDelay *Params::getlinkdelay(int from, int to) {
+	map<pair<int, int>, LinkDelay>::iterator it = linkDelays.find(make_pair(from, to));
+	return (it != linkDelays.end()) ? &it->second : &LINK_DELAY;
+}
+
+/**
+ * FUNCTION NAME: getbandwidth
+ *
+ * DESCRIPTION: Egress bytes per tick of a node, 0 for no cap
+ */
+int Params::getbandwidth(int node) {
+	map<int, int>::iterator it = nodeBandwidths.find(node);
+	return (it != nodeBandwidths.end()) ? it->second : NODE_BANDWIDTH;
+}
+
 /**
  * FUNCTION NAME: getcurrtime
  *
@@ -65,3 +368,43 @@ void Params::setparams(char *config_file) {
 int Params::getcurrtime(){
     return globaltime;
 }
+
+/**
+ * FUNCTION NAME: startwallclock
+ *
+ * DESCRIPTION: Tick 0 of the wall clock starts delayMs from now
+ */
+void Params::startwallclock(long delayMs) {
+	epochMs = 0;
+	epochMs = getwallclockms() + delayMs;
+}
+
+/**
+ * FUNCTION NAME: getwallclockms
+ *
+ * DESCRIPTION: Milliseconds of the monotonic clock since epochMs.
+ * 				The clock is shared by all processes of the host.
+ */
+long Params::getwallclockms() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L - epochMs;
+}
+
+/**
+ * FUNCTION NAME: getwallclocktime
+ *
+ * DESCRIPTION: Wall clock version of getcurrtime, in time units of TICK_MS.
+ * 				When TICK_MS is set the application latches it into globaltime at the
+ * 				start of every tick, so a tick sees a single time however long it takes.
+ *
+ * RETURNS:
+ * -1 before epochMs
+ */
+int Params::getwallclocktime() {
+	long ms = getwallclockms();
+	if ( ms < 0 || TICK_MS <= 0 ) {
+		return -1;
+	}
+	return (int)(ms / TICK_MS);
+}
@@ -1,7 +1,7 @@
 /**********************************
  * FILE NAME: Queue.h
  *
- * DESCRIPTION: Header file for std::<queue> related functions
+ * DESCRIPTION: Header file for the node message queue functions
  **********************************/
 
 #ifndef QUEUE_H_
@@ -13,15 +13,19 @@
 /**
  * Class name: Queue
  *
- * Description: This function wraps std::queue related functions
+ * Description: This function wraps MsgQueue related functions
  */
 class Queue {
 public:
 	Queue() {}
 	virtual ~Queue() {}
-	static bool enqueue(queue<q_elt> *queue, void *buffer, int size) {
+	// the queue owns the buffer, a full one frees it
+	static bool enqueue(MsgQueue *queue, void *buffer, int size) {
 		q_elt element(buffer, size);
-		queue->emplace(element);
+		if ( !queue->push(element) ) {
+			free(buffer);
+			return false;
+		}
 		return true;
 	}
 };
@@ -0,0 +1,43 @@
+/**********************************
+ * FILE NAME: Random.h
+ *
+ * DESCRIPTION: Header file of the seedable random number streams
+ **********************************/
+
+#ifndef _RANDOM_H_
+#define _RANDOM_H_
+
+#include "stdincludes.h"
+
+/**
+ * Subsystems drawing random numbers, each gets its own streams. The values seed the streams,
+ * so they are the same in mp1 and mp2 and new subsystems go at the end.
+ */
+enum RandomSubsystem {
+	RNG_NET,		// message drops, one stream per sending node
+	RNG_FAIL,		// choice of the nodes to fail
+	RNG_CLIENT,		// choice of the node a client operation is sent to
+	RNG_WORKLOAD,	// generation of the test key value pairs
+	RNG_DELAY		// link delays, one stream per sending node
+};
+
+/**
+ * CLASS NAME: Random
+ *
+ * DESCRIPTION: xoshiro256** generator. The state of a stream is derived with splitmix64
+ * 				from the run seed, the subsystem and the stream id (usually a node id),
+ * 				so streams are independent of each other and of the order in which they are used.
+ */
+class Random {
+private:
+	uint64_t s[4];
+public:
+	Random();
+	Random(uint64_t seed, int subsystem, int stream);
+	void seed(uint64_t seed, int subsystem, int stream);
+	uint64_t next();
+	uint32_t nextInt(uint32_t bound);
+	double nextDouble();
+};
+
+#endif /* _RANDOM_H_ */
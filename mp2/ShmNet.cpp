@@ -0,0 +1,333 @@
+/**********************************
+ * FILE NAME: ShmNet.cpp
+ *
+ * DESCRIPTION: Shared memory network classes definition
+ **********************************/
+
+#include "ShmNet.h"
+
+/**
+ * Constructor
+ */
+ShmNet::ShmNet(Params *p, int netId)
+{
+	int i;
+	int memfd;
+	par = p;
+	// Node ids handed out by ENinit run from 1 to EN_GPSZ
+	rng.resize(par->EN_GPSZ + 1);
+	efd.assign(par->EN_GPSZ + 1, -1);
+	local.assign(par->EN_GPSZ + 1, false);
+	// streams of different networks must not repeat each other's drops
+	for ( i = 0; i <= par->EN_GPSZ; i++ ) {
+		rng[i].seed(par->SEED, RNG_NET, netId * NET_NODE_STREAMS + i);
+	}
+	nextid = 1;
+	sched = NULL;
+	recvEvent = EV_MP1_RECV;
+
+	// A fresh memfd is all zeros: every ring is empty
+	segSize = par->EN_GPSZ * sizeof(ShmRing);
+	memfd = memfd_create("shmnet", MFD_CLOEXEC);
+	if ( memfd < 0 || ftruncate(memfd, segSize) < 0 ) {
+		perror("memfd_create");
+		exit(1);
+	}
+	rings = (ShmRing *) mmap(NULL, segSize, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+	if ( rings == MAP_FAILED ) {
+		perror("mmap");
+		exit(1);
+	}
+	close(memfd);
+
+	for ( i = 1; i <= par->EN_GPSZ; i++ ) {
+		efd[i] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if ( efd[i] < 0 ) {
+			perror("eventfd");
+			exit(1);
+		}
+	}
+	counts.init(par->EN_GPSZ);
+}
+
+/**
+ * Destructor
+ */
+ShmNet::~ShmNet() {
+	for ( int i = 0; i < (int)efd.size(); i++ ) {
+		if ( efd[i] >= 0 ) {
+			close(efd[i]);
+		}
+	}
+	munmap(rings, segSize);
+}
+
+/**
+ * FUNCTION NAME: ENinit
+ *
+ * DESCRIPTION: Init the network for this node.
+ * 				Ids are handed out in the same order in every process,
+ * 				a process only consumes the rings of the nodes it runs.
+ */
+void *ShmNet::ENinit(Address *myaddr, short port) {
+	int id = nextid++;
+
+	*(int *)(myaddr->addr) = id;
+	*(short *)(&myaddr->addr[4]) = 0;
+
+	assert(id <= par->EN_GPSZ);
+
+	local[id] = (par->nodeProcess == 0 || par->nodeProcess == id);
+	return myaddr;
+}
+
+/**
+ * FUNCTION NAME: ENsend
+ *
+ * DESCRIPTION: ShmNet send function.
+ * 				Reserves room in the ring of the destination, copies the message in
+ * 				and publishes it. A record that would run past the end of the ring
+ * 				is preceded by a skip record filling the end.
+ *
+ * RETURNS:
+ * size
+ */
+int ShmNet::ENsend(Address *myaddr, Address *toaddr, char *data, int size) {
+	ShmRing *ring;
+	ShmRecord *rec;
+	en_msg *em;
+	uint64_t h, off, skip, len;
+	uint64_t one = 1;
+	int src = *(int *)(myaddr->addr);
+	int dst = *(int *)(toaddr->addr);
+
+	assert(src >= 1 && src <= par->EN_GPSZ);
+
+	// every sender draws from its own stream
+	int drop = rng[src].nextInt(100);
+
+	if( (dst < 1) || (dst > par->EN_GPSZ) || !local[src] || (size + (int)sizeof(en_msg) >= par->MAX_MSG_SIZE) ) {
+		return 0;
+	}
+	if ( par->dropmsg && drop < (int) (par->MSG_DROP_PROB * 100) ) {
+		counts.countDrop(src, RANDOM_DROP);
+		return 0;
+	}
+
+	ring = &rings[dst - 1];
+	len = (sizeof(ShmRecord) + sizeof(en_msg) + size + SHM_ALIGN - 1) & ~(uint64_t)(SHM_ALIGN - 1);
+
+	do {
+		h = ring->head.load(memory_order_relaxed);
+		off = h & (SHM_RING_SIZE - 1);
+		skip = (off + len > SHM_RING_SIZE) ? SHM_RING_SIZE - off : 0;
+		// A full ring loses the message, as a full socket buffer would
+		if ( h + skip + len - ring->tail.load(memory_order_acquire) > SHM_RING_SIZE ) {
+			counts.countDrop(src, OVERFLOW_DROP);
+			return 0;
+		}
+	} while ( !ring->head.compare_exchange_weak(h, h + skip + len, memory_order_relaxed) );
+
+	// Positions are stored plus one, zeroed memory never looks like a record
+	if ( skip != 0 ) {
+		rec = (ShmRecord *)(ring->data + off);
+		rec->size = -1;
+		rec->pos.store(h + 1, memory_order_release);
+		h += skip;
+	}
+
+	rec = (ShmRecord *)(ring->data + (h & (SHM_RING_SIZE - 1)));
+	rec->size = sizeof(en_msg) + size;
+	em = (en_msg *)(rec + 1);
+	em->size = size;
+	em->channel = 0;
+	memcpy(&(em->from.addr), &(myaddr->addr), sizeof(em->from.addr));
+	memcpy(&(em->to.addr), &(toaddr->addr), sizeof(em->to.addr));
+	memcpy((char *)(em + 1), data, size);
+	rec->pos.store(h + 1, memory_order_seq_cst);
+
+	// Only a node about to sleep costs a syscall
+	if ( ring->sleeping.load(memory_order_seq_cst) && ring->sleeping.exchange(0) ) {
+		if ( write(efd[dst], &one, sizeof(one)) < 0 ) {
+			perror("write eventfd");
+		}
+	}
+
+	counts.countSent(src, par->getcurrtime());
+
+	// Node ids handed out by ENinit start at 1
+	if ( sched != NULL && local[dst] ) {
+		sched->post(dst - 1, recvEvent);
+	}
+
+	return size;
+}
+
+/**
+ * FUNCTION NAME: ENrecv
+ *
+ * DESCRIPTION: ShmNet receive function, drains the ring of the node.
+ * 				Consumed records are zeroed before the room is handed back to the producers.
+ *
+ * RETURN:
+ * 0
+ */
+int ShmNet::ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue){
+	// times is always assumed to be 1
+	ShmRing *ring;
+	ShmRecord *rec;
+	en_msg *emsg;
+	uint64_t tail, len;
+	char* tmp;
+	int sz;
+	int dst = *(int *)(myaddr->addr);
+
+	if ( dst < 1 || dst > par->EN_GPSZ || !local[dst] ) {
+		return 0;
+	}
+
+	ring = &rings[dst - 1];
+	tail = ring->tail.load(memory_order_relaxed);
+
+	while ( true ) {
+		rec = (ShmRecord *)(ring->data + (tail & (SHM_RING_SIZE - 1)));
+		// empty, or the next record is still being written
+		if ( rec->pos.load(memory_order_acquire) != tail + 1 ) {
+			break;
+		}
+
+		if ( rec->size < 0 ) {
+			len = SHM_RING_SIZE - (tail & (SHM_RING_SIZE - 1));
+		}
+		else {
+			len = (sizeof(ShmRecord) + rec->size + SHM_ALIGN - 1) & ~(uint64_t)(SHM_ALIGN - 1);
+			emsg = (en_msg *)(rec + 1);
+			sz = emsg->size;
+			tmp = (char *) malloc(sz * sizeof(char));
+			memcpy(tmp, (char *)(emsg+1), sz);
+
+			(*enq)(queue, (char *)tmp, sz);
+
+			counts.countRecv(dst, par->getcurrtime());
+		}
+
+		memset((void *)rec, 0, len);
+		tail += len;
+		ring->tail.store(tail, memory_order_release);
+	}
+
+	return 0;
+}
+
+/**
+ * FUNCTION NAME: ENcongested
+ *
+ * DESCRIPTION: Whether CONGESTION_LEVEL of the ring of the node is taken
+ *
+ * RETURNS:
+ * true if the node is congested
+ */
+bool ShmNet::ENcongested(Address *toaddr) {
+	int dst = *(int *)(toaddr->addr);
+
+	if ( (dst < 1) || (dst > par->EN_GPSZ) ) {
+		return false;
+	}
+	ShmRing *ring = &rings[dst - 1];
+	uint64_t used = ring->head.load(memory_order_relaxed) - ring->tail.load(memory_order_relaxed);
+	return used >= SHM_RING_SIZE * CONGESTION_LEVEL;
+}
+
+/**
+ * FUNCTION NAME: ringEmpty
+ *
+ * DESCRIPTION: Whether the ring of the node has no complete record to consume
+ */
+bool ShmNet::ringEmpty(int id) {
+	ShmRing *ring = &rings[id - 1];
+	uint64_t tail = ring->tail.load(memory_order_relaxed);
+	ShmRecord *rec = (ShmRecord *)(ring->data + (tail & (SHM_RING_SIZE - 1)));
+	return rec->pos.load(memory_order_seq_cst) != tail + 1;
+}
+
+/**
+ * FUNCTION NAME: ENwait
+ *
+ * DESCRIPTION: Post recvEvent for the nodes of this process with records waiting.
+ * 				If there are none, sleep on their eventfds for up to timeout milliseconds.
+ *
+ * RETURNS:
+ * number of nodes posted
+ */
+int ShmNet::ENwait(int timeout) {
+	vector<struct pollfd> fds;
+	struct pollfd pfd;
+	uint64_t count;
+	int i, n = 0;
+
+	for ( i = 1; i <= par->EN_GPSZ; i++ ) {
+		if ( local[i] && !ringEmpty(i) ) {
+			if ( sched != NULL ) {
+				sched->post(i - 1, recvEvent);
+			}
+			n++;
+		}
+	}
+	if ( n > 0 || timeout <= 0 ) {
+		return n;
+	}
+
+	// Producers check the flag after publishing, so a record is either seen here or wakes us up
+	for ( i = 1; i <= par->EN_GPSZ; i++ ) {
+		if ( local[i] ) {
+			rings[i - 1].sleeping.store(1, memory_order_seq_cst);
+			pfd.fd = efd[i];
+			pfd.events = POLLIN;
+			pfd.revents = 0;
+			fds.push_back(pfd);
+		}
+	}
+	for ( i = 1; i <= par->EN_GPSZ && n == 0; i++ ) {
+		if ( local[i] && !ringEmpty(i) ) {
+			n++;
+		}
+	}
+	if ( n == 0 ) {
+		poll(fds.data(), fds.size(), timeout);
+	}
+
+	n = 0;
+	for ( i = 1; i <= par->EN_GPSZ; i++ ) {
+		if ( local[i] ) {
+			rings[i - 1].sleeping.store(0, memory_order_relaxed);
+			while ( read(efd[i], &count, sizeof(count)) > 0 );
+			if ( !ringEmpty(i) ) {
+				if ( sched != NULL ) {
+					sched->post(i - 1, recvEvent);
+				}
+				n++;
+			}
+		}
+	}
+	return n;
+}
+
+/**
+ * FUNCTION NAME: setScheduler
+ *
+ * DESCRIPTION: Post recvEvent to the scheduler for the nodes that have records waiting
+ */
+void ShmNet::setScheduler(Scheduler *sched, EventType recvEvent) {
+	this->sched = sched;
+	this->recvEvent = recvEvent;
+}
+
+/**
+ * FUNCTION NAME: ENcleanup
+ *
+ * DESCRIPTION: Cleanup the ShmNet. Called exactly once at the end of the program.
+ */
+int ShmNet::ENcleanup() {
+	writeMsgCount(par, &counts);
+	return 0;
+}
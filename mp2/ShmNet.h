@@ -0,0 +1,98 @@
+/**********************************
+ * FILE NAME: ShmNet.h
+ *
+ * DESCRIPTION: Shared memory network classes header file
+ **********************************/
+
+#ifndef _SHMNET_H_
+#define _SHMNET_H_
+
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <atomic>
+#include "stdincludes.h"
+#include "Network.h"
+#include "Params.h"
+#include "Member.h"
+#include "Scheduler.h"
+#include "Random.h"
+
+/*
+ * Macros
+ */
+// bytes of the ring of every node, a power of two
+#define SHM_RING_SIZE (1 << 20)
+// records in the rings are aligned to this
+#define SHM_ALIGN 16
+
+/**
+ * STRUCT NAME: ShmRecord
+ *
+ * DESCRIPTION: Header of a record in a ring, followed by an en_msg and the message.
+ * 				pos is written last: a record is complete once pos holds its own position.
+ */
+typedef struct ShmRecord {
+	atomic<uint64_t> pos;
+	// bytes after the header, -1 to skip to the end of the ring
+	int size;
+	int pad;
+}ShmRecord;
+
+/**
+ * STRUCT NAME: ShmRing
+ *
+ * DESCRIPTION: Lock-free multi producer single consumer ring of one node.
+ * 				Producers reserve space by moving head with a CAS, the node consumes at tail.
+ */
+typedef struct ShmRing {
+	atomic<uint64_t> head;
+	char pad1[56];
+	atomic<uint64_t> tail;
+	// set by the node before it sleeps on its eventfd
+	atomic<int> sleeping;
+	char pad2[52];
+	char data[SHM_RING_SIZE];
+}ShmRing;
+
+/**
+ * CLASS NAME: ShmNet
+ *
+ * DESCRIPTION: Network of rings in a memfd segment, one ring per destination node.
+ * 				The segment and the eventfds waking up the nodes are created before
+ * 				node processes are forked, so that they all share them.
+ */
+class ShmNet : public Network
+{
+private:
+	Params* par;
+	int nextid;
+	size_t segSize;
+	ShmRing *rings;
+	// eventfd of every node, for the node processes to sleep on
+	vector<int> efd;
+	// whether the node is run by this process
+	vector<bool> local;
+	MsgCounts counts;
+	// Scheduler notified of messages waiting for a node
+	Scheduler *sched;
+	EventType recvEvent;
+	// Random streams for message drops, indexed by the sending node
+	vector<Random> rng;
+	bool ringEmpty(int id);
+	ShmNet(ShmNet &anotherShmNet);
+	ShmNet& operator = (ShmNet &anotherShmNet);
+public:
+	ShmNet(Params *p, int netId = 0);
+	virtual ~ShmNet();
+	using Network::ENsend;
+	void *ENinit(Address *myaddr, short port);
+	int ENsend(Address *myaddr, Address *toaddr, char *data, int size);
+	int ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue);
+	int ENwait(int timeout);
+	bool ENcongested(Address *toaddr);
+	int ENcleanup();
+	void setScheduler(Scheduler *sched, EventType recvEvent);
+};
+
+#endif /* _SHMNET_H_ */
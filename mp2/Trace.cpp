@@ -17,118 +17,121 @@
  */
 #include "Trace.h"
 
+mutex Trace::lock;
+vector<SpanRing *> Trace::rings;
+thread_local SpanRing *Trace::ring = NULL;
+uint64_t Trace::tscStart = 0;
+long Trace::nsStart = 0;
+bool Trace::enabled = false;
+
 /*****************************************************************
- * NAME: traceFileCreate
- *
- * DESCRIPTION: Function creates a trace file
+ * NAME: monotonicNs
  *
- * RETURN:
- * (int) SUCCESS
- *       ERROR otherwise
+ * DESCRIPTION: Monotonic clock in nanoseconds
  *
  ****************************************************************/
-int Trace::traceFileCreate() {
-
-    int rc = SUCCESS;        // Return code
-
-    logF = fopen(LOG_FILE_LOCATION, "w");
-    if ( NULL == logF )
-    {
-        printf("\nUnable to open log file in write mode\n");
-        rc = FAILURE;
-    }
-
-    return rc;
+static long monotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
 }
 
 /*****************************************************************
- * NAME: printToTrace
+ * NAME: start
  *
- * DESCRIPTION: Function takes care of writing into log
- *
- * PARAMETERS:
- *            (char *) keyMsg - buffer to be written as key
- *            (char *) valueMsg - buffer to be written as value
- *
- * RETURN:
- * (int) SUCCESS
- *       FAILURE otherwise
+ * DESCRIPTION: Start recording spans. The TSC is read against the
+ *              monotonic clock here and again in dump to convert it.
  *
  ****************************************************************/
-int Trace::printToTrace(char *keyMsg, char *valueMsg) {
+void Trace::start() {
 
-    int rc = SUCCESS;        // Return code
-
-    fprintf(logF, "%s : %s\n", keyMsg, valueMsg);
-    fflush(logF);
-
-    return rc;
+    tscStart = now();
+    nsStart = monotonicNs();
+    enabled = true;
 }
 
 /*****************************************************************
- * NAME: traceFileClose
+ * NAME: newRing
  *
- * DESCRIPTION: Function takes care of closing log
+ * DESCRIPTION: Function gives the calling thread a ring of its own
  *
  * RETURN:
- * (int) SUCCESS
- *       ERROR otherwise
+ * (SpanRing *) ring of the thread
  *
  ****************************************************************/
-int Trace::traceFileClose() {
+SpanRing *Trace::newRing() {
 
-    int rc = SUCCESS;
+    lock_guard<mutex> guard(lock);
 
-    fclose(logF);
+    ring = new SpanRing;
+    ring->count = 0;
+    rings.push_back(ring);
 
-    return rc;
+    return ring;
 }
 
 /*****************************************************************
- * NAME: funcEntry
+ * NAME: dump
  *
- * DESCRIPTION: Logs function entry
+ * DESCRIPTION: Function stops recording and writes the spans of all
+ *              threads as Chrome trace events (chrome://tracing, Perfetto).
+ *              Every node is a thread of the process in the viewer,
+ *              the application is thread 0.
  *
  * PARAMETERS:
- *            (char *) keyMsg - ipAddress
- *            (char *) valueMsg - funcName
+ *            (const char *) fileName - file to write
  *
  * RETURN:
- * (int) ZERO if success
- *       ERROR otherwise
+ * (int) SUCCESS
+ *       FAILURE otherwise
  *
  ****************************************************************/
-int Trace::funcEntry(char *funcName) {
+int Trace::dump(const char *fileName) {
 
     int rc = SUCCESS;        // Return code
+    set<int> nodes;
+    FILE *fp;
+    double tscPerUs;
+    long ns;
+    bool first = true;
+    int pid = getpid();
+
+    if ( !enabled ) {
+        return rc;
+    }
+    enabled = false;
 
-    fprintf(logF, "ENTRY - %s\n", funcName);
-    fflush(logF);
+    ns = monotonicNs() - nsStart;
+    tscPerUs = (ns > 0) ? (double)(now() - tscStart) * 1000 / ns : 1;
 
-    return rc;
-}
-
-/*****************************************************************
- * NAME: funcExit
- *
- * DESCRIPTION: Logs function exit
- *
- * PARAMETERS:
- *            (char *) keyMsg - ipAddress
- *            (char *) valueMsg - funcName
- *            (int) f_rc - return code of function
- *
- * RETURN:
- * (int) ZERO if success
- *       ERROR otherwise
- *
- ****************************************************************/
-int Trace::funcExit(char *funcName, int f_rc) {
-
-    int rc = SUCCESS;        // Return code
+    fp = fopen(fileName, "w");
+    if ( NULL == fp )
+    {
+        printf("\nUnable to open %s in write mode\n", fileName);
+        return FAILURE;
+    }
 
-    fprintf(logF, "EXIT - %s with rc = %d\n", funcName, f_rc);
-    fflush(logF);
+    lock_guard<mutex> guard(lock);
+
+    fprintf(fp, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    for ( unsigned int r = 0; r < rings.size(); r++ ) {
+        SpanRing *sr = rings[r];
+        uint64_t from = (sr->count > TRACE_RING_SPANS) ? sr->count - TRACE_RING_SPANS : 0;
+        for ( uint64_t i = from; i < sr->count; i++ ) {
+            SpanRecord *s = &sr->spans[i & (TRACE_RING_SPANS - 1)];
+            fprintf(fp, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    first ? "" : ",", s->name, pid, s->node, (s->start - tscStart) / tscPerUs, (s->end - s->start) / tscPerUs);
+            first = false;
+            nodes.insert(s->node);
+        }
+    }
+    for ( set<int>::iterator it = nodes.begin(); it != nodes.end(); it++ ) {
+        fprintf(fp, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                first ? "" : ",", pid, *it, (*it == 0) ? "application" : ("node " + to_string(*it)).c_str());
+        first = false;
+    }
+    fprintf(fp, "\n]}\n");
+    fclose(fp);
 
     return rc;
 }
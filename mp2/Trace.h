@@ -7,34 +7,142 @@
 #ifndef TRACE_H_
 #define TRACE_H_
 
+#include <mutex>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
 #include "stdincludes.h"
+#include "Member.h"
 
 /*
  * Macros
  */
-#define LOG_FILE_LOCATION "machine.log"
+#define TRACE_FILE "machine.json"
+// spans kept per thread, the oldest are overwritten
+#define TRACE_RING_SPANS (1 << 16)
+
+/*
+ * Trace levels, a span is compiled in when its level is at most TRACE_LEVEL
+ */
+#define TRACE_OFF 0
+#define TRACE_TICK 1	// what a node does in a tick
+#define TRACE_PHASE 2	// the steps of a tick
+#define TRACE_CALL 3	// per message handlers and set up
+
+#ifndef TRACE_LEVEL
+#define TRACE_LEVEL TRACE_PHASE
+#endif
+
+#define TRACE_JOIN(a, b) a##b
+#define TRACE_VAR(line) TRACE_JOIN(traceSpan, line)
+
+/*
+ * TRACE_<LEVEL>_SPAN(name, node) records a span from here to the end of the scope,
+ * node is the Address on whose timeline it goes, NULL for the application
+ */
+#if TRACE_LEVEL >= TRACE_TICK
+#define TRACE_TICK_SPAN(name, node) TraceSpan TRACE_VAR(__LINE__)(name, node)
+#else
+#define TRACE_TICK_SPAN(name, node)
+#endif
+
+#if TRACE_LEVEL >= TRACE_PHASE
+#define TRACE_PHASE_SPAN(name, node) TraceSpan TRACE_VAR(__LINE__)(name, node)
+#else
+#define TRACE_PHASE_SPAN(name, node)
+#endif
+
+#if TRACE_LEVEL >= TRACE_CALL
+#define TRACE_CALL_SPAN(name, node) TraceSpan TRACE_VAR(__LINE__)(name, node)
+#else
+#define TRACE_CALL_SPAN(name, node)
+#endif
+
+/**
+ * STRUCT NAME: SpanRecord
+ *
+ * DESCRIPTION: A finished span, in TSC ticks
+ */
+typedef struct SpanRecord {
+	const char *name;
+	uint64_t start;
+	uint64_t end;
+	int node;
+}SpanRecord;
+
+/**
+ * STRUCT NAME: SpanRing
+ *
+ * DESCRIPTION: The spans of one thread, only that thread writes it
+ */
+typedef struct SpanRing {
+	SpanRecord spans[TRACE_RING_SPANS];
+	uint64_t count;
+}SpanRing;
 
 /**
  * CLASS NAME: Trace
  *
- * DESCRIPTION: Creates a trace of function entry, exit and variable values for debugging
+ * DESCRIPTION: Collects the spans of every thread of the process in memory
+ * 				and writes them out in Chrome trace event JSON, one timeline per node
  */
 class Trace {
+private:
+	static mutex lock;
+	static vector<SpanRing *> rings;
+	static thread_local SpanRing *ring;
+	static uint64_t tscStart;
+	static long nsStart;
+	static SpanRing *newRing();
+public:
+	// spans are only recorded between start and dump
+	static bool enabled;
+	static void start();
+	static int dump(const char *fileName);
+	static uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+#else
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#endif
+	}
+	static void record(const char *name, uint64_t start, int node) {
+		SpanRing *r = (ring != NULL) ? ring : newRing();
+		SpanRecord *s = &r->spans[r->count++ & (TRACE_RING_SPANS - 1)];
+		s->name = name;
+		s->start = start;
+		s->end = now();
+		s->node = node;
+	}
+};
+
+/**
+ * CLASS NAME: TraceSpan
+ *
+ * DESCRIPTION: Records the time from its construction to the end of its scope
+ */
+class TraceSpan {
+private:
+	const char *name;
+	uint64_t start;
+	int node;
+	TraceSpan(TraceSpan &anotherTraceSpan);
+	TraceSpan& operator = (TraceSpan &anotherTraceSpan);
 public:
-	FILE *logF;
-	int traceFileCreate();
-	int printToTrace(
-             char *keyMessage,    // Message to be written as key
-             char *valueMessage   // Message to be written as value
-             );
-	int traceFileClose();
-	int funcEntry(
-              char *valueMessage  // Value
-			  );
-	int funcExit(
-             char *valueMessage, // Value
-             int f_rc = SUCCESS           // Function RC
-             );
+	TraceSpan(const char *name, Address *addr) {
+		this->name = Trace::enabled ? name : NULL;
+		if ( this->name != NULL ) {
+			node = (addr != NULL) ? *(int *)(addr->addr) : 0;
+			start = Trace::now();
+		}
+	}
+	~TraceSpan() {
+		if ( name != NULL ) {
+			Trace::record(name, start, node);
+		}
+	}
 };
 
 #endif
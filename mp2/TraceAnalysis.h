@@ -0,0 +1,53 @@
+/**********************************
+ * FILE NAME: TraceAnalysis.h
+ *
+ * DESCRIPTION: Reading and membership analysis of the binary event trace, header file
+ **********************************/
+
+#ifndef _TRACEANALYSIS_H_
+#define _TRACEANALYSIS_H_
+
+#include "stdincludes.h"
+#include "EventTrace.h"
+
+/**
+ * STRUCT NAME: TraceFile
+ *
+ * DESCRIPTION: Records and strings of one trace, read into memory
+ */
+typedef struct TraceFile {
+	TraceHeader header;
+	vector<TraceRecord> records;
+	string strings;
+}TraceFile;
+
+/**
+ * STRUCT NAME: Latencies
+ *
+ * DESCRIPTION: Latency samples in ticks
+ */
+typedef struct Latencies {
+	vector<int> samples;
+}Latencies;
+
+/**
+ * STRUCT NAME: MembershipSummary
+ *
+ * DESCRIPTION: How completely and how fast the nodes of a run learnt of joins and failures
+ */
+typedef struct MembershipSummary {
+	int nodes;				// nodes of the run
+	int joined;				// nodes that added all their peers
+	int lastJoin;			// time the last of them did, -1 unless all did
+	int failed;				// nodes that failed
+	long expected;			// removals of the failed nodes by the live nodes
+	long found;				// of those, the ones that happened
+	long falseRemovals;		// removals of nodes that had not failed
+	Latencies detect;		// failure to removal
+}MembershipSummary;
+
+bool loadTrace(const char *binName, TraceFile *tf);
+int64_t nodeKey(int32_t id, int16_t port);
+void summarizeMembership(vector<TraceFile> &traces, MembershipSummary *summary);
+
+#endif /* _TRACEANALYSIS_H_ */
@@ -0,0 +1,399 @@
+/**********************************
+ * FILE NAME: UdpNet.cpp
+ *
+ * DESCRIPTION: UDP loopback network classes definition
+ **********************************/
+
+#include "UdpNet.h"
+
+/**
+ * Constructor
+ */
+UdpNet::UdpNet(Params *p, int netId)
+{
+	int i;
+	par = p;
+	this->netId = netId;
+	// Node ids handed out by ENinit run from 1 to EN_GPSZ
+	rng.resize(par->EN_GPSZ + 1);
+	sock.assign(par->EN_GPSZ + 1, -1);
+	// streams of different networks must not repeat each other's drops
+	for ( i = 0; i <= par->EN_GPSZ; i++ ) {
+		rng[i].seed(par->SEED, RNG_NET, netId * NET_NODE_STREAMS + i);
+	}
+	nextid = 1;
+	sched = NULL;
+	recvEvent = EV_MP1_RECV;
+	npending = 0;
+	sendCalls = 0;
+	recvCalls = 0;
+	msgsSent = 0;
+	msgsRecv = 0;
+	assert(par->MAX_MSG_SIZE <= UDP_DGRAM_SIZE);
+	buff = (char *) malloc(UDP_BATCH * UDP_DGRAM_SIZE);
+	epfd = epoll_create1(EPOLL_CLOEXEC);
+	if ( epfd < 0 ) {
+		perror("epoll_create1");
+		exit(1);
+	}
+	counts.init(par->EN_GPSZ);
+}
+
+/**
+ * Destructor
+ */
+UdpNet::~UdpNet() {
+	for ( int i = 0; i < (int)sock.size(); i++ ) {
+		if ( sock[i] >= 0 ) {
+			close(sock[i]);
+		}
+	}
+	close(epfd);
+	free(buff);
+	for ( int i = 0; i < (int)pending.size(); i++ ) {
+		delete pending[i];
+	}
+}
+
+/**
+ * FUNCTION NAME: peerAddr
+ *
+ * DESCRIPTION: Loopback socket address of the node id
+ */
+void UdpNet::peerAddr(int id, struct sockaddr_in *sa) {
+	memset(sa, 0, sizeof(struct sockaddr_in));
+	sa->sin_family = AF_INET;
+	sa->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	sa->sin_port = htons(par->UDP_PORT + netId * (par->EN_GPSZ + 1) + id);
+}
+
+/**
+ * FUNCTION NAME: ENinit
+ *
+ * DESCRIPTION: Init the network for this node.
+ * 				Ids are handed out in the same order in every process, but only the
+ * 				nodes run by this process get a socket.
+ */
+void *UdpNet::ENinit(Address *myaddr, short port) {
+	struct sockaddr_in sa;
+	struct epoll_event ev;
+	int rcvbuf = UDP_RCVBUF;
+	int id = nextid++;
+
+	*(int *)(myaddr->addr) = id;
+	*(short *)(&myaddr->addr[4]) = 0;
+
+	assert(id <= par->EN_GPSZ);
+
+	if ( par->nodeProcess != 0 && par->nodeProcess != id ) {
+		return myaddr;
+	}
+
+	sock[id] = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if ( sock[id] < 0 ) {
+		perror("socket");
+		exit(1);
+	}
+	setsockopt(sock[id], SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+	peerAddr(id, &sa);
+	if ( bind(sock[id], (struct sockaddr *)&sa, sizeof(sa)) < 0 ) {
+		fprintf(stderr, "Cannot bind node %d to 127.0.0.1:%d: %s\n", id, ntohs(sa.sin_port), strerror(errno));
+		exit(1);
+	}
+
+	// Edge triggered: a node is posted once per arrival, not for as long as its socket is not drained
+	ev.events = EPOLLIN | EPOLLET;
+	ev.data.u32 = id;
+	if ( epoll_ctl(epfd, EPOLL_CTL_ADD, sock[id], &ev) < 0 ) {
+		perror("epoll_ctl");
+		exit(1);
+	}
+	return myaddr;
+}
+
+/**
+ * FUNCTION NAME: datagramFor
+ *
+ * DESCRIPTION: Datagram from src to dst with room for len more bytes,
+ * 				a new one once the one being filled is full
+ */
+UdpDatagram *UdpNet::datagramFor(int src, int dst, int len) {
+	UdpDatagram *dg;
+	long key = (long)src * (par->EN_GPSZ + 1) + dst;
+	map<long, int>::iterator it = open.find(key);
+
+	if ( it != open.end() && pending[it->second]->size + len <= UDP_DGRAM_SIZE ) {
+		return pending[it->second];
+	}
+	if ( npending == (int)pending.size() ) {
+		pending.push_back(new UdpDatagram);
+	}
+	dg = pending[npending];
+	dg->src = src;
+	dg->dst = dst;
+	dg->size = 0;
+	open[key] = npending++;
+	return dg;
+}
+
+/**
+ * FUNCTION NAME: ENsend
+ *
+ * DESCRIPTION: UdpNet send function, the message leaves with the other messages
+ * 				to the same node at the next ENflush
+ *
+ * RETURNS:
+ * size
+ */
+int UdpNet::ENsend(Address *myaddr, Address *toaddr, char *data, int size) {
+	UdpDatagram *dg;
+	en_msg *em;
+	int len;
+	int src = *(int *)(myaddr->addr);
+	int dst = *(int *)(toaddr->addr);
+
+	assert(src >= 1 && src <= par->EN_GPSZ);
+
+	// every sender draws from its own stream
+	int drop = rng[src].nextInt(100);
+
+	if( (dst < 1) || (dst > par->EN_GPSZ) || (sock[src] < 0) || (size + (int)sizeof(en_msg) >= par->MAX_MSG_SIZE) ) {
+		return 0;
+	}
+	if ( par->dropmsg && drop < (int) (par->MSG_DROP_PROB * 100) ) {
+		counts.countDrop(src, RANDOM_DROP);
+		return 0;
+	}
+
+	len = (sizeof(en_msg) + size + UDP_ALIGN - 1) & ~(UDP_ALIGN - 1);
+	dg = datagramFor(src, dst, len);
+	em = (en_msg *)(dg->data + dg->size);
+	em->size = size;
+	em->channel = 0;
+	memcpy(&(em->from.addr), &(myaddr->addr), sizeof(em->from.addr));
+	memcpy(&(em->to.addr), &(toaddr->addr), sizeof(em->to.addr));
+	memcpy((char *)(em + 1), data, size);
+	dg->size += len;
+	msgsSent++;
+
+	counts.countSent(src, par->getcurrtime());
+
+	return size;
+}
+
+/**
+ * FUNCTION NAME: messagesIn
+ *
+ * DESCRIPTION: Number of messages packed into a datagram
+ */
+static int messagesIn(UdpDatagram *dg) {
+	int n = 0;
+	for ( int off = 0; off < dg->size; n++ ) {
+		en_msg *em = (en_msg *)(dg->data + off);
+		off += (sizeof(en_msg) + em->size + UDP_ALIGN - 1) & ~(UDP_ALIGN - 1);
+	}
+	return n;
+}
+
+/**
+ * FUNCTION NAME: bySrc
+ *
+ * DESCRIPTION: Order of the datagrams sent by one sendmmsg per node
+ */
+static bool bySrc(const UdpDatagram *a, const UdpDatagram *b) {
+	return a->src < b->src;
+}
+
+/**
+ * FUNCTION NAME: ENflush
+ *
+ * DESCRIPTION: Send the datagrams of the tick, UDP_BATCH per sendmmsg from every node
+ *
+ * RETURNS:
+ * number of datagrams sent
+ */
+int UdpNet::ENflush() {
+	struct mmsghdr mm[UDP_BATCH];
+	struct iovec iov[UDP_BATCH];
+	struct sockaddr_in sa[UDP_BATCH];
+	UdpDatagram *dg;
+	int i, j, k, n, ret;
+	int sent = 0;
+
+	// datagrams to the same node keep their order
+	stable_sort(pending.begin(), pending.begin() + npending, bySrc);
+
+	for ( i = 0; i < npending; i += n ) {
+		for ( n = 0; i + n < npending && n < UDP_BATCH && pending[i + n]->src == pending[i]->src; n++ ) {
+			dg = pending[i + n];
+			peerAddr(dg->dst, &sa[n]);
+			iov[n].iov_base = dg->data;
+			iov[n].iov_len = dg->size;
+			memset(&mm[n], 0, sizeof(mm[n]));
+			mm[n].msg_hdr.msg_name = &sa[n];
+			mm[n].msg_hdr.msg_namelen = sizeof(sa[n]);
+			mm[n].msg_hdr.msg_iov = &iov[n];
+			mm[n].msg_hdr.msg_iovlen = 1;
+		}
+
+		for ( j = 0; j < n; ) {
+			ret = sendmmsg(sock[pending[i]->src], &mm[j], n - j, 0);
+			sendCalls++;
+			// A full socket buffer loses the datagram, as a real network would
+			if ( ret <= 0 ) {
+				for ( k = messagesIn(pending[i + j]); k > 0; k-- ) {
+					counts.countDrop(pending[i]->src, OVERFLOW_DROP);
+				}
+				j++;
+				continue;
+			}
+			for ( k = j; k < j + ret; k++ ) {
+				// Node ids handed out by ENinit start at 1
+				if ( sched != NULL && sock[pending[i + k]->dst] >= 0 ) {
+					sched->post(pending[i + k]->dst - 1, recvEvent);
+				}
+			}
+			sent += ret;
+			j += ret;
+		}
+	}
+
+	npending = 0;
+	open.clear();
+	return sent;
+}
+
+/**
+ * FUNCTION NAME: unpack
+ *
+ * DESCRIPTION: Queue the messages of a datagram
+ */
+void UdpNet::unpack(Address *myaddr, char *dgram, int len, int (* enq)(void *, char *, int), void *queue) {
+	char* tmp;
+	int sz;
+	int off;
+	en_msg *emsg;
+	int dst = *(int *)(myaddr->addr);
+
+	for ( off = 0; off + (int)sizeof(en_msg) <= len; off += (sizeof(en_msg) + sz + UDP_ALIGN - 1) & ~(UDP_ALIGN - 1) ) {
+		emsg = (en_msg *)(dgram + off);
+		sz = emsg->size;
+
+		// not a datagram of this network
+		if ( sz < 0 || off + (int)sizeof(en_msg) + sz > len || 0 != memcmp(emsg->to.addr, myaddr->addr, sizeof(emsg->to.addr)) ) {
+			return;
+		}
+
+		tmp = (char *) malloc(sz * sizeof(char));
+		memcpy(tmp, (char *)(emsg+1), sz);
+
+		(*enq)(queue, (char *)tmp, sz);
+		msgsRecv++;
+
+		counts.countRecv(dst, par->getcurrtime());
+	}
+}
+
+/**
+ * FUNCTION NAME: ENrecv
+ *
+ * DESCRIPTION: UdpNet receive function, drains the socket of the node UDP_BATCH datagrams at a time
+ *
+ * RETURN:
+ * 0
+ */
+int UdpNet::ENrecv(Address *myaddr, int (* enq)(void *, char *, int), struct timeval *t, int times, void *queue){
+	// times is always assumed to be 1
+	struct mmsghdr mm[UDP_BATCH];
+	struct iovec iov[UDP_BATCH];
+	int i, n;
+	int dst = *(int *)(myaddr->addr);
+
+	assert(dst >= 1 && dst <= par->EN_GPSZ);
+
+	if ( sock[dst] < 0 ) {
+		return 0;
+	}
+
+	for ( i = 0; i < UDP_BATCH; i++ ) {
+		iov[i].iov_base = buff + i * UDP_DGRAM_SIZE;
+		iov[i].iov_len = UDP_DGRAM_SIZE;
+		memset(&mm[i], 0, sizeof(mm[i]));
+		mm[i].msg_hdr.msg_iov = &iov[i];
+		mm[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	// A short batch means the socket is drained, there is no need for a call to say so
+	do {
+		n = recvmmsg(sock[dst], mm, UDP_BATCH, 0, NULL);
+		recvCalls++;
+		for ( i = 0; i < n; i++ ) {
+			unpack(myaddr, buff + i * UDP_DGRAM_SIZE, mm[i].msg_len, enq, queue);
+		}
+	} while ( n == UDP_BATCH );
+
+	return 0;
+}
+
+/**
+ * FUNCTION NAME: ENwait
+ *
+ * DESCRIPTION: Wait up to timeout milliseconds for datagrams and post recvEvent
+ * 				for every node of this process they arrived at
+ *
+ * RETURNS:
+ * number of nodes posted
+ */
+int UdpNet::ENwait(int timeout) {
+	struct epoll_event events[UDP_MAX_EVENTS];
+	int i, n;
+
+	n = epoll_wait(epfd, events, UDP_MAX_EVENTS, timeout);
+	if ( n < 0 ) {
+		// interrupted, the caller waits again
+		return 0;
+	}
+	for ( i = 0; i < n && sched != NULL; i++ ) {
+		sched->post(events[i].data.u32 - 1, recvEvent);
+	}
+	return n;
+}
+
+/**
+ * FUNCTION NAME: setScheduler
+ *
+ * DESCRIPTION: Post recvEvent to the scheduler for the nodes that have datagrams waiting
+ */
+void UdpNet::setScheduler(Scheduler *sched, EventType recvEvent) {
+	this->sched = sched;
+	this->recvEvent = recvEvent;
+}
+
+/**
+ * FUNCTION NAME: syscallsPerMsg
+ *
+ * DESCRIPTION: sendmmsg calls per message sent and recvmmsg calls per message received so far
+ */
+void UdpNet::syscallsPerMsg(double *send, double *recv) {
+	*send = msgsSent > 0 ? (double)sendCalls / msgsSent : 0;
+	*recv = msgsRecv > 0 ? (double)recvCalls / msgsRecv : 0;
+}
+
+/**
+ * FUNCTION NAME: ENcleanup
+ *
+ * DESCRIPTION: Cleanup the UdpNet. Called exactly once at the end of the program.
+ */
+int UdpNet::ENcleanup() {
+	int i;
+
+	writeMsgCount(par, &counts);
+
+	for ( i = 0; i < (int)sock.size(); i++ ) {
+		if ( sock[i] >= 0 ) {
+			close(sock[i]);
+			sock[i] = -1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,339 @@
+/**********************************
+ * FILE NAME: Workload.cpp
+ *
+ * DESCRIPTION: YCSB style workload generator definition
+ **********************************/
+
+#include "Workload.h"
+
+static const char keyChars[] =
+"0123456789"
+"ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+"abcdefghijklmnopqrstuvwxyz";
+static const char *opName[DELETE + 1] = { "insert", "read", "update", "delete" };
+
+/**
+ * FUNCTION NAME: monotonicNs
+ *
+ * DESCRIPTION: Monotonic clock in nanoseconds
+ */
+static long monotonicNs() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+/**
+ * Constructor
+ */
+Zipfian::Zipfian(): theta(ZIPFIAN_CONSTANT), zetan(0), eta(0), items(0) {
+	alpha = 1 / (1 - theta);
+	zeta2 = 1 + pow(0.5, theta);
+}
+
+/**
+ * FUNCTION NAME: grow
+ *
+ * DESCRIPTION: Draw the ranks from items items, zeta is summed up over the new ones only
+ */
+void Zipfian::grow(uint64_t items) {
+	for ( uint64_t i = this->items + 1; i <= items; i++ ) {
+		zetan += 1 / pow((double)i, theta);
+	}
+	this->items = items;
+	eta = (1 - pow(2.0 / items, 1 - theta)) / (1 - zeta2 / zetan);
+}
+
+/**
+ * FUNCTION NAME: next
+ *
+ * DESCRIPTION: Returns the next rank, below the number of items
+ */
+uint64_t Zipfian::next(Random &rng) {
+	double u = rng.nextDouble();
+	double uz = u * zetan;
+	uint64_t rank;
+
+	if ( uz < 1 ) {
+		return 0;
+	}
+	if ( uz < zeta2 ) {
+		return 1;
+	}
+	rank = (uint64_t)(items * pow(eta * u - eta + 1, alpha));
+	return (rank < items) ? rank : items - 1;
+}
+
+/**
+ * Constructor
+ */
+Workload::Workload(Params *par): loaded(0), loadEnd(-1), issued(0), credit(0), runStart(-1), endTick(-1), startNs(0), endNs(0) {
+	this->par = par;
+	rng.seed(par->SEED, RNG_WORKLOAD, 1);
+	memset(failures, 0, sizeof(failures));
+	// wide enough for every record and insert to get a key of its own
+	keyWidth = 1;
+	for ( long n = (long)par->WORKLOAD_RECORDS + par->WORKLOAD_OPS; n >= 62; n /= 62 ) {
+		keyWidth++;
+	}
+	keys.reserve(par->WORKLOAD_RECORDS);
+}
+
+/**
+ * FUNCTION NAME: makeKey
+ *
+ * DESCRIPTION: Key of the index-th record: the index in base 62, padded with random characters
+ * 				to a length drawn from the key sizes
+ */
+string Workload::makeKey(int index) {
+	int length = par->KEY_SIZE_MIN + rng.nextInt(par->KEY_SIZE_MAX - par->KEY_SIZE_MIN + 1);
+	string key(max(length, keyWidth), '0');
+	int i;
+
+	for ( i = keyWidth - 1; i >= 0; i-- ) {
+		key[i] = keyChars[index % 62];
+		index /= 62;
+	}
+	for ( i = keyWidth; i < (int)key.size(); i++ ) {
+		key[i] = keyChars[rng.nextInt(62)];
+	}
+	return key;
+}
+
+/**
+ * FUNCTION NAME: makeValue
+ *
+ * DESCRIPTION: Random value of a length drawn from the value sizes
+ */
+string Workload::makeValue() {
+	int length = par->VALUE_SIZE_MIN + rng.nextInt(par->VALUE_SIZE_MAX - par->VALUE_SIZE_MIN + 1);
+	string value(length, '0');
+
+	for ( int i = 0; i < length; i++ ) {
+		value[i] = keyChars[rng.nextInt(62)];
+	}
+	return value;
+}
+
+/**
+ * FUNCTION NAME: pickKey
+ *
+ * DESCRIPTION: Index of the key an operation goes to. The zipfian ranks are scattered over
+ * 				the keys with FNV-1a so that the popular keys are not all neighbours,
+ * 				latest counts them back from the newest key.
+ */
+int Workload::pickKey() {
+	uint64_t n = keys.size();
+	uint64_t rank, hash;
+
+	if ( par->WORKLOAD_DIST == UNIFORM_KEYS ) {
+		return rng.nextInt(n);
+	}
+	rank = zipfian.next(rng);
+	if ( par->WORKLOAD_DIST == LATEST_KEYS ) {
+		return n - 1 - rank;
+	}
+	hash = 14695981039346656037ULL;
+	for ( int i = 0; i < 8; i++ ) {
+		hash = (hash ^ ((rank >> (i * 8)) & 0xff)) * 1099511628211ULL;
+	}
+	return hash % n;
+}
+
+/**
+ * FUNCTION NAME: recordsDue
+ *
+ * DESCRIPTION: Number of records to load in this tick, at most LOAD_PER_TICK
+ */
+int Workload::recordsDue(int time) {
+	int n = min(LOAD_PER_TICK, par->WORKLOAD_RECORDS - loaded);
+
+	loaded += n;
+	if ( n > 0 ) {
+		loadEnd = time;
+	}
+	return n;
+}
+
+/**
+ * FUNCTION NAME: nextRecord
+ *
+ * DESCRIPTION: Next record to load
+ */
+void Workload::nextRecord(string &key, string &value) {
+	key = makeKey(keys.size());
+	value = makeValue();
+	keys.push_back(key);
+	zipfian.grow(keys.size());
+}
+
+/**
+ * FUNCTION NAME: opsDue
+ *
+ * DESCRIPTION: Number of operations to issue in this tick, WORKLOAD_RATE per tick on average.
+ * 				The operations start in the tick after the last records are loaded.
+ */
+int Workload::opsDue(int time) {
+	int n;
+
+	if ( loaded < par->WORKLOAD_RECORDS || time <= loadEnd ) {
+		return 0;
+	}
+	if ( runStart < 0 ) {
+		runStart = time;
+		startNs = monotonicNs();
+	}
+	credit += par->WORKLOAD_RATE;
+	n = min((int)credit, par->WORKLOAD_OPS - issued);
+	credit -= (int)credit;
+	return n;
+}
+
+/**
+ * FUNCTION NAME: nextOp
+ *
+ * DESCRIPTION: Next operation of the mix and its key, and its value for an insert or update
+ */
+MessageType Workload::nextOp(string &key, string &value) {
+	double u = rng.nextDouble() * (par->WORKLOAD_READ + par->WORKLOAD_UPDATE + par->WORKLOAD_INSERT + par->WORKLOAD_DELETE);
+
+	issued++;
+	if ( (u -= par->WORKLOAD_INSERT) < 0 || keys.empty() ) {
+		key = makeKey(keys.size());
+		value = makeValue();
+		keys.push_back(key);
+		zipfian.grow(keys.size());
+		return CREATE;
+	}
+	key = keys[pickKey()];
+	if ( (u -= par->WORKLOAD_UPDATE) < 0 ) {
+		value = makeValue();
+		return UPDATE;
+	}
+	value.clear();
+	if ( (u -= par->WORKLOAD_DELETE) < 0 ) {
+		return DELETE;
+	}
+	return READ;
+}
+
+/**
+ * FUNCTION NAME: issuedAll
+ *
+ * DESCRIPTION: Whether all records are loaded and all operations issued
+ */
+bool Workload::issuedAll() {
+	return loaded == par->WORKLOAD_RECORDS && issued == par->WORKLOAD_OPS;
+}
+
+/**
+ * FUNCTION NAME: outcome
+ *
+ * DESCRIPTION: Called by the coordinator of every transaction once it has its outcome.
+ * 				Only the operations, not the loading of the records, are counted.
+ */
+void Workload::outcome(void *env, MessageType mType, bool isSuccess, int createTime) {
+	Workload *w = (Workload *)env;
+
+	if ( w->runStart < 0 || createTime < w->runStart || mType > DELETE ) {
+		return;
+	}
+	w->latency[mType].record(w->par->getcurrtime() - createTime);
+	if ( !isSuccess ) {
+		w->failures[mType]++;
+	}
+	w->endTick = w->par->getcurrtime();
+	w->endNs = monotonicNs();
+}
+
+/**
+ * FUNCTION NAME: report
+ *
+ * DESCRIPTION: Print the throughput and the latency percentiles of every operation
+ */
+void Workload::report(FILE *fp) {
+	uint64_t completed = 0;
+	int i;
+
+	for ( i = 0; i <= DELETE; i++ ) {
+		completed += latency[i].count;
+	}
+	fprintf(fp, "\nWorkload: %d records, %d operations issued from tick %d, %llu completed\n",
+			par->WORKLOAD_RECORDS, issued, runStart, (unsigned long long)completed);
+	if ( completed == 0 ) {
+		return;
+	}
+	fprintf(fp, "Throughput: %.2f ops/tick, %.0f ns/op wall clock\n",
+			(double)completed / (endTick - runStart + 1), (double)(endNs - startNs) / completed);
+	fprintf(fp, "%-8s %8s %8s %6s %6s %6s %8s\n", "op", "count", "failed", "p50", "p99", "p999", "(ticks)");
+	for ( i = 0; i <= DELETE; i++ ) {
+		Histogram *h = &latency[i];
+		if ( h->count == 0 ) {
+			continue;
+		}
+		fprintf(fp, "%-8s %8llu %8llu %6llu %6llu %6llu\n", opName[i], (unsigned long long)h->count,
+				(unsigned long long)failures[i], (unsigned long long)h->valueAt(50),
+				(unsigned long long)h->valueAt(99), (unsigned long long)h->valueAt(99.9));
+	}
+}
+
+/**
+ * FUNCTION NAME: checkpoint
+ *
+ * DESCRIPTION: Write the progress of the workload to a checkpoint.
+ * 				The wall clock times are written as their age, the clock of another process
+ * 				starts elsewhere.
+ */
+void Workload::checkpoint(Checkpoint *ck) {
+	long now = monotonicNs();
+
+	ck->put(&rng, sizeof(rng));
+	ck->put(&zipfian, sizeof(zipfian));
+	ck->putLong(keys.size());
+	for ( unsigned int i = 0; i < keys.size(); i++ ) {
+		ck->putString(keys[i]);
+	}
+	ck->putLong(loaded);
+	ck->putLong(loadEnd);
+	ck->putLong(issued);
+	ck->put(&credit, sizeof(credit));
+	ck->putLong(runStart);
+	ck->putLong(endTick);
+	ck->putLong(startNs != 0 ? now - startNs : -1);
+	ck->putLong(endNs != 0 ? now - endNs : -1);
+	for ( int i = 0; i <= DELETE; i++ ) {
+		latency[i].checkpoint(ck);
+	}
+	ck->put(failures, sizeof(failures));
+}
+
+/**
+ * FUNCTION NAME: restore
+ *
+ * DESCRIPTION: Read back the progress written by checkpoint
+ */
+void Workload::restore(Checkpoint *ck) {
+	long now = monotonicNs();
+	long age;
+
+	ck->get(&rng, sizeof(rng));
+	ck->get(&zipfian, sizeof(zipfian));
+	keys.resize(ck->getCount(sizeof(long)));
+	for ( unsigned int i = 0; i < keys.size(); i++ ) {
+		keys[i] = ck->getString();
+	}
+	loaded = (int)ck->getLong();
+	loadEnd = (int)ck->getLong();
+	issued = (int)ck->getLong();
+	ck->get(&credit, sizeof(credit));
+	runStart = (int)ck->getLong();
+	endTick = (int)ck->getLong();
+	age = ck->getLong();
+	startNs = (age >= 0) ? now - age : 0;
+	age = ck->getLong();
+	endNs = (age >= 0) ? now - age : 0;
+	for ( int i = 0; i <= DELETE; i++ ) {
+		latency[i].restore(ck);
+	}
+	ck->get(failures, sizeof(failures));
+}
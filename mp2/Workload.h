@@ -0,0 +1,87 @@
+/**********************************
+ * FILE NAME: Workload.h
+ *
+ * DESCRIPTION: YCSB style workload generator header file
+ **********************************/
+
+#ifndef _WORKLOAD_H_
+#define _WORKLOAD_H_
+
+#include "stdincludes.h"
+#include "Params.h"
+#include "Random.h"
+#include "Metrics.h"
+#include "common.h"
+
+/*
+ * Macros
+ */
+// skew of the zipfian and latest distributions, as in YCSB
+#define ZIPFIAN_CONSTANT 0.99
+// records created per tick while loading, the network holds ENBUFFSIZE messages
+#define LOAD_PER_TICK 1000
+
+/**
+ * CLASS NAME: Zipfian
+ *
+ * DESCRIPTION: Zipfian ranks over a growing number of items (Gray et al., "Quickly
+ * 				generating billion-record synthetic databases"). Rank 0 is the most popular.
+ */
+class Zipfian {
+private:
+	double theta;
+	double alpha;
+	double zeta2;
+	double zetan;
+	double eta;
+	uint64_t items;
+public:
+	Zipfian();
+	void grow(uint64_t items);
+	uint64_t next(Random &rng);
+};
+
+/**
+ * CLASS NAME: Workload
+ *
+ * DESCRIPTION: Generates the records to load and the operations to run against the KV store
+ * 				from the workload settings of the test case, and collects the outcome of every
+ * 				operation it ran: latency in ticks per operation and wall clock time per operation.
+ */
+class Workload {
+private:
+	Params *par;
+	Random rng;
+	Zipfian zipfian;
+	// keys created so far, key i starts with i in base 62
+	vector<string> keys;
+	int keyWidth;
+	int loaded;
+	int loadEnd;
+	int issued;
+	double credit;
+	// tick the operations started in, -1 while loading
+	int runStart;
+	// tick of the last outcome
+	int endTick;
+	long startNs;
+	long endNs;
+	Histogram latency[DELETE + 1];
+	uint64_t failures[DELETE + 1];
+	string makeKey(int index);
+	string makeValue();
+	int pickKey();
+public:
+	Workload(Params *par);
+	int recordsDue(int time);
+	void nextRecord(string &key, string &value);
+	int opsDue(int time);
+	MessageType nextOp(string &key, string &value);
+	bool issuedAll();
+	static void outcome(void *env, MessageType mType, bool isSuccess, int createTime);
+	void report(FILE *fp);
+	void checkpoint(Checkpoint *ck);
+	void restore(Checkpoint *ck);
+};
+
+#endif /* _WORKLOAD_H_ */